@@ -229,6 +229,11 @@ public:
      */
     multi_type_matrix(const multi_type_matrix& r);
 
+    /**
+     * Move constructor.  The other matrix is left empty.
+     */
+    multi_type_matrix(multi_type_matrix&& r) noexcept;
+
     /**
      * Destructor.
      */
@@ -239,6 +244,11 @@ public:
 
     multi_type_matrix& operator= (const multi_type_matrix& r);
 
+    /**
+     * Move assignment.  The other matrix is left empty.
+     */
+    multi_type_matrix& operator= (multi_type_matrix&& r) noexcept;
+
     /**
      * Get a mutable reference of an element (position object) at specified
      * position. The position object can then be passed to an additional
@@ -111,6 +111,13 @@ template<typename _MtxTrait>
 multi_type_matrix<_MtxTrait>::multi_type_matrix(const multi_type_matrix& r) :
     m_store(r.m_store), m_size(r.m_size) {}
 
+template<typename _MtxTrait>
+multi_type_matrix<_MtxTrait>::multi_type_matrix(multi_type_matrix&& r) noexcept :
+    m_store(std::move(r.m_store)), m_size(r.m_size)
+{
+    r.m_size = size_pair_type();
+}
+
 template<typename _MtxTrait>
 multi_type_matrix<_MtxTrait>::~multi_type_matrix() {}
 
@@ -139,6 +146,19 @@ multi_type_matrix<_MtxTrait>::operator= (const multi_type_matrix& r)
     return *this;
 }
 
+template<typename _MtxTrait>
+multi_type_matrix<_MtxTrait>&
+multi_type_matrix<_MtxTrait>::operator= (multi_type_matrix&& r) noexcept
+{
+    if (this == &r)
+        return *this;
+
+    m_store = std::move(r.m_store);
+    m_size = r.m_size;
+    r.m_size = size_pair_type();
+    return *this;
+}
+
 template<typename _MtxTrait>
 typename multi_type_matrix<_MtxTrait>::position_type
 multi_type_matrix<_MtxTrait>::position(size_type row, size_type col)
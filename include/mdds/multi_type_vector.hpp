@@ -31,10 +31,15 @@
 #include "default_deleter.hpp"
 #include "global.hpp"
 #include "multi_type_vector_types.hpp"
+#include "multi_type_vector/gap_buffer.hpp"
 #include "multi_type_vector_itr.hpp"
 
 #include <vector>
 #include <algorithm>
+#include <atomic>
+#include <iterator>
+#include <type_traits>
+#include <utility>
 #include <cassert>
 #include <sstream>
 
@@ -53,6 +58,11 @@ namespace detail {
  * Empty event function handler structure, used when no custom function
  * handler is specified.
  *
+ * It does not provide the optional range change event.  A custom handler
+ * receives it by providing a function with the following signature:
+ *
+ * <code>void range_changed(const mdds::mtv::range_change_event& event)</code>
+ *
  * @see mdds::multi_type_vector
  */
 struct mtv_event_func
@@ -62,9 +72,28 @@ struct mtv_event_func
     void element_block_released(const mdds::mtv::base_element_block* /*block*/) {}
 };
 
+/**
+ * Check whether an event handler receives range change events, which it
+ * does when it provides range_changed().
+ */
+template<typename _EventFunc, typename = void>
+struct has_range_changed : std::false_type {};
+
+template<typename _EventFunc>
+struct has_range_changed<_EventFunc, decltype(std::declval<_EventFunc&>().range_changed(
+    std::declval<const mdds::mtv::range_change_event&>()))> : std::true_type {};
+
 template<typename T>
 T mtv_advance_position(const T& pos, int steps);
 
+/**
+ * Used to make a method template that takes a forwarding reference accept
+ * only rvalues, so that it can be overloaded with the variant that takes
+ * a const reference.
+ */
+template<typename T>
+struct enable_if_rvalue : std::enable_if<!std::is_lvalue_reference<T>::value> {};
+
 }
 
 /**
@@ -114,6 +143,13 @@ public:
      * <li><code>element_block_released</code> - this gets called whenever
      * the container releases an existing element block either because
      * the block gets deleted or gets transferred to another container.</li>
+     * <li><code>range_changed</code> - this optional event gets called once
+     * for each call that modifies the logical content of the container, with
+     * a <code>mdds::mtv::range_change_event</code> that describes the range
+     * of elements that changed and their types before and after the change.
+     * The types of the range are looked up only when the event handler
+     * provides this function.  Swapping or assigning whole containers does
+     * not trigger this event.</li>
      * </ul>
      *
      * @see mdds::detail::mtv_event_func for the precise function signatures
@@ -123,15 +159,20 @@ public:
 
 private:
 
+    /**
+     * Block header.  It does not own the element block it points to; the
+     * container is responsible for deleting element blocks explicitly.
+     * This keeps the header trivially copyable, so that shifting blocks
+     * within the block array is a plain memory move.
+     */
     struct block
     {
+        size_type m_position;
         size_type m_size;
         element_block_type* mp_data;
 
         block();
         block(size_type _size);
-        block(const block& other);
-        ~block();
     };
 
     struct element_block_deleter : public std::unary_function<void, const element_block_type*>
@@ -142,7 +183,17 @@ private:
         }
     };
 
-    typedef std::vector<block*> blocks_type;
+    /**
+     * Blocks are stored by value in a gap buffer, which keeps its unused
+     * storage where the last block was inserted or removed.  A series of
+     * row insertions or removals around the same position therefore only
+     * moves the blocks in between, instead of all the blocks that follow.
+     * Note that any insertion into or removal from this array invalidates
+     * all pointers and references to the blocks it stores.  The array is
+     * allocated from the memory resource installed for the current thread,
+     * if any.
+     */
+    typedef mtv::gap_buffer<block> blocks_type;
 
     struct blocks_to_transfer
     {
@@ -212,6 +263,124 @@ public:
     typedef std::pair<iterator, size_type> position_type;
     typedef std::pair<const_iterator, size_type> const_position_type;
 
+    /**
+     * Builder that appends runs of values and empty segments to the end of
+     * a container in a single linear pass.  Each run either gets appended
+     * to the last block when it stores elements of the same type, or goes
+     * straight into a new block; no other blocks are examined.
+     *
+     * The element_block_acquired event handler is called exactly once for
+     * each new element block.  The container is valid after each call, and
+     * may be modified via other methods between calls.
+     */
+    class builder
+    {
+        multi_type_vector& m_db;
+
+    public:
+        builder(const builder&) = delete;
+        builder& operator=(const builder&) = delete;
+
+        /**
+         * Constructor.
+         *
+         * @param db container to append values to.
+         * @param block_size_hint expected number of blocks that the
+         *                        container will have after all values get
+         *                        appended.  It is used to reserve the
+         *                        storage for the blocks in advance.
+         */
+        explicit builder(multi_type_vector& db, size_type block_size_hint = 0);
+
+        /**
+         * Append a single value.
+         *
+         * @param value value to append.
+         */
+        template<typename _T>
+        void append(const _T& value);
+
+        /**
+         * Append a single value by moving it into the container.
+         *
+         * @param value value to append.
+         */
+        template<typename _T, typename = typename detail::enable_if_rvalue<_T>::type>
+        void append(_T&& value);
+
+        /**
+         * Append a run of values of the same type.
+         *
+         * @param it_begin iterator that points to the begin position of the
+         *                 values to append.
+         * @param it_end iterator that points to the end position of the
+         *               values to append.
+         */
+        template<typename _T>
+        void append(const _T& it_begin, const _T& it_end);
+
+        /**
+         * Append a run of empty elements.
+         *
+         * @param length number of empty elements to append.
+         */
+        void append_empty(size_type length);
+    };
+
+    /**
+     * Scope of a batch of edits, during which the container suspends
+     * merging of adjacent non-empty blocks of the same type.  Without it,
+     * each modifier call merges the blocks around the modified range right
+     * away, which makes a long series of edits in the same area copy the
+     * values of the same blocks back and forth as they get merged and
+     * split over and over.  Instead, all the adjacent blocks of the same
+     * type get merged in a single pass over the blocks when the session
+     * ends.  Adjacent empty blocks still get merged right away, which does
+     * not involve copying any values.
+     *
+     * <p>While a session is active, the container may store adjacent
+     * non-empty blocks of the same type.  The stored values are not affected by
+     * this, but block_size() and block iteration reflect the unmerged
+     * blocks, and comparison with another container may report inequality
+     * even when both store identical values.  Sessions may be nested, in
+     * which case the blocks get merged when the outermost session ends.
+     * A copy or a snapshot of a container taken while a session is active
+     * gets its blocks merged, since it is not part of the session.  The
+     * container must not be moved or swapped as a whole with another
+     * container while a session is active.  Transferring or swapping a
+     * range of elements into a container not in a session merges all the
+     * blocks of that container.</p>
+     */
+    class edit_session
+    {
+        multi_type_vector& m_db;
+        bool m_active;
+
+    public:
+        edit_session(const edit_session&) = delete;
+        edit_session& operator=(const edit_session&) = delete;
+
+        /**
+         * Constructor.  It starts a session on the specified container.
+         *
+         * @param db container to edit.
+         */
+        explicit edit_session(multi_type_vector& db);
+
+        /**
+         * Destructor.  It ends the session unless it has already been
+         * committed.
+         */
+        ~edit_session();
+
+        /**
+         * End the session, and merge all adjacent blocks of the same type
+         * unless another session on the same container is still active.
+         * Calling it on a session that has already ended does nothing.
+         */
+        void commit();
+    };
+
     /**
      * Move the position object to the next logical position.  Caller must
      * ensure the the position object is valid.
@@ -355,6 +524,15 @@ public:
      */
     multi_type_vector(const multi_type_vector& other);
 
+    /**
+     * Move constructor.  It takes over the blocks and the event handler of
+     * the other container without copying any of the element blocks, and
+     * leaves the other container empty.
+     *
+     * @param other other column instance to move values from.
+     */
+    multi_type_vector(multi_type_vector&& other) noexcept;
+
     /**
      * Destructor.  It deletes all allocated data blocks.
      */
@@ -379,6 +557,21 @@ public:
     template<typename _T>
     iterator set(size_type pos, const _T& value);
 
+    /**
+     * Set a value of an arbitrary type to a specified position, by moving
+     * it into the container.  This variant is chosen when the value is
+     * passed as an rvalue, and avoids copying values that are expensive
+     * to copy.  Otherwise it behaves the same way as the variant that
+     * takes the value by const reference.
+     *
+     * @param pos position to insert the value to.
+     * @param value value to move into the container.
+     * @return iterator position pointing to the block where the value is
+     *         inserted.
+     */
+    template<typename _T, typename = typename detail::enable_if_rvalue<_T>::type>
+    iterator set(size_type pos, _T&& value);
+
     /**
      * Set a value of an arbitrary type to a specified position.  The type of
      * the value is inferred from the value passed to this method.  The new
@@ -414,6 +607,22 @@ public:
     template<typename _T>
     iterator set(const iterator& pos_hint, size_type pos, const _T& value);
 
+    /**
+     * Set a value of an arbitrary type to a specified position, by moving
+     * it into the container, with a block position hint.  This variant is
+     * chosen when the value is passed as an rvalue.
+     *
+     * @param pos_hint iterator used as a block position hint, to specify
+     *                 which block to start when searching for the right block
+     *                 to insert the value into.
+     * @param pos position to insert the value to.
+     * @param value value to move into the container.
+     * @return iterator position pointing to the block where the value is
+     *         inserted.
+     */
+    template<typename _T, typename = typename detail::enable_if_rvalue<_T>::type>
+    iterator set(const iterator& pos_hint, size_type pos, _T&& value);
+
     /**
      * Set multiple values of identical type to a range of elements starting
      * at specified position.  Any existing values will be overwritten by the
@@ -478,6 +687,42 @@ public:
     template<typename _T>
     iterator set(const iterator& pos_hint, size_type pos, const _T& it_begin, const _T& it_end);
 
+    /**
+     * Set values to multiple, possibly non-contiguous positions in one
+     * pass.  The values are given as a range of pairs, each of which
+     * stores a position as its <code>first</code> member and the value to
+     * set at that position as its <code>second</code> member, such as
+     * <code>std::pair<size_type, double></code>.  The pairs must be
+     * sorted by position in strictly ascending order, and all values are
+     * of the same type.  Any existing values at those positions will be
+     * overwritten.
+     *
+     * <p>Unlike calling set() once for each value, this method walks the
+     * blocks only once, and builds the new blocks for all the affected
+     * positions in a single pass, regardless of how many values fall into
+     * each block.  This is much faster when the values are scattered over
+     * many blocks, or when they break up large blocks of a different
+     * type.</p>
+     *
+     * <p>The method will throw an <code>std::out_of_range</code> exception
+     * if any of the positions falls outside the current container range,
+     * or an <code>std::invalid_argument</code> exception if the positions
+     * are not sorted in strictly ascending order.  In either case the
+     * container is left unmodified.</p>
+     *
+     * <p>Calling this method will not change the size of the container.</p>
+     *
+     * @param it_begin iterator that points to the first position and value
+     *                 pair.
+     * @param it_end iterator that points to the end position of the
+     *               position and value pairs.
+     * @return iterator position pointing to the block where the last value
+     *         is set.  When the range of pairs is empty, the end iterator
+     *         position is returned.
+     */
+    template<typename _T>
+    iterator set_sorted(const _T& it_begin, const _T& it_end);
+
     /**
      * Append a new value to the end of the container.
      *
@@ -490,6 +735,20 @@ public:
     template<typename _T>
     iterator push_back(const _T& value);
 
+    /**
+     * Append a new value to the end of the container, by moving it into
+     * the container.  This variant is chosen when the value is passed as
+     * an rvalue.
+     *
+     * @param value new value to be moved to the end of the container.
+     *
+     * @return iterator position pointing to the block where the value is
+     *         appended, which in this case is always the last block of the
+     *         container.
+     */
+    template<typename _T, typename = typename detail::enable_if_rvalue<_T>::type>
+    iterator push_back(_T&& value);
+
     /**
      * Append a new empty element to the end of the container.
      *
@@ -590,6 +849,33 @@ public:
     template<typename _T>
     _T get(size_type pos) const;
 
+    /**
+     * Get a read-only view of a run of elements stored contiguously in a
+     * single block, without copying them.  The run starts at the specified
+     * start position, and ends at the specified end position or at the end
+     * of the block that contains the start position, whichever comes
+     * first.  The caller must specify the type of the element block as the
+     * template parameter e.g. get_span<mdds::mtv::numeric_element_block>(0,
+     * 99), and the block must store its elements contiguously.
+     *
+     * <p>To process a range that spans multiple blocks, call this method
+     * repeatedly, each time starting right after the end of the previously
+     * returned span.</p>
+     *
+     * <p>The method will throw an <code>std::out_of_range</code> exception if
+     * the range is invalid or falls outside the current container range, and
+     * an <code>mdds::mtv::element_block_error</code> exception if the block
+     * at the start position is empty or is of a different type.</p>
+     *
+     * @param start_pos position of the first element in the run.
+     * @param end_pos position of the last element in the range, inclusive.
+     *
+     * @return span referencing the elements of the run.  It remains valid
+     *         until the container gets modified.
+     */
+    template<typename _Blk>
+    mtv::element_span<const typename _Blk::value_type> get_span(size_type start_pos, size_type end_pos) const;
+
     /**
      * Return the value of an element at specified position and set that
      * position empty.  If the element resides in a managed element block,
@@ -1030,11 +1316,95 @@ public:
      */
     void shrink_to_fit();
 
+    /**
+     * Enable or disable the block cache.  When enabled, the container
+     * remembers the block found by the last lookup of an element position,
+     * and the next lookup without a position hint starts from there.  This
+     * makes sequential or nearly sequential access via get(), get_type()
+     * and is_empty() without position hints take constant time per call
+     * instead of requiring a search over all blocks.
+     *
+     * <p>The cached block gets validated against the current block layout
+     * on each use, so it needs no explicit invalidation when the container
+     * gets modified.  It is disabled by default since it makes every
+     * lookup, including those from const methods, write to the container;
+     * concurrent lookups from multiple threads remain safe but contend
+     * for the same cache line.  A container constructed as a copy of
+     * another inherits its setting.</p>
+     *
+     * @param enable true to enable the cache, false to disable it.
+     */
+    void enable_block_cache(bool enable = true);
+
+    /**
+     * @return true if the block cache is enabled, false otherwise.
+     */
+    bool block_cache_enabled() const;
+
+    /**
+     * Compute a hash of the content of the container, which takes into
+     * account the size and element type of each block as well as the
+     * element values.  Equal containers have the same fingerprint, so that
+     * a container can be checked for changes against a baseline by
+     * comparing their fingerprints.
+     *
+     * <p>The hash of each element block gets cached in the block until the
+     * block gets modified, so that computing the fingerprint again after
+     * modifying a few blocks only requires hashing the elements of those
+     * blocks, and takes time proportional to the number of blocks
+     * otherwise.  Blocks shared with a snapshot share their cached hash as
+     * well.  The cached hashes also let operator== tell apart blocks of
+     * the same type and size without comparing their elements, when their
+     * hashes differ.</p>
+     *
+     * <p>The fingerprint depends on the std::hash implementation, and is
+     * not meant to be stored for comparison by another program.  Two
+     * containers with equal elements have different fingerprints when
+     * their elements are laid out in different blocks, which may only
+     * happen during an edit session.</p>
+     *
+     * @return hash of the content of the container.
+     */
+    size_t fingerprint() const;
+
     bool operator== (const multi_type_vector& other) const;
     bool operator!= (const multi_type_vector& other) const;
 
     multi_type_vector& operator= (const multi_type_vector& other);
 
+    /**
+     * Move assignment.  Existing element blocks of this container are
+     * released, then the blocks and the event handler of the other
+     * container are taken over without copying.  The other container is
+     * left empty.
+     */
+    multi_type_vector& operator= (multi_type_vector&& other) noexcept;
+
+    /**
+     * Create a copy of this container that shares its element blocks with
+     * this container instead of cloning them.  The shared element blocks
+     * are reference-counted, and an element block gets cloned only when
+     * either container modifies it for the first time, which makes the
+     * cost of taking a snapshot proportional to the number of blocks
+     * rather than to the number of elements.
+     *
+     * <p>Element blocks referenced via iterators or position objects
+     * must not be modified directly while they may be shared; modify
+     * the content only via the methods of the container.  A snapshot
+     * must be taken on the thread that modifies the source container,
+     * but once taken, the snapshot and the source can be used from
+     * different threads.</p>
+     *
+     * <p>The element block types must be copyable, as a shared block
+     * gets cloned when modified.  The event handler of the snapshot is
+     * default-constructed, and gets notified of the acquisition of each
+     * shared block.</p>
+     *
+     * @return container that shares its element blocks with this
+     *         container.
+     */
+    multi_type_vector snapshot() const;
+
     /**
      * Return the numerical identifier that represents passed element.
      *
@@ -1062,28 +1432,87 @@ private:
     void delete_element_block(block* p);
 
     /**
-     * Delete an outer block.
+     * Delete the element blocks referenced by one or more outer blocks in
+     * the specified iterator ranges.  The outer blocks themselves are
+     * stored by value, and go away when removed from the block array.
+     *
+     * @param it start position.
+     * @param it_end end position (not inclusive).
+     */
+    void delete_element_blocks(typename blocks_type::iterator it, typename blocks_type::iterator it_end);
+
+    /**
+     * Drop the reference to an element block, and delete it unless it's
+     * still shared with another container.
+     */
+    void release_element_block(element_block_type* data);
+
+    /**
+     * Clone all shared element blocks that store the elements in the
+     * specified range as well as those in the adjacent blocks, so that
+     * they can be modified without affecting other containers.  The
+     * adjacent blocks are included since they may get merged with the
+     * blocks in the range.
      *
-     * @param p pointer to the instance of an outer block to delete.
+     * @param start_pos logical start position of the range.
+     * @param end_pos logical end position of the range, inclusive.
      */
-    void delete_block(block* p);
+    void unshare_blocks(size_type start_pos, size_type end_pos);
+
+    template<typename _T>
+    iterator set_single_impl(size_type pos, size_type start_row, size_type block_index, _T&& value);
+
+    template<typename _T>
+    iterator set_impl(size_type pos, size_type start_row, size_type block_index, _T&& value);
+
+    template<typename _T>
+    iterator push_back_impl(_T&& value);
 
     /**
-     * Delete one or more outer blocks in the specified iterator ranges.
+     * Append a block to the end of a block array, merging it with the last
+     * block if the two are of the same type.  The block array takes over
+     * the element block of the appended block.
+     */
+    void append_block_merged(blocks_type& blocks, block& blk);
+
+    /**
+     * Merge a block into the block that immediately precedes it, if the
+     * two are of the same type.  On success, the preceding block takes
+     * over all the elements, and the other block gets emptied.
      *
-     * @param it start position.
-     * @param it_end end position (not inclusive).
+     * @return true if the blocks have been merged, false otherwise.
+     */
+    bool merge_into_prev_block(block& blk_prev, block& blk);
+
+    /**
+     * Merge all adjacent blocks of the same type in a single pass.
+     */
+    void merge_all_blocks();
+
+    /**
+     * Replace the element block of a block with a private clone if it is
+     * shared with another container.
      */
-    void delete_blocks(typename blocks_type::iterator it, typename blocks_type::iterator it_end);
+    void unshare_block(block& blk);
+
+    /**
+     * Append a copy of a segment of an element block to the end of a block
+     * array, merging it with the last block if the two are of the same
+     * type.  A null element block denotes a segment of empty elements.
+     */
+    void append_segment_merged(
+        blocks_type& blocks, const element_block_type* data, size_type offset, size_type len);
 
     template<typename _T>
-    iterator set_impl(size_type pos, size_type start_row, size_type block_index, const _T& value);
+    void append_value_merged(blocks_type& blocks, const _T& value);
 
     template<typename _T>
     iterator release_impl(size_type pos, size_type start_pos, size_type block_index, _T& value);
 
     /**
-     * Find the correct block position for given logical row ID.
+     * Find the correct block position for given logical row ID.  The search
+     * first checks the initial block, then performs a binary search on the
+     * remaining blocks.
      *
      * @param row logical ID of the row that belongs to the block being looked
      *            up for.
@@ -1109,31 +1538,154 @@ private:
      */
     void get_block_position(const const_iterator& pos_hint, size_type pos, size_type& start_pos, size_type& block_index) const;
 
+    /**
+     * Update the start positions stored in the blocks after the block array
+     * has been modified.  This must be called once at the end of each
+     * operation that modifies the block array.  Until then, the start
+     * positions of the blocks affected by the operation are not reliable.
+     *
+     * The blocks past the modified ones do not get their stored positions
+     * changed; the change in the container size gets added to the pending
+     * position shift instead.
+     *
+     * @param block_index index of the first block that may have been
+     *                    modified.  The block immediately before it may have
+     *                    been resized, but must not have been removed.  It
+     *                    must be the same index that was passed to
+     *                    prepare_block_positions() before the modification,
+     *                    unless the modification only appends blocks.
+     * @param end_pos logical position past which no blocks have been
+     *                modified.  Blocks whose start positions are greater
+     *                than this position only get their positions shifted
+     *                by the change in the container size.
+     */
+    void update_block_positions(size_type block_index, size_type end_pos);
+
+    /**
+     * Move the start of the pending position shift to the block immediately
+     * before the specified block, so that the blocks from there on can be
+     * inserted or removed without affecting which blocks the shift applies
+     * to.  This must be called before modifying the block array at the
+     * specified block.  The cost is linear in the distance between the
+     * specified block and the block at which the shift started.
+     *
+     * @param block_index index of the first block that is about to be
+     *                    modified.
+     */
+    void prepare_block_positions(size_type block_index);
+
+    /**
+     * Move the start of the pending position shift to the specified block,
+     * by adding the shift to, or subtracting it from, the positions stored
+     * in the blocks in between.
+     */
+    void move_position_shift(size_type block_index);
+
+    /**
+     * Apply the pending position shift to all blocks, so that the stored
+     * positions of all blocks are their actual start positions.
+     */
+    void apply_position_shift()
+    {
+        move_position_shift(m_blocks.size());
+    }
+
+    /**
+     * Remember the block found by the last position lookup, if the block
+     * cache is enabled.
+     */
+    void cache_block_index(size_type block_index) const
+    {
+        if (m_block_cache.enabled)
+            m_block_cache.index.store(block_index, std::memory_order_relaxed);
+    }
+
+    /**
+     * Get the actual start position of a block, taking into account the
+     * pending position shift.
+     */
+    size_type block_position(size_type block_index) const
+    {
+        size_type pos = m_blocks[block_index].m_position;
+        return block_index < m_shift_index ? pos : pos + m_shift;
+    }
+
+    /**
+     * Whether the event handler receives range change events.
+     */
+    typedef detail::has_range_changed<_EventFunc> range_events_type;
+
+    /**
+     * Get the type of the elements in a range to report in a range change
+     * event.  Unless the event handler receives range change events, it
+     * returns element_type_empty without looking at any blocks.
+     *
+     * @param start_row logical start position of the block that stores the
+     *                  first element of the range.
+     * @param block_index index of the block that stores the first element
+     *                    of the range.
+     * @param end_pos logical end position of the range, inclusive.
+     *
+     * @return type of the elements in the range, or element_type_mixed if
+     *         they are of more than one type.
+     */
+    element_category_type range_event_type(size_type start_row, size_type block_index, size_type end_pos) const;
+
+    /**
+     * Get the type of the elements in a range to report in a range change
+     * event.
+     *
+     * @param start_pos logical start position of the range.
+     * @param end_pos logical end position of the range, inclusive.
+     */
+    element_category_type range_event_type(size_type start_pos, size_type end_pos) const;
+
+    /**
+     * Report a change to a range of elements to the event handler, if it
+     * receives range change events.
+     *
+     * @param end_pos logical end position of the range, inclusive.
+     */
+    void notify_range_changed(
+        mtv::range_change_t kind, size_type start_pos, size_type end_pos,
+        element_category_type old_type, element_category_type new_type)
+    {
+        mtv::range_change_event event = { kind, start_pos, end_pos+1, old_type, new_type };
+        notify_range_changed(event, range_events_type());
+    }
+
+    void notify_range_changed(const mtv::range_change_event& event, std::true_type)
+    {
+        m_hdl_event.range_changed(event);
+    }
+
+    void notify_range_changed(const mtv::range_change_event&, std::false_type) {}
+
     template<typename _T>
-    void create_new_block_with_new_cell(element_block_type*& data, const _T& cell);
+    void create_new_block_with_new_cell(element_block_type*& data, _T&& cell);
 
     template<typename _T>
     iterator set_cell_to_middle_of_block(
-        size_type start_row, size_type block_index, size_type pos_in_block, const _T& cell);
+        size_type start_row, size_type block_index, size_type pos_in_block, _T&& cell);
 
     template<typename _T>
-    void append_cell_to_block(size_type block_index, const _T& cell);
+    void append_cell_to_block(size_type block_index, _T&& cell);
 
     template<typename _T>
     iterator set_cell_to_empty_block(
-        size_type start_row, size_type block_index, size_type pos_in_block, const _T& cell);
+        size_type start_row, size_type block_index, size_type pos_in_block, _T&& cell);
 
     template<typename _T>
     iterator set_cell_to_block_of_size_one(
-        size_type start_row, size_type block_index, const _T& cell);
+        size_type start_row, size_type block_index, _T&& cell);
 
     template<typename _T>
     void set_cell_to_top_of_data_block(
-        size_type block_index, const _T& cell);
+        size_type block_index, _T&& cell);
 
     template<typename _T>
     void set_cell_to_bottom_of_data_block(
-        size_type block_index, const _T& cell);
+        size_type block_index, _T&& cell);
 
     iterator transfer_impl(
         size_type start_pos, size_type end_pos, size_type start_pos_in_block1, size_type block_index1,
@@ -1155,6 +1707,12 @@ private:
         size_type start_pos_in_block2, size_type block_index2,
         multi_type_vector& dest, size_type dest_pos);
 
+    /**
+     * Same as set_empty(), except that it does not report the change to the
+     * event handler, for use by modifiers that report their own changes.
+     */
+    iterator set_empty_no_event(size_type start_pos, size_type end_pos);
+
     iterator set_empty_impl(
         size_type start_pos, size_type end_pos, size_type start_pos_in_block1, size_type block_index1,
         bool overwrite);
@@ -1337,6 +1895,58 @@ private:
     event_func m_hdl_event;
     blocks_type m_blocks;
     size_type m_cur_size;
+
+    /**
+     * Pending shift of the block positions.  The actual start position of
+     * each block at or past m_shift_index is the position stored in it plus
+     * m_shift, modulo the range of size_type.  This lets a row insertion or
+     * removal leave the stored positions of all the blocks past the
+     * modified ones untouched, and consecutive edits only pay for the
+     * distance between them.  m_shift_index is meaningless when m_shift is
+     * zero.
+     */
+    size_type m_shift;
+    size_type m_shift_index;
+
+    /**
+     * Index of the block found by the last position lookup, used as the
+     * starting point of the next lookup without a position hint when
+     * enabled.  It may be stale, and gets checked against the current
+     * blocks before use.  A copy keeps the setting but not the index.
+     */
+    struct block_cache
+    {
+        bool enabled;
+        mutable std::atomic<size_type> index;
+
+        block_cache() : enabled(false), index(0) {}
+        block_cache(const block_cache& r) : enabled(r.enabled), index(0) {}
+
+        block_cache& operator= (const block_cache& r)
+        {
+            enabled = r.enabled;
+            index.store(0, std::memory_order_relaxed);
+            return *this;
+        }
+    };
+
+    block_cache m_block_cache;
+
+    /**
+     * Whether any of the element blocks may be shared with another
+     * container.  It gets set when a snapshot is taken, and makes the
+     * modifiers check for shared blocks.  Snapshots may be taken from
+     * multiple threads at once, hence atomic.  Relaxed ordering suffices
+     * since only the modifiers, which may not run concurrently with
+     * snapshot(), act on it.
+     */
+    mutable std::atomic<bool> m_maybe_shared;
+
+    /**
+     * Number of active edit sessions.  Merging of adjacent blocks of the
+     * same type is suspended while it is non-zero.
+     */
+    unsigned int m_edit_sessions;
 };
 
 }
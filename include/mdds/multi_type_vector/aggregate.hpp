@@ -0,0 +1,235 @@
+/*************************************************************************
+ *
+ * Copyright (c) 2017 Kohei Yoshida
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ ************************************************************************/
+
+#ifndef INCLUDED_MDDS_MULTI_TYPE_VECTOR_AGGREGATE_HPP
+#define INCLUDED_MDDS_MULTI_TYPE_VECTOR_AGGREGATE_HPP
+
+#include "mdds/multi_type_vector_types.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+
+namespace mdds { namespace mtv {
+
+/**
+ * Aggregated values of all numeric elements in a range of a
+ * multi_type_vector.  Elements stored in numeric_element_block, and in
+ * any of the standard element blocks of signed and unsigned short, int
+ * and long types, are considered numeric.  All other elements, including
+ * empty ones, are ignored.
+ */
+struct numeric_aggregate
+{
+    /** number of numeric elements. */
+    size_t count;
+
+    /** sum of all numeric elements. */
+    double sum;
+
+    /** smallest numeric element, or 0 when there are none. */
+    double min;
+
+    /** largest numeric element, or 0 when there are none. */
+    double max;
+
+    numeric_aggregate() : count(0), sum(0.0), min(0.0), max(0.0) {}
+
+    /**
+     * @return arithmetic mean of all numeric elements, or 0 when there are
+     *         none.
+     */
+    double mean() const
+    {
+        return count ? sum / count : 0.0;
+    }
+};
+
+namespace detail {
+
+/**
+ * Aggregate a run of values in an element block.  The run is split into
+ * eight independent lanes, so that no iteration of the main loop depends on
+ * the result of the previous one, which lets the compiler keep the lanes in
+ * registers and vectorize the loop when the element storage is contiguous.
+ */
+template<typename _Iter>
+void aggregate_values(const _Iter& it, size_t len, numeric_aggregate& res)
+{
+    if (!len)
+        return;
+
+    double first = it[0];
+    double sum[8] = { 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 };
+    double lo[8] = { first, first, first, first, first, first, first, first };
+    double hi[8] = { first, first, first, first, first, first, first, first };
+
+    size_t i = 0;
+    for (; i + 8 <= len; i += 8)
+    {
+        for (size_t lane = 0; lane < 8; ++lane)
+        {
+            double v = it[i+lane];
+            sum[lane] += v;
+            lo[lane] = v < lo[lane] ? v : lo[lane];
+            hi[lane] = hi[lane] < v ? v : hi[lane];
+        }
+    }
+
+    for (; i < len; ++i)
+    {
+        double v = it[i];
+        sum[0] += v;
+        lo[0] = v < lo[0] ? v : lo[0];
+        hi[0] = hi[0] < v ? v : hi[0];
+    }
+
+    double block_sum = 0.0, block_lo = lo[0], block_hi = hi[0];
+    for (size_t lane = 0; lane < 8; ++lane)
+    {
+        block_sum += sum[lane];
+        block_lo = std::min(block_lo, lo[lane]);
+        block_hi = std::max(block_hi, hi[lane]);
+    }
+
+    res.sum += block_sum;
+    res.min = res.count ? std::min(res.min, block_lo) : block_lo;
+    res.max = res.count ? std::max(res.max, block_hi) : block_hi;
+    res.count += len;
+}
+
+template<typename _Blk>
+void aggregate_block(const base_element_block& data, size_t offset, size_t len, numeric_aggregate& res)
+{
+    if (!_Blk::is_constant(data))
+    {
+        aggregate_values(_Blk::begin(data) + offset, len, res);
+        return;
+    }
+
+    // All elements share the same value; no need to expand the block.
+    double v = _Blk::at(data, offset);
+    res.sum += v * len;
+    res.min = res.count ? std::min(res.min, v) : v;
+    res.max = res.count ? std::max(res.max, v) : v;
+    res.count += len;
+}
+
+inline void aggregate_element_block(
+    const base_element_block& data, size_t offset, size_t len, numeric_aggregate& res)
+{
+    switch (get_block_type(data))
+    {
+        case element_type_numeric:
+            aggregate_block<numeric_element_block>(data, offset, len, res);
+            break;
+        case element_type_short:
+            aggregate_block<short_element_block>(data, offset, len, res);
+            break;
+        case element_type_ushort:
+            aggregate_block<ushort_element_block>(data, offset, len, res);
+            break;
+        case element_type_int:
+            aggregate_block<int_element_block>(data, offset, len, res);
+            break;
+        case element_type_uint:
+            aggregate_block<uint_element_block>(data, offset, len, res);
+            break;
+        case element_type_long:
+            aggregate_block<long_element_block>(data, offset, len, res);
+            break;
+        case element_type_ulong:
+            aggregate_block<ulong_element_block>(data, offset, len, res);
+            break;
+        default:
+            // Not a numeric block.
+            ;
+    }
+}
+
+}
+
+/**
+ * Aggregate the values of all numeric elements in a range of a
+ * multi_type_vector.  Each block in the range gets processed as a whole,
+ * and empty and non-numeric blocks get skipped without looking at their
+ * elements.
+ *
+ * <p>The function will throw an <code>std::out_of_range</code> exception
+ * if the range is invalid or falls outside the current container
+ * range.</p>
+ *
+ * @param db container to aggregate the values of.
+ * @param start_pos position of the first element in the range.
+ * @param end_pos position of the last element in the range.
+ *
+ * @return aggregated values.
+ */
+template<typename _MtvT>
+numeric_aggregate aggregate(
+    const _MtvT& db, typename _MtvT::size_type start_pos, typename _MtvT::size_type end_pos)
+{
+    if (start_pos > end_pos || end_pos >= db.size())
+        throw std::out_of_range("mdds::mtv::aggregate: invalid range.");
+
+    numeric_aggregate res;
+    typename _MtvT::const_position_type pos = db.position(start_pos);
+    typename _MtvT::const_iterator it = pos.first;
+    size_t offset = pos.second;
+
+    for (size_t remaining = end_pos - start_pos + 1; remaining; ++it)
+    {
+        size_t len = std::min<size_t>(it->size - offset, remaining);
+        if (it->data)
+            detail::aggregate_element_block(*it->data, offset, len, res);
+
+        remaining -= len;
+        offset = 0;
+    }
+
+    return res;
+}
+
+/**
+ * Aggregate the values of all numeric elements in a multi_type_vector.
+ *
+ * @param db container to aggregate the values of.
+ *
+ * @return aggregated values.
+ */
+template<typename _MtvT>
+numeric_aggregate aggregate(const _MtvT& db)
+{
+    if (db.empty())
+        return numeric_aggregate();
+
+    return aggregate(db, 0, db.size()-1);
+}
+
+}}
+
+#endif
@@ -0,0 +1,253 @@
+/*************************************************************************
+ *
+ * Copyright (c) 2017 Kohei Yoshida
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ ************************************************************************/
+
+#ifndef INCLUDED_MDDS_MULTI_TYPE_VECTOR_DIFF_HPP
+#define INCLUDED_MDDS_MULTI_TYPE_VECTOR_DIFF_HPP
+
+#include "mdds/multi_type_vector_types.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+namespace mdds { namespace mtv {
+
+/**
+ * Range of elements that differ between two multi_type_vector instances,
+ * as reported by diff().
+ */
+template<typename _MtvT>
+struct diff_range
+{
+    typedef typename _MtvT::const_position_type position_type;
+
+    /** position of the first element in the range. */
+    size_t start;
+
+    /** position one past the last element in the range. */
+    size_t end;
+
+    /**
+     * type of the elements in the range in the old container, or
+     * element_type_mixed if they are not all of the same type.
+     */
+    element_t old_type;
+
+    /**
+     * type of the elements in the range in the new container, or
+     * element_type_mixed if they are not all of the same type.
+     */
+    element_t new_type;
+
+    /**
+     * position of the first element of the range in the old container, or
+     * its end position if the range starts past its end.
+     */
+    position_type old_position;
+
+    /**
+     * position of the first element of the range in the new container, or
+     * its end position if the range starts past its end.
+     */
+    position_type new_position;
+};
+
+namespace detail {
+
+/**
+ * Collect the changed pieces found by diff() into ranges, merging each
+ * piece with the previous one when they are adjacent.
+ */
+template<typename _MtvT, typename _Func>
+class diff_range_collector
+{
+    typedef typename _MtvT::const_iterator const_iterator;
+
+    _Func& m_func;
+    diff_range<_MtvT> m_range;
+    bool m_pending;
+
+    static element_t merge_type(element_t type1, element_t type2)
+    {
+        return type1 == type2 ? type1 : element_type_mixed;
+    }
+
+public:
+    explicit diff_range_collector(_Func& func) : m_func(func), m_pending(false)
+    {
+        // Set explicitly, since value-initialization alone does not keep
+        // -Wmaybe-uninitialized quiet about them.
+        m_range.start = 0;
+        m_range.end = 0;
+        m_range.old_type = element_type_empty;
+        m_range.new_type = element_type_empty;
+    }
+
+    void add(size_t start, size_t end,
+        const const_iterator& old_it, size_t old_offset, element_t old_type,
+        const const_iterator& new_it, size_t new_offset, element_t new_type)
+    {
+        if (m_pending && m_range.end == start)
+        {
+            m_range.end = end;
+            m_range.old_type = merge_type(m_range.old_type, old_type);
+            m_range.new_type = merge_type(m_range.new_type, new_type);
+            return;
+        }
+
+        flush();
+        m_range.start = start;
+        m_range.end = end;
+        m_range.old_type = old_type;
+        m_range.new_type = new_type;
+        m_range.old_position = typename diff_range<_MtvT>::position_type(old_it, old_offset);
+        m_range.new_position = typename diff_range<_MtvT>::position_type(new_it, new_offset);
+        m_pending = true;
+    }
+
+    void flush()
+    {
+        if (!m_pending)
+            return;
+
+        m_func(static_cast<const diff_range<_MtvT>&>(m_range));
+        m_pending = false;
+    }
+};
+
+}
+
+/**
+ * Compare two multi_type_vector instances element by element, and report
+ * the ranges of elements that differ between them.  Two elements differ
+ * when they are of different types, or of the same type and compare
+ * unequal; positions past the end of the shorter container count as
+ * empty.  Adjacent differing elements get reported as one range, in
+ * ascending order of position.
+ *
+ * <p>Both block lists get walked in lockstep, one overlapping pair of
+ * blocks at a time.  Pairs of different types differ as a whole, pairs
+ * of empty blocks and blocks shared via a snapshot do not differ at all,
+ * and none of them have their elements looked at.  Elements of other
+ * pairs get compared by the element block functions without expanding
+ * constant runs, so that comparing two constant runs takes constant
+ * time.</p>
+ *
+ * <p>Updating a copy of the old container to the new one only requires
+ * resizing it to the size of the new container, and copying the elements
+ * of each reported range within that size from the new container, which
+ * the range gives the position of.</p>
+ *
+ * @param old_db old container.
+ * @param new_db new container.
+ * @param func function object that gets called with each range as a
+ *             <code>const diff_range<_MtvT>&</code>.  The positions stored
+ *             in it remain valid until either container gets modified.
+ */
+template<typename _MtvT, typename _Func>
+void diff(const _MtvT& old_db, const _MtvT& new_db, _Func func)
+{
+    typedef typename _MtvT::const_iterator const_iterator;
+    typedef typename _MtvT::element_block_func element_block_func;
+
+    detail::diff_range_collector<_MtvT, _Func> collector(func);
+
+    const_iterator it1 = old_db.begin(), it1_end = old_db.end();
+    const_iterator it2 = new_db.begin(), it2_end = new_db.end();
+    size_t total = std::max(old_db.size(), new_db.size());
+
+    for (size_t pos = 0; pos < total; )
+    {
+        // Past the end of a container, its elements count as empty up to
+        // the end of the other container.
+        size_t end1 = it1 == it1_end ? total : it1->position + it1->size;
+        size_t end2 = it2 == it2_end ? total : it2->position + it2->size;
+        element_t type1 = it1 == it1_end ? element_type_empty : it1->type;
+        element_t type2 = it2 == it2_end ? element_type_empty : it2->type;
+        size_t offset1 = it1 == it1_end ? 0 : pos - it1->position;
+        size_t offset2 = it2 == it2_end ? 0 : pos - it2->position;
+        size_t end = std::min(end1, end2);
+
+        if (type1 != type2)
+        {
+            collector.add(pos, end, it1, offset1, type1, it2, offset2, type2);
+        }
+        else if (type1 != element_type_empty)
+        {
+            const base_element_block& data1 = *it1->data;
+            const base_element_block& data2 = *it2->data;
+
+            // A block shared by both containers at the same position
+            // has the same elements on both sides.
+            if (&data1 != &data2 || offset1 != offset2)
+            {
+                size_t len = end - pos;
+                for (size_t i = 0; i < len; )
+                {
+                    i += element_block_func::match_length(data1, offset1+i, data2, offset2+i, len-i, true);
+                    if (i == len)
+                        break;
+
+                    size_t n = element_block_func::match_length(data1, offset1+i, data2, offset2+i, len-i, false);
+                    collector.add(pos+i, pos+i+n, it1, offset1+i, type1, it2, offset2+i, type2);
+                    i += n;
+                }
+            }
+        }
+
+        pos = end;
+        if (it1 != it1_end && end == end1)
+            ++it1;
+        if (it2 != it2_end && end == end2)
+            ++it2;
+    }
+
+    collector.flush();
+}
+
+/**
+ * Compare two multi_type_vector instances element by element, and return
+ * the ranges of elements that differ between them.
+ *
+ * @param old_db old container.
+ * @param new_db new container.
+ *
+ * @return ranges of differing elements in ascending order of position.
+ *
+ * @see diff(const _MtvT&, const _MtvT&, _Func)
+ */
+template<typename _MtvT>
+std::vector<diff_range<_MtvT>> diff(const _MtvT& old_db, const _MtvT& new_db)
+{
+    std::vector<diff_range<_MtvT>> ranges;
+    diff(old_db, new_db, [&ranges](const diff_range<_MtvT>& r) { ranges.push_back(r); });
+    return ranges;
+}
+
+}}
+
+#endif
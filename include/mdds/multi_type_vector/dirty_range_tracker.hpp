@@ -0,0 +1,182 @@
+/*************************************************************************
+ *
+ * Copyright (c) 2017 Kohei Yoshida
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ ************************************************************************/
+
+
+#ifndef INCLUDED_MDDS_MULTI_TYPE_VECTOR_DIRTY_RANGE_TRACKER_HPP
+#define INCLUDED_MDDS_MULTI_TYPE_VECTOR_DIRTY_RANGE_TRACKER_HPP
+
+#include "mdds/flat_segment_tree.hpp"
+#include "mdds/multi_type_vector_types.hpp"
+
+#include <cstddef>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace mdds { namespace mtv {
+
+/**
+ * Event handler that keeps track of the ranges of elements modified since
+ * the last checkpoint.  Pass it as the event handler type of a
+ * multi_type_vector, and access it via its event_handler() method.
+ *
+ * <p>Elements that got modified or inserted are marked dirty.  The dirty
+ * ranges follow the elements they mark when other elements get inserted or
+ * erased above them, so they always refer to the current positions of the
+ * modified elements.  Since inserting or erasing elements moves all the
+ * elements below them without modifying them, that is recorded separately
+ * and can be checked via structure_changed().</p>
+ *
+ * <p>To receive the element block events as well, derive from this class
+ * and define element_block_acquired() and element_block_released() in the
+ * derived class.</p>
+ */
+class dirty_range_tracker
+{
+public:
+    typedef flat_segment_tree<size_t, bool> ranges_type;
+
+    /** Dirty range, as a pair of start and end positions, end not inclusive. */
+    typedef std::pair<size_t, size_t> range_type;
+
+private:
+    ranges_type m_ranges;
+    bool m_structure_changed;
+
+public:
+    dirty_range_tracker() :
+        m_ranges(0, std::numeric_limits<size_t>::max(), false),
+        m_structure_changed(false) {}
+
+    void element_block_acquired(const base_element_block* /*block*/) {}
+
+    void element_block_released(const base_element_block* /*block*/) {}
+
+    void range_changed(const range_change_event& event)
+    {
+        switch (event.kind)
+        {
+            case range_change_modified:
+                m_ranges.insert_back(event.start, event.end, true);
+            break;
+            case range_change_inserted:
+                m_ranges.shift_right(event.start, event.end - event.start, false);
+                m_ranges.insert_back(event.start, event.end, true);
+                m_structure_changed = true;
+            break;
+            case range_change_erased:
+                m_ranges.shift_left(event.start, event.end);
+                m_structure_changed = true;
+            break;
+        }
+    }
+
+    /**
+     * Check whether the container has not been modified since the last
+     * checkpoint.
+     *
+     * @return true if no elements have been modified, inserted or erased
+     *         since the last checkpoint, false otherwise.
+     */
+    bool empty() const
+    {
+        return !m_structure_changed && m_ranges.leaf_size() <= 2 && !m_ranges.begin()->second;
+    }
+
+    /**
+     * Check whether any elements have been inserted or erased since the
+     * last checkpoint, which moves all the elements that follow them.
+     */
+    bool structure_changed() const
+    {
+        return m_structure_changed;
+    }
+
+    /**
+     * Check whether an element has been modified or inserted since the last
+     * checkpoint.
+     *
+     * @param pos logical position of the element.
+     */
+    bool is_dirty(size_t pos) const
+    {
+        bool dirty = false;
+        m_ranges.search(pos, dirty);
+        return dirty;
+    }
+
+    /**
+     * Get all dirty ranges in ascending order.  Adjacent dirty ranges are
+     * coalesced into one.
+     *
+     * @return array of dirty ranges.
+     */
+    std::vector<range_type> get_ranges() const
+    {
+        std::vector<range_type> ranges;
+        ranges_type::const_iterator it = m_ranges.begin(), it_end = m_ranges.end();
+        size_t start = it->first;
+        bool dirty = it->second;
+        for (++it; it != it_end; ++it)
+        {
+            // The segment [start, it->first) stores the dirty flag.
+            if (dirty)
+            {
+                if (!ranges.empty() && ranges.back().second == start)
+                    ranges.back().second = it->first;
+                else
+                    ranges.emplace_back(start, it->first);
+            }
+
+            start = it->first;
+            dirty = it->second;
+        }
+
+        return ranges;
+    }
+
+    /**
+     * Get the segment tree that stores the dirty flags.
+     */
+    const ranges_type& get_tree() const
+    {
+        return m_ranges;
+    }
+
+    /**
+     * Clear all dirty ranges and start tracking from a new checkpoint.
+     */
+    void reset()
+    {
+        m_ranges.clear();
+        m_structure_changed = false;
+    }
+};
+
+}}
+
+#endif
@@ -0,0 +1,93 @@
+/*************************************************************************
+ *
+ * Copyright (c) 2017 Kohei Yoshida
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ ************************************************************************/
+
+#ifndef INCLUDED_MDDS_MULTI_TYPE_VECTOR_ELEMENT_SPAN_HPP
+#define INCLUDED_MDDS_MULTI_TYPE_VECTOR_ELEMENT_SPAN_HPP
+
+#include <cassert>
+#include <cstddef>
+#include <type_traits>
+
+namespace mdds { namespace mtv {
+
+/**
+ * Non-owning view of a contiguous array of elements stored in an element
+ * block.  It stores only a pointer to the first element and the number of
+ * elements, and gives direct access to the element storage of the block
+ * without copying it.
+ *
+ * A span remains valid only as long as the block it refers to is not
+ * modified or destroyed.
+ */
+template<typename _T>
+class element_span
+{
+    _T* mp_data;
+    size_t m_size;
+
+public:
+    typedef typename std::remove_cv<_T>::type value_type;
+    typedef size_t size_type;
+    typedef _T* pointer;
+    typedef _T& reference;
+    typedef _T* iterator;
+
+    element_span() : mp_data(nullptr), m_size(0) {}
+    element_span(_T* p, size_t n) : mp_data(p), m_size(n) {}
+
+    pointer data() const { return mp_data; }
+    size_type size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+
+    iterator begin() const { return mp_data; }
+    iterator end() const { return mp_data + m_size; }
+
+    reference operator[] (size_type pos) const
+    {
+        assert(pos < m_size);
+        return mp_data[pos];
+    }
+
+    /**
+     * Get a view of a part of the elements of this span.
+     *
+     * @param offset position of the first element of the part, relative to
+     *               the start of this span.
+     * @param len number of elements in the part.
+     *
+     * @return span referencing the specified part.
+     */
+    element_span subspan(size_type offset, size_type len) const
+    {
+        assert(offset + len <= m_size);
+        return element_span(mp_data + offset, len);
+    }
+};
+
+}}
+
+#endif
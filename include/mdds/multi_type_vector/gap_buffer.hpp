@@ -0,0 +1,516 @@
+/*************************************************************************
+ *
+ * Copyright (c) 2017 Kohei Yoshida
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ ************************************************************************/
+
+#ifndef INCLUDED_MDDS_MULTI_TYPE_VECTOR_GAP_BUFFER_HPP
+#define INCLUDED_MDDS_MULTI_TYPE_VECTOR_GAP_BUFFER_HPP
+
+#include "memory_resource.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace mdds { namespace mtv {
+
+template<typename _T>
+class gap_buffer;
+
+namespace detail {
+
+/**
+ * Random access iterator over the elements of a gap_buffer, which skips
+ * the gap.
+ */
+template<typename _Buffer, typename _Value>
+class gap_buffer_iterator
+{
+    template<typename, typename>
+    friend class gap_buffer_iterator;
+
+    _Buffer* mp_buf;
+    size_t m_pos;
+
+public:
+    typedef std::random_access_iterator_tag iterator_category;
+    typedef typename std::remove_const<_Value>::type value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef _Value* pointer;
+    typedef _Value& reference;
+
+    gap_buffer_iterator() : mp_buf(nullptr), m_pos(0) {}
+    gap_buffer_iterator(_Buffer* buf, size_t pos) : mp_buf(buf), m_pos(pos) {}
+
+    /** Conversion from a non-const iterator to a const iterator. */
+    template<typename _Buffer2, typename _Value2,
+        typename = typename std::enable_if<std::is_convertible<_Value2*, _Value*>::value>::type>
+    gap_buffer_iterator(const gap_buffer_iterator<_Buffer2, _Value2>& r) :
+        mp_buf(r.mp_buf), m_pos(r.m_pos) {}
+
+    reference operator*() const { return (*mp_buf)[m_pos]; }
+    pointer operator->() const { return &(*mp_buf)[m_pos]; }
+    reference operator[](difference_type n) const { return (*mp_buf)[m_pos+n]; }
+
+    gap_buffer_iterator& operator++() { ++m_pos; return *this; }
+    gap_buffer_iterator& operator--() { --m_pos; return *this; }
+    gap_buffer_iterator operator++(int) { gap_buffer_iterator tmp(*this); ++m_pos; return tmp; }
+    gap_buffer_iterator operator--(int) { gap_buffer_iterator tmp(*this); --m_pos; return tmp; }
+
+    gap_buffer_iterator& operator+=(difference_type n) { m_pos += n; return *this; }
+    gap_buffer_iterator& operator-=(difference_type n) { m_pos -= n; return *this; }
+
+    gap_buffer_iterator operator+(difference_type n) const { return gap_buffer_iterator(mp_buf, m_pos+n); }
+    gap_buffer_iterator operator-(difference_type n) const { return gap_buffer_iterator(mp_buf, m_pos-n); }
+
+    friend gap_buffer_iterator operator+(difference_type n, const gap_buffer_iterator& it)
+    {
+        return it + n;
+    }
+
+    template<typename _Buffer2, typename _Value2>
+    difference_type operator-(const gap_buffer_iterator<_Buffer2, _Value2>& r) const
+    {
+        return difference_type(m_pos) - difference_type(r.m_pos);
+    }
+
+    template<typename _Buffer2, typename _Value2>
+    bool operator==(const gap_buffer_iterator<_Buffer2, _Value2>& r) const
+    {
+        return mp_buf == r.mp_buf && m_pos == r.m_pos;
+    }
+
+    template<typename _Buffer2, typename _Value2>
+    bool operator!=(const gap_buffer_iterator<_Buffer2, _Value2>& r) const
+    {
+        return !operator==(r);
+    }
+
+    template<typename _Buffer2, typename _Value2>
+    bool operator<(const gap_buffer_iterator<_Buffer2, _Value2>& r) const { return m_pos < r.m_pos; }
+
+    template<typename _Buffer2, typename _Value2>
+    bool operator>(const gap_buffer_iterator<_Buffer2, _Value2>& r) const { return m_pos > r.m_pos; }
+
+    template<typename _Buffer2, typename _Value2>
+    bool operator<=(const gap_buffer_iterator<_Buffer2, _Value2>& r) const { return m_pos <= r.m_pos; }
+
+    template<typename _Buffer2, typename _Value2>
+    bool operator>=(const gap_buffer_iterator<_Buffer2, _Value2>& r) const { return m_pos >= r.m_pos; }
+
+    size_t position() const { return m_pos; }
+};
+
+}
+
+/**
+ * Array container with an interface similar to that of std::vector, which
+ * keeps the unused part of its storage as a gap located where the last
+ * insertion or erasure took place, rather than at the end.  Inserting or
+ * erasing elements at or near the gap only moves the elements between the
+ * old and the new gap position, which makes a series of insertions or
+ * erasures around the same position take time proportional to the
+ * distance traveled rather than to the number of elements stored.
+ * Appending to the end or accessing elements by index is slightly slower
+ * than with std::vector, and the storage is not contiguous.
+ *
+ * It can be used as the storage of an element block by passing it as the
+ * store type template argument of the element block.  Storage is
+ * allocated from the memory resource installed for the current thread, if
+ * any.
+ */
+template<typename _T>
+class gap_buffer
+{
+public:
+    typedef _T value_type;
+    typedef size_t size_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef _T& reference;
+    typedef const _T& const_reference;
+    typedef _T* pointer;
+    typedef const _T* const_pointer;
+    typedef detail::gap_buffer_iterator<gap_buffer, _T> iterator;
+    typedef detail::gap_buffer_iterator<const gap_buffer, const _T> const_iterator;
+    typedef std::reverse_iterator<iterator> reverse_iterator;
+    typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+
+private:
+    // Elements are stored in [0, m_gap_begin) and [m_gap_end, m_capacity).
+    pointer m_data;
+    size_type m_capacity;
+    size_type m_gap_begin;
+    size_type m_gap_end;
+
+    /** Memory resource m_data was allocated from. */
+    memory_resource* mp_resource;
+
+    size_type gap_size() const
+    {
+        return m_gap_end - m_gap_begin;
+    }
+
+    static pointer allocate(memory_resource* res, size_type n)
+    {
+        return n ? static_cast<pointer>(detail::allocate(res, n*sizeof(_T), alignof(_T))) : nullptr;
+    }
+
+    void deallocate()
+    {
+        detail::deallocate(mp_resource, m_data, m_capacity*sizeof(_T), alignof(_T));
+    }
+
+    static void destroy(pointer it, pointer it_end)
+    {
+        for (; it != it_end; ++it)
+            it->~_T();
+    }
+
+    /**
+     * Move all elements into a new storage of the specified capacity,
+     * keeping the gap at the same logical position.
+     */
+    void reallocate(size_type new_capacity)
+    {
+        size_type tail = m_capacity - m_gap_end;
+        memory_resource* res = detail::current_memory_resource();
+        pointer p = allocate(res, new_capacity);
+        size_type new_gap_end = new_capacity - tail;
+
+        std::uninitialized_copy(
+            std::make_move_iterator(m_data), std::make_move_iterator(m_data+m_gap_begin), p);
+        std::uninitialized_copy(
+            std::make_move_iterator(m_data+m_gap_end), std::make_move_iterator(m_data+m_capacity), p+new_gap_end);
+
+        destroy(m_data, m_data+m_gap_begin);
+        destroy(m_data+m_gap_end, m_data+m_capacity);
+        deallocate();
+
+        m_data = p;
+        m_capacity = new_capacity;
+        mp_resource = res;
+        m_gap_end = new_gap_end;
+    }
+
+    /**
+     * Move the gap so that it starts at the specified logical position.
+     */
+    void move_gap(size_type pos)
+    {
+        if (!gap_size())
+        {
+            m_gap_begin = m_gap_end = pos;
+            return;
+        }
+
+        // Move the elements one at a time across the gap, which leaves the
+        // gap uninitialized.
+        for (; m_gap_begin > pos; --m_gap_begin, --m_gap_end)
+        {
+            new (m_data+m_gap_end-1) _T(std::move(m_data[m_gap_begin-1]));
+            m_data[m_gap_begin-1].~_T();
+        }
+
+        for (; m_gap_begin < pos; ++m_gap_begin, ++m_gap_end)
+        {
+            new (m_data+m_gap_begin) _T(std::move(m_data[m_gap_end]));
+            m_data[m_gap_end].~_T();
+        }
+    }
+
+    /**
+     * Make sure that the gap can hold at least the specified number of
+     * elements.
+     */
+    void reserve_gap(size_type n)
+    {
+        if (gap_size() < n)
+            reallocate(std::max(size() + n, m_capacity * 2));
+    }
+
+    /**
+     * Open a gap of the specified size at the specified position, and
+     * return a pointer to its beginning.  The caller is responsible for
+     * constructing the new elements and advancing m_gap_begin past them.
+     */
+    pointer open_gap(size_type pos, size_type n)
+    {
+        move_gap(pos);
+        reserve_gap(n);
+        return m_data + m_gap_begin;
+    }
+
+public:
+    gap_buffer() : m_data(nullptr), m_capacity(0), m_gap_begin(0), m_gap_end(0), mp_resource(nullptr) {}
+
+    explicit gap_buffer(size_type n) : gap_buffer()
+    {
+        resize(n);
+    }
+
+    gap_buffer(size_type n, const _T& val) : gap_buffer()
+    {
+        pointer p = open_gap(0, n);
+        for (; m_gap_begin < n; ++p, ++m_gap_begin)
+            new (p) _T(val);
+    }
+
+    template<typename _Iter, typename = typename std::enable_if<!std::is_integral<_Iter>::value>::type>
+    gap_buffer(_Iter it_begin, _Iter it_end) : gap_buffer()
+    {
+        insert(end(), it_begin, it_end);
+    }
+
+    gap_buffer(const gap_buffer& r) : gap_buffer()
+    {
+        insert(end(), r.begin(), r.end());
+    }
+
+    gap_buffer(gap_buffer&& r) : gap_buffer()
+    {
+        swap(r);
+    }
+
+    ~gap_buffer()
+    {
+        clear();
+        deallocate();
+    }
+
+    gap_buffer& operator= (const gap_buffer& r)
+    {
+        if (this != &r)
+            assign(r.begin(), r.end());
+        return *this;
+    }
+
+    gap_buffer& operator= (gap_buffer&& r)
+    {
+        gap_buffer tmp(std::move(r));
+        swap(tmp);
+        return *this;
+    }
+
+    bool operator== (const gap_buffer& r) const
+    {
+        return size() == r.size() && std::equal(begin(), end(), r.begin());
+    }
+
+    bool operator!= (const gap_buffer& r) const
+    {
+        return !operator==(r);
+    }
+
+    iterator begin() { return iterator(this, 0); }
+    iterator end() { return iterator(this, size()); }
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, size()); }
+
+    reverse_iterator rbegin() { return reverse_iterator(end()); }
+    reverse_iterator rend() { return reverse_iterator(begin()); }
+    const_reverse_iterator rbegin() const { return const_reverse_iterator(end()); }
+    const_reverse_iterator rend() const { return const_reverse_iterator(begin()); }
+
+    size_type size() const { return m_capacity - gap_size(); }
+
+    /**
+     * Get the logical position of the gap, which is the number of elements
+     * stored before it.  The elements on either side of the gap are
+     * contiguous in memory.
+     */
+    size_type gap_position() const { return m_gap_begin; }
+    size_type capacity() const { return m_capacity; }
+    bool empty() const { return size() == 0; }
+
+    reference operator[] (size_type pos)
+    {
+        return m_data[pos < m_gap_begin ? pos : pos + gap_size()];
+    }
+
+    const_reference operator[] (size_type pos) const
+    {
+        return m_data[pos < m_gap_begin ? pos : pos + gap_size()];
+    }
+
+    reference at(size_type pos)
+    {
+        if (pos >= size())
+            throw std::out_of_range("gap_buffer::at: position is out of range.");
+        return operator[](pos);
+    }
+
+    const_reference at(size_type pos) const
+    {
+        if (pos >= size())
+            throw std::out_of_range("gap_buffer::at: position is out of range.");
+        return operator[](pos);
+    }
+
+    reference front() { return operator[](0); }
+    const_reference front() const { return operator[](0); }
+    reference back() { return operator[](size()-1); }
+    const_reference back() const { return operator[](size()-1); }
+
+    void reserve(size_type n)
+    {
+        if (n > m_capacity)
+            reallocate(n);
+    }
+
+    void shrink_to_fit()
+    {
+        if (gap_size())
+            reallocate(size());
+    }
+
+    void clear()
+    {
+        destroy(m_data, m_data+m_gap_begin);
+        destroy(m_data+m_gap_end, m_data+m_capacity);
+        m_gap_begin = 0;
+        m_gap_end = m_capacity;
+    }
+
+    void resize(size_type n)
+    {
+        size_type cur = size();
+        if (n < cur)
+        {
+            erase(begin()+n, end());
+            return;
+        }
+
+        pointer p = open_gap(cur, n - cur);
+        for (; cur < n; ++cur, ++p, ++m_gap_begin)
+            new (p) _T();
+    }
+
+    void push_back(const _T& val)
+    {
+        insert(end(), val);
+    }
+
+    void push_back(_T&& val)
+    {
+        insert(end(), std::move(val));
+    }
+
+    template<typename... _Args>
+    void emplace_back(_Args&&... args)
+    {
+        emplace(end(), std::forward<_Args>(args)...);
+    }
+
+    void pop_back()
+    {
+        erase(end()-1);
+    }
+
+    template<typename... _Args>
+    iterator emplace(const_iterator pos, _Args&&... args)
+    {
+        size_type offset = pos.position();
+        new (open_gap(offset, 1)) _T(std::forward<_Args>(args)...);
+        ++m_gap_begin;
+        return iterator(this, offset);
+    }
+
+    iterator insert(const_iterator pos, const _T& val)
+    {
+        // The value may refer to an element of this container, which
+        // moving the gap would invalidate.
+        _T tmp(val);
+        return insert(pos, std::move(tmp));
+    }
+
+    iterator insert(const_iterator pos, _T&& val)
+    {
+        size_type offset = pos.position();
+        new (open_gap(offset, 1)) _T(std::move(val));
+        ++m_gap_begin;
+        return iterator(this, offset);
+    }
+
+    iterator insert(const_iterator pos, size_type n, const _T& val)
+    {
+        _T tmp(val);
+        size_type offset = pos.position();
+        pointer p = open_gap(offset, n);
+        for (size_type i = 0; i < n; ++i, ++p, ++m_gap_begin)
+            new (p) _T(tmp);
+
+        return iterator(this, offset);
+    }
+
+    template<typename _Iter, typename = typename std::enable_if<!std::is_integral<_Iter>::value>::type>
+    iterator insert(const_iterator pos, _Iter it_begin, _Iter it_end)
+    {
+        size_type offset = pos.position();
+        pointer p = open_gap(offset, std::distance(it_begin, it_end));
+        for (; it_begin != it_end; ++it_begin, ++p, ++m_gap_begin)
+            new (p) _T(*it_begin);
+
+        return iterator(this, offset);
+    }
+
+    iterator erase(const_iterator pos)
+    {
+        return erase(pos, pos+1);
+    }
+
+    iterator erase(const_iterator it_begin, const_iterator it_end)
+    {
+        size_type offset = it_begin.position();
+        size_type n = it_end - it_begin;
+        move_gap(offset);
+        destroy(m_data+m_gap_end, m_data+m_gap_end+n);
+        m_gap_end += n;
+        return iterator(this, offset);
+    }
+
+    template<typename _Iter, typename = typename std::enable_if<!std::is_integral<_Iter>::value>::type>
+    void assign(_Iter it_begin, _Iter it_end)
+    {
+        clear();
+        insert(end(), it_begin, it_end);
+    }
+
+    void swap(gap_buffer& r)
+    {
+        std::swap(m_data, r.m_data);
+        std::swap(m_capacity, r.m_capacity);
+        std::swap(m_gap_begin, r.m_gap_begin);
+        std::swap(m_gap_end, r.m_gap_end);
+        std::swap(mp_resource, r.mp_resource);
+    }
+};
+
+}}
+
+#endif
@@ -0,0 +1,363 @@
+/*************************************************************************
+ *
+ * Copyright (c) 2017 Kohei Yoshida
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ ************************************************************************/
+
+#ifndef INCLUDED_MDDS_MULTI_TYPE_VECTOR_MEMORY_RESOURCE_HPP
+#define INCLUDED_MDDS_MULTI_TYPE_VECTOR_MEMORY_RESOURCE_HPP
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+namespace mdds { namespace mtv {
+
+/**
+ * Interface for a source of memory used by multi_type_vector for its
+ * block headers, its element blocks, and the element storage of the
+ * element blocks.
+ *
+ * A memory resource is put to use by installing it for the current
+ * thread with scoped_memory_resource.  Each element block and each element
+ * storage allocated while it is installed records where its memory came
+ * from, and returns it to the same memory resource when freed, regardless
+ * of which memory resource is installed at that time.  A memory resource
+ * must therefore outlive all the containers that use memory allocated
+ * from it.  Memory allocated while no memory resource is installed comes
+ * directly from the global heap.
+ */
+class memory_resource
+{
+public:
+    virtual ~memory_resource() {}
+
+    /**
+     * Allocate a block of memory.
+     *
+     * @param size size of the memory block in bytes.
+     * @param alignment alignment requirement of the memory block.
+     *
+     * @return pointer to the allocated memory block.
+     */
+    virtual void* allocate(size_t size, size_t alignment) = 0;
+
+    /**
+     * Free a block of memory previously allocated by this resource.
+     *
+     * @param p pointer to the memory block to free.
+     * @param size size of the memory block in bytes.
+     * @param alignment alignment requirement of the memory block.
+     */
+    virtual void deallocate(void* p, size_t size, size_t alignment) = 0;
+};
+
+/**
+ * Memory resource that hands out memory from large chunks, and never
+ * frees individual allocations.  All memory is released at once when the
+ * arena gets destroyed, which makes discarding a large container built
+ * with it a bulk release rather than one free per block.
+ *
+ * Allocating from an arena is not thread-safe; install it on one thread at
+ * a time.  Since freeing is a no-op, the memory allocated from it may be
+ * freed on any thread, e.g. when a snapshot of a container gets dropped on
+ * a different thread than the one that built the container.
+ */
+class arena : public memory_resource
+{
+    std::vector<char*> m_chunks;
+    char* mp_cur;
+    size_t m_remaining;
+    size_t m_chunk_size;
+
+public:
+    arena(const arena&) = delete;
+    arena& operator=(const arena&) = delete;
+
+    /**
+     * @param chunk_size size of each chunk of memory allocated from the
+     *                   global heap, in bytes.
+     */
+    explicit arena(size_t chunk_size = 1024*1024) :
+        mp_cur(nullptr), m_remaining(0), m_chunk_size(chunk_size) {}
+
+    virtual ~arena()
+    {
+        std::for_each(m_chunks.begin(), m_chunks.end(), [](char* p) { ::operator delete(p); });
+    }
+
+    virtual void* allocate(size_t size, size_t alignment) override
+    {
+        size_t padding = reinterpret_cast<size_t>(mp_cur) % alignment;
+        if (padding)
+            padding = alignment - padding;
+
+        if (padding + size > m_remaining)
+        {
+            // Memory returned from the global heap is suitably aligned
+            // for any type.
+            size_t chunk_size = std::max(size, m_chunk_size);
+            m_chunks.reserve(m_chunks.size()+1);
+            mp_cur = static_cast<char*>(::operator new(chunk_size));
+            m_chunks.push_back(mp_cur);
+            m_remaining = chunk_size;
+            padding = 0;
+        }
+
+        char* p = mp_cur + padding;
+        mp_cur = p + size;
+        m_remaining -= padding + size;
+        return p;
+    }
+
+    virtual void deallocate(void*, size_t, size_t) override
+    {
+        // Memory is released only when the arena is destroyed.
+    }
+};
+
+/**
+ * Memory resource that keeps the memory of freed allocations in free lists
+ * sorted by size, and hands it out again to later allocations of the same
+ * size class instead of returning it to the global heap.  Editing that
+ * repeatedly splits and merges blocks creates and destroys element blocks
+ * of the same few types and sizes, and with a recycling pool installed
+ * they get recycled without going through the global heap.
+ *
+ * Allocations no larger than the maximum pooled size get carved out of
+ * large chunks; larger ones are passed on to the global heap.  The pooled
+ * memory is released only when the pool gets destroyed, so its footprint
+ * stays at the peak usage until then.
+ *
+ * A recycling pool is thread-safe.  Containers that share element blocks,
+ * such as a container and its snapshots, may free the memory allocated
+ * from it on any thread, and the same pool may be installed on several
+ * threads at once, at the cost of contention on its lock.
+ */
+class recycling_pool : public memory_resource
+{
+    struct free_node
+    {
+        free_node* next;
+    };
+
+    /** Size classes are multiples of the strictest fundamental alignment. */
+    static constexpr size_t granularity = alignof(std::max_align_t);
+
+    std::vector<free_node*> m_free_lists;
+    std::vector<char*> m_chunks;
+    char* mp_cur;
+    size_t m_remaining;
+    size_t m_chunk_size;
+    std::mutex m_mutex;
+
+    size_t size_class(size_t size) const
+    {
+        return (size + granularity - 1) / granularity - 1;
+    }
+
+public:
+    recycling_pool(const recycling_pool&) = delete;
+    recycling_pool& operator=(const recycling_pool&) = delete;
+
+    /**
+     * @param max_pooled_size size of the largest allocation to recycle, in
+     *                        bytes.
+     * @param chunk_size size of each chunk of memory allocated from the
+     *                   global heap, in bytes.
+     */
+    explicit recycling_pool(size_t max_pooled_size = 1024, size_t chunk_size = 64*1024) :
+        m_free_lists(max_pooled_size ? size_class(max_pooled_size)+1 : 0, nullptr),
+        mp_cur(nullptr), m_remaining(0), m_chunk_size(chunk_size) {}
+
+    virtual ~recycling_pool()
+    {
+        std::for_each(m_chunks.begin(), m_chunks.end(), [](char* p) { ::operator delete(p); });
+    }
+
+    virtual void* allocate(size_t size, size_t alignment) override
+    {
+        assert(alignment <= granularity);
+        (void)alignment;
+
+        size_t cls = size_class(size);
+        if (cls >= m_free_lists.size())
+            return ::operator new(size);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        free_node*& head = m_free_lists[cls];
+        if (head)
+        {
+            free_node* p = head;
+            head = p->next;
+            return p;
+        }
+
+        size_t bytes = (cls+1) * granularity;
+        if (bytes > m_remaining)
+        {
+            // Memory returned from the global heap is suitably aligned
+            // for any type.  What remains of the previous chunk is left
+            // unused.
+            size_t chunk_size = std::max(bytes, m_chunk_size);
+            m_chunks.reserve(m_chunks.size()+1);
+            mp_cur = static_cast<char*>(::operator new(chunk_size));
+            m_chunks.push_back(mp_cur);
+            m_remaining = chunk_size;
+        }
+
+        char* p = mp_cur;
+        mp_cur += bytes;
+        m_remaining -= bytes;
+        return p;
+    }
+
+    virtual void deallocate(void* p, size_t size, size_t) override
+    {
+        size_t cls = size_class(size);
+        if (cls >= m_free_lists.size())
+        {
+            ::operator delete(p);
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        free_node* node = static_cast<free_node*>(p);
+        node->next = m_free_lists[cls];
+        m_free_lists[cls] = node;
+    }
+};
+
+namespace detail {
+
+inline memory_resource*& current_memory_resource()
+{
+    static thread_local memory_resource* p = nullptr;
+    return p;
+}
+
+/**
+ * Allocate memory from the specified memory resource, or from the global
+ * heap if it is nullptr.  The caller remembers the memory resource, and
+ * passes it back to deallocate() along with the memory.
+ */
+inline void* allocate(memory_resource* res, size_t size, size_t alignment)
+{
+    assert(alignment <= alignof(std::max_align_t));
+    return res ? res->allocate(size, alignment) : ::operator new(size);
+}
+
+inline void deallocate(memory_resource* res, void* p, size_t size, size_t alignment)
+{
+    if (!p)
+        return;
+
+    if (res)
+        res->deallocate(p, size, alignment);
+    else
+        ::operator delete(p);
+}
+
+/**
+ * Standard allocator that allocates its memory from the memory resource
+ * that was installed for the current thread when the allocator was
+ * constructed.  A container copied with it picks up the memory resource
+ * installed at the time of the copy, while a container moved or swapped
+ * with it takes its allocator along with its storage.
+ */
+template<typename _T>
+struct resource_allocator
+{
+    typedef _T value_type;
+
+    typedef std::false_type propagate_on_container_copy_assignment;
+    typedef std::true_type propagate_on_container_move_assignment;
+    typedef std::true_type propagate_on_container_swap;
+
+    memory_resource* resource;
+
+    resource_allocator() : resource(current_memory_resource()) {}
+
+    template<typename _U>
+    resource_allocator(const resource_allocator<_U>& r) : resource(r.resource) {}
+
+    resource_allocator select_on_container_copy_construction() const
+    {
+        return resource_allocator();
+    }
+
+    _T* allocate(size_t n)
+    {
+        return static_cast<_T*>(detail::allocate(resource, n*sizeof(_T), alignof(_T)));
+    }
+
+    void deallocate(_T* p, size_t n)
+    {
+        detail::deallocate(resource, p, n*sizeof(_T), alignof(_T));
+    }
+
+    template<typename _U>
+    bool operator== (const resource_allocator<_U>& r) const { return resource == r.resource; }
+
+    template<typename _U>
+    bool operator!= (const resource_allocator<_U>& r) const { return resource != r.resource; }
+};
+
+}
+
+/**
+ * Install a memory resource for the current thread for the lifetime of
+ * this object.  The previously installed memory resource, if any, gets
+ * restored when this object is destroyed.
+ *
+ * All multi_type_vector instances modified on the current thread while a
+ * memory resource is installed allocate their memory from it.
+ */
+class scoped_memory_resource
+{
+    memory_resource* mp_prev;
+
+public:
+    scoped_memory_resource(const scoped_memory_resource&) = delete;
+    scoped_memory_resource& operator=(const scoped_memory_resource&) = delete;
+
+    explicit scoped_memory_resource(memory_resource& res) :
+        mp_prev(detail::current_memory_resource())
+    {
+        detail::current_memory_resource() = &res;
+    }
+
+    ~scoped_memory_resource()
+    {
+        detail::current_memory_resource() = mp_prev;
+    }
+};
+
+}}
+
+#endif
@@ -0,0 +1,194 @@
+/*************************************************************************
+ *
+ * Copyright (c) 2017 Kohei Yoshida
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ ************************************************************************/
+
+#ifndef INCLUDED_MDDS_MULTI_TYPE_VECTOR_PARALLEL_HPP
+#define INCLUDED_MDDS_MULTI_TYPE_VECTOR_PARALLEL_HPP
+
+#include "mdds/multi_type_vector_types.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace mdds { namespace mtv {
+
+/**
+ * Contiguous run of elements within a single block of a
+ * multi_type_vector, as passed to the function object of
+ * parallel_for_each_block().
+ */
+struct block_span
+{
+    /** type of the block. */
+    element_t type;
+
+    /** element block, or nullptr if the block is empty. */
+    const base_element_block* data;
+
+    /** offset of the first element of the run within the block. */
+    size_t offset;
+
+    /** number of elements in the run. */
+    size_t size;
+
+    /** logical position of the first element of the run. */
+    size_t position;
+};
+
+namespace detail {
+
+/**
+ * Split all blocks of a container into runs of no more than the specified
+ * number of elements.  Empty blocks never get split, since visiting them
+ * involves no work proportional to their size.
+ */
+template<typename _MtvT>
+std::vector<block_span> partition_blocks(const _MtvT& db, size_t chunk_size)
+{
+    std::vector<block_span> spans;
+    spans.reserve(db.block_size());
+
+    typename _MtvT::const_iterator it = db.begin(), it_end = db.end();
+    for (; it != it_end; ++it)
+    {
+        size_t step = it->data ? chunk_size : it->size;
+        for (size_t offset = 0; offset < it->size; offset += step)
+        {
+            block_span span;
+            span.type = it->type;
+            span.data = it->data;
+            span.offset = offset;
+            span.size = std::min(step, it->size - offset);
+            span.position = it->position + offset;
+            spans.push_back(span);
+        }
+    }
+
+    return spans;
+}
+
+}
+
+/**
+ * Visit all blocks of a multi_type_vector using multiple threads.  The
+ * blocks are split into runs of elements, blocks larger than the chunk
+ * size being split into several runs, and the runs get distributed among
+ * the worker threads as they become free.  The function object gets
+ * called once for each run with a block_span instance describing it.
+ *
+ * <p>The function object is shared among all worker threads, and gets
+ * called concurrently; it must therefore be safe to call from multiple
+ * threads at once.  No particular order of the calls is guaranteed.  The
+ * container must not be modified while this function is running.</p>
+ *
+ * <p>The calling thread participates as one of the worker threads.  If
+ * the function object throws, the remaining runs get skipped, and the
+ * first exception thrown gets re-thrown on the calling thread once all
+ * worker threads have finished.</p>
+ *
+ * @param db container to visit the blocks of.
+ * @param func function object to call for each run of elements.
+ * @param thread_count number of threads to use, including the calling
+ *                     thread.  When 0, the number of hardware threads
+ *                     available is used.
+ * @param chunk_size maximum number of elements in each run of a non-empty
+ *                   block.  When 0, it is chosen so that each thread
+ *                   processes several runs on average.
+ */
+template<typename _MtvT, typename _Func>
+void parallel_for_each_block(
+    const _MtvT& db, _Func func, size_t thread_count = 0, size_t chunk_size = 0)
+{
+    if (!thread_count)
+        thread_count = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+
+    if (!chunk_size)
+        chunk_size = std::max<size_t>(db.size() / (thread_count*4), 1);
+
+    std::vector<block_span> spans = detail::partition_blocks(db, chunk_size);
+    thread_count = std::min(thread_count, spans.size());
+
+    if (thread_count <= 1)
+    {
+        std::for_each(spans.begin(), spans.end(), func);
+        return;
+    }
+
+    std::atomic<size_t> next(0);
+    std::atomic<bool> failed(false);
+    std::exception_ptr error;
+    std::mutex error_mtx;
+
+    auto worker = [&]()
+    {
+        try
+        {
+            for (size_t i = next++; i < spans.size() && !failed; i = next++)
+                func(spans[i]);
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(error_mtx);
+            if (!error)
+                error = std::current_exception();
+            failed = true;
+        }
+    };
+
+    std::vector<std::thread> workers;
+    workers.reserve(thread_count-1);
+
+    try
+    {
+        for (size_t i = 1; i < thread_count; ++i)
+            workers.emplace_back(worker);
+    }
+    catch (...)
+    {
+        // Failed to launch a thread.  Stop the ones already running.
+        failed = true;
+        for (std::thread& t : workers)
+            t.join();
+        throw;
+    }
+
+    worker();
+
+    for (std::thread& t : workers)
+        t.join();
+
+    if (error)
+        std::rethrow_exception(error);
+}
+
+}}
+
+#endif
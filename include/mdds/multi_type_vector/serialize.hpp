@@ -0,0 +1,802 @@
+/*************************************************************************
+ *
+ * Copyright (c) 2017 Kohei Yoshida
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ ************************************************************************/
+
+#ifndef INCLUDED_MDDS_MULTI_TYPE_VECTOR_SERIALIZE_HPP
+#define INCLUDED_MDDS_MULTI_TYPE_VECTOR_SERIALIZE_HPP
+
+#include "mdds/global.hpp"
+#include "mdds/multi_type_vector_types.hpp"
+#include "mdds/multi_type_vector/element_span.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <limits>
+#include <memory>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+/*
+ * Binary format written by serialize(), version 1.  All integers are
+ * stored in the byte order of the machine that wrote them, which the
+ * reader verifies via the byte order mark.
+ *
+ * <pre>
+ * header (32 bytes)
+ *   char[8]   magic "MDDS-MTV"
+ *   uint32    format version
+ *   uint32    byte order mark 0x01020304
+ *   uint64    number of elements
+ *   uint64    number of blocks
+ *
+ * each block (24-byte header followed by its payload)
+ *   int32     element type
+ *   uint32    size of each element in bytes for a block of raw values,
+ *             otherwise 0
+ *   uint64    number of elements
+ *   uint64    payload size in bytes, excluding the padding
+ *   payload, padded with zeros to a multiple of 8 bytes
+ * </pre>
+ *
+ * The payload of an empty block is empty.  Blocks of the standard numeric,
+ * integer and character types store their values as a raw array, and
+ * boolean blocks store one byte per value.  String blocks store each value
+ * as a uint64 length followed by its characters.  The payload of a block
+ * of a user-defined type is written and read by the serializer passed to
+ * serialize() and deserialize().  Since the header and each payload are
+ * padded to a multiple of 8 bytes, each raw array is aligned to 8 bytes
+ * relative to the start of the data.
+ */
+
+namespace mdds { namespace mtv {
+
+/**
+ * Default serializer of user-defined element blocks, which supports none.
+ * A serializer that supports user-defined element blocks must provide the
+ * same two methods.
+ */
+struct standard_block_serializer
+{
+    /**
+     * Write the payload of a block of a user-defined type.
+     *
+     * @param data element block to write.
+     * @param os stream to write the payload to.
+     *
+     * @return true if the block has been written, false if its type is not
+     *         supported.
+     */
+    bool write_block(const base_element_block& /*data*/, std::ostream& /*os*/) const
+    {
+        return false;
+    }
+
+    /**
+     * Read the payload of a block of a user-defined type, and append its
+     * values to the container being loaded.  The payload is complete, but
+     * it comes from the serialized data as is, so that the serializer must
+     * validate it, and not allocate storage for the number of elements
+     * before checking it against the payload size.
+     *
+     * @param type element type of the block.
+     * @param size number of elements in the block.
+     * @param payload pointer to the payload written by write_block().
+     * @param payload_size size of the payload in bytes.
+     * @param builder builder of the container to append the values to.
+     *
+     * @return true if the block has been read, false if its type is not
+     *         supported.
+     */
+    template<typename _Builder>
+    bool read_block(
+        element_t /*type*/, size_t /*size*/, const char* /*payload*/, size_t /*payload_size*/,
+        _Builder& /*builder*/) const
+    {
+        return false;
+    }
+};
+
+namespace detail {
+
+const char serialize_magic[8] = { 'M', 'D', 'D', 'S', '-', 'M', 'T', 'V' };
+const uint32_t serialize_version = 1;
+const uint32_t serialize_byte_order = 0x01020304;
+const size_t serialize_header_size = 32;
+const size_t serialize_block_header_size = 24;
+
+/**
+ * Largest number of payload bytes read from a stream at a time, so that a
+ * corrupt payload size in a truncated stream does not cause the whole
+ * payload buffer to be allocated up front.
+ */
+const size_t serialize_read_chunk_size = 1024*1024;
+
+inline size_t serialize_padding(size_t n)
+{
+    return (8 - n % 8) % 8;
+}
+
+template<typename _T>
+void write_raw(std::ostream& os, const _T& v)
+{
+    os.write(reinterpret_cast<const char*>(&v), sizeof(v));
+}
+
+template<typename _T>
+_T read_raw(const char* p)
+{
+    _T v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+/**
+ * Size of each element of a block stored as a raw array, or 0 for the
+ * block types that are not.
+ */
+inline uint32_t raw_value_width(element_t type)
+{
+    switch (type)
+    {
+        case element_type_numeric:
+            return sizeof(numeric_element_block::value_type);
+        case element_type_short:
+            return sizeof(short_element_block::value_type);
+        case element_type_ushort:
+            return sizeof(ushort_element_block::value_type);
+        case element_type_int:
+            return sizeof(int_element_block::value_type);
+        case element_type_uint:
+            return sizeof(uint_element_block::value_type);
+        case element_type_long:
+            return sizeof(long_element_block::value_type);
+        case element_type_ulong:
+            return sizeof(ulong_element_block::value_type);
+        case element_type_char:
+            return sizeof(char_element_block::value_type);
+        case element_type_uchar:
+            return sizeof(uchar_element_block::value_type);
+        case element_type_boolean:
+            return 1;
+        default:
+            ;
+    }
+    return 0;
+}
+
+template<typename _Blk>
+void write_values(std::ostream& os, const base_element_block& data, size_t n, std::true_type)
+{
+    typedef typename _Blk::value_type value_type;
+    os.write(reinterpret_cast<const char*>(_Blk::data(data)), n * sizeof(value_type));
+}
+
+template<typename _Blk>
+void write_values(std::ostream& os, const base_element_block& data, size_t, std::false_type)
+{
+    typename _Blk::const_iterator it = _Blk::begin(data), it_end = _Blk::end(data);
+    for (; it != it_end; ++it)
+        write_raw(os, *it);
+}
+
+template<typename _Blk>
+void write_raw_block(std::ostream& os, const base_element_block& data, size_t n)
+{
+    if (_Blk::is_constant(data))
+    {
+        // Write the values of a constant run without expanding it.
+        const typename _Blk::value_type& v = _Blk::at(data, 0);
+        for (size_t i = 0; i < n; ++i)
+            write_raw(os, v);
+        return;
+    }
+
+    write_values<_Blk>(os, data, n, std::integral_constant<bool, _Blk::contiguous>());
+}
+
+inline void write_boolean_block(std::ostream& os, const base_element_block& data, size_t n)
+{
+    std::vector<char> buf;
+    buf.reserve(n);
+    if (boolean_element_block::is_constant(data))
+    {
+        bool v = false;
+        boolean_element_block::get_value(data, 0, v);
+        buf.assign(n, v ? 1 : 0);
+    }
+    else
+    {
+        boolean_element_block::const_iterator it = boolean_element_block::begin(data);
+        boolean_element_block::const_iterator it_end = boolean_element_block::end(data);
+        for (; it != it_end; ++it)
+            buf.push_back(*it ? 1 : 0);
+    }
+
+    os.write(buf.data(), buf.size());
+}
+
+inline void write_string_block(std::ostream& os, const base_element_block& data, size_t n)
+{
+    for (size_t i = 0; i < n; ++i)
+    {
+        const std::string& s = string_element_block::at(data, i);
+        write_raw(os, static_cast<uint64_t>(s.size()));
+        os.write(s.data(), s.size());
+    }
+}
+
+template<typename _Hook>
+void write_block_payload(
+    std::ostream& os, element_t type, const base_element_block& data, size_t n, const _Hook& hook)
+{
+    switch (type)
+    {
+        case element_type_numeric:
+            write_raw_block<numeric_element_block>(os, data, n);
+            break;
+        case element_type_short:
+            write_raw_block<short_element_block>(os, data, n);
+            break;
+        case element_type_ushort:
+            write_raw_block<ushort_element_block>(os, data, n);
+            break;
+        case element_type_int:
+            write_raw_block<int_element_block>(os, data, n);
+            break;
+        case element_type_uint:
+            write_raw_block<uint_element_block>(os, data, n);
+            break;
+        case element_type_long:
+            write_raw_block<long_element_block>(os, data, n);
+            break;
+        case element_type_ulong:
+            write_raw_block<ulong_element_block>(os, data, n);
+            break;
+        case element_type_char:
+            write_raw_block<char_element_block>(os, data, n);
+            break;
+        case element_type_uchar:
+            write_raw_block<uchar_element_block>(os, data, n);
+            break;
+        case element_type_boolean:
+            write_boolean_block(os, data, n);
+            break;
+        case element_type_string:
+            write_string_block(os, data, n);
+            break;
+        default:
+            if (!hook.write_block(data, os))
+                throw general_error("mdds::mtv::serialize: unsupported element block type.");
+    }
+}
+
+template<typename _Blk, typename _Builder>
+void append_raw_values(_Builder& builder, const char* payload, size_t size)
+{
+    typedef typename _Blk::value_type value_type;
+
+    if (reinterpret_cast<uintptr_t>(payload) % alignof(value_type))
+    {
+        // Misaligned payload.  Copy it to aligned storage first.
+        std::unique_ptr<value_type[]> buf(new value_type[size]);
+        std::memcpy(buf.get(), payload, size * sizeof(value_type));
+        builder.append(buf.get(), buf.get() + size);
+        return;
+    }
+
+    const value_type* p = reinterpret_cast<const value_type*>(payload);
+    builder.append(p, p + size);
+}
+
+template<typename _Builder>
+void append_boolean_values(_Builder& builder, const char* payload, size_t size)
+{
+    std::unique_ptr<bool[]> buf(new bool[size]);
+    for (size_t i = 0; i < size; ++i)
+        buf[i] = payload[i] != 0;
+
+    builder.append(buf.get(), buf.get() + size);
+}
+
+template<typename _Builder>
+void append_string_values(_Builder& builder, const char* payload, size_t payload_size, size_t size)
+{
+    // Each value takes at least the bytes of its length.
+    if (size > payload_size / sizeof(uint64_t))
+        throw general_error("mdds::mtv::deserialize: truncated string block.");
+
+    std::vector<std::string> vals;
+    vals.reserve(size);
+    const char* p = payload;
+    const char* p_end = payload + payload_size;
+    for (size_t i = 0; i < size; ++i)
+    {
+        if (size_t(p_end - p) < sizeof(uint64_t))
+            throw general_error("mdds::mtv::deserialize: truncated string block.");
+
+        uint64_t len = read_raw<uint64_t>(p);
+        p += sizeof(uint64_t);
+        if (size_t(p_end - p) < len)
+            throw general_error("mdds::mtv::deserialize: truncated string block.");
+
+        vals.emplace_back(p, len);
+        p += len;
+    }
+
+    builder.append(std::make_move_iterator(vals.begin()), std::make_move_iterator(vals.end()));
+}
+
+/**
+ * Append the values of one serialized block to a container being loaded.
+ */
+template<typename _Builder, typename _Hook>
+void append_block(
+    _Builder& builder, element_t type, size_t size, const char* payload, size_t payload_size,
+    const _Hook& hook)
+{
+    switch (type)
+    {
+        case element_type_empty:
+            builder.append_empty(size);
+            break;
+        case element_type_numeric:
+            append_raw_values<numeric_element_block>(builder, payload, size);
+            break;
+        case element_type_short:
+            append_raw_values<short_element_block>(builder, payload, size);
+            break;
+        case element_type_ushort:
+            append_raw_values<ushort_element_block>(builder, payload, size);
+            break;
+        case element_type_int:
+            append_raw_values<int_element_block>(builder, payload, size);
+            break;
+        case element_type_uint:
+            append_raw_values<uint_element_block>(builder, payload, size);
+            break;
+        case element_type_long:
+            append_raw_values<long_element_block>(builder, payload, size);
+            break;
+        case element_type_ulong:
+            append_raw_values<ulong_element_block>(builder, payload, size);
+            break;
+        case element_type_char:
+            append_raw_values<char_element_block>(builder, payload, size);
+            break;
+        case element_type_uchar:
+            append_raw_values<uchar_element_block>(builder, payload, size);
+            break;
+        case element_type_boolean:
+            append_boolean_values(builder, payload, size);
+            break;
+        case element_type_string:
+            append_string_values(builder, payload, payload_size, size);
+            break;
+        default:
+            if (!hook.read_block(type, size, payload, payload_size, builder))
+                throw general_error("mdds::mtv::deserialize: unsupported element block type.");
+    }
+}
+
+struct serialized_block_header
+{
+    element_t type;
+    uint32_t width;
+    uint64_t size;
+    uint64_t payload_size;
+};
+
+/**
+ * Parse and validate a block header.  Since the data may be corrupt, the
+ * sizes stored in the header must not be trusted until they are checked
+ * against the number of elements not yet accounted for by the preceding
+ * blocks.
+ *
+ * @param p pointer to the block header.
+ * @param remaining number of elements not yet accounted for.
+ */
+inline serialized_block_header parse_block_header(const char* p, uint64_t remaining)
+{
+    serialized_block_header hdr;
+    hdr.type = read_raw<int32_t>(p);
+    hdr.width = read_raw<uint32_t>(p+4);
+    hdr.size = read_raw<uint64_t>(p+8);
+    hdr.payload_size = read_raw<uint64_t>(p+16);
+
+    uint32_t expected_width = raw_value_width(hdr.type);
+    if (hdr.width != expected_width)
+        throw general_error("mdds::mtv::deserialize: element size does not match that of this platform.");
+
+    if (hdr.size > remaining)
+        throw general_error("mdds::mtv::deserialize: number of elements does not match.");
+
+    // Leave room for the padding, and make sure the sizes fit in size_t.
+    const uint64_t max_size = std::numeric_limits<size_t>::max() - 8;
+    if (hdr.size > max_size || hdr.payload_size > max_size)
+        throw general_error("mdds::mtv::deserialize: block is too large.");
+
+    if (hdr.width &&
+        (hdr.size > std::numeric_limits<uint64_t>::max() / hdr.width || hdr.payload_size != hdr.size * hdr.width))
+        throw general_error("mdds::mtv::deserialize: payload size does not match the number of elements.");
+
+    if (hdr.type == element_type_empty && hdr.payload_size)
+        throw general_error("mdds::mtv::deserialize: empty block with a payload.");
+
+    return hdr;
+}
+
+/**
+ * Parse the header of serialized data.
+ *
+ * @return pair of the number of elements and the number of blocks.
+ */
+inline std::pair<uint64_t, uint64_t> parse_header(const char* p)
+{
+    if (std::memcmp(p, serialize_magic, sizeof(serialize_magic)))
+        throw general_error("mdds::mtv::deserialize: not a serialized multi_type_vector.");
+
+    if (read_raw<uint32_t>(p+12) != serialize_byte_order)
+        throw general_error("mdds::mtv::deserialize: byte order does not match that of this platform.");
+
+    if (read_raw<uint32_t>(p+8) != serialize_version)
+        throw general_error("mdds::mtv::deserialize: unsupported format version.");
+
+    return std::pair<uint64_t, uint64_t>(read_raw<uint64_t>(p+16), read_raw<uint64_t>(p+24));
+}
+
+/**
+ * Replace the content of a container with the content appended to it by
+ * the specified function.  If the function throws, the container gets
+ * its previous content back.  The previous blocks are set aside by
+ * swapping rather than copied, and they get released via the container
+ * itself once the new content is complete, so that its event handler
+ * gets notified of the release of the previous blocks and the
+ * acquisition of the new ones, as with clear() followed by a reload.
+ */
+template<typename _MtvT, typename _Func>
+void replace_content(_MtvT& db, _Func func)
+{
+    _MtvT prev;
+    db.swap(prev);
+
+    try
+    {
+        func();
+    }
+    catch (...)
+    {
+        db.clear();
+        db.swap(prev);
+        throw;
+    }
+
+    db.swap(prev);
+    db.clear();
+    db.swap(prev);
+}
+
+}
+
+/**
+ * Write the content of a multi_type_vector to a stream in a versioned
+ * binary format.  Blocks of the standard types get written by this
+ * function, and those of user-defined types by the serializer.
+ *
+ * <p>The function will throw an <code>mdds::general_error</code>
+ * exception if the serializer does not support the type of a block.</p>
+ *
+ * @param db container to write.
+ * @param os stream to write to.  It should be opened in binary mode.
+ * @param hook serializer of the blocks of user-defined types.
+ */
+template<typename _MtvT, typename _Hook = standard_block_serializer>
+void serialize(const _MtvT& db, std::ostream& os, const _Hook& hook = _Hook())
+{
+    os.write(detail::serialize_magic, sizeof(detail::serialize_magic));
+    detail::write_raw(os, detail::serialize_version);
+    detail::write_raw(os, detail::serialize_byte_order);
+    detail::write_raw(os, static_cast<uint64_t>(db.size()));
+    detail::write_raw(os, static_cast<uint64_t>(db.block_size()));
+
+    const char padding[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+    std::ostringstream custom_os;
+
+    typename _MtvT::const_iterator it = db.begin(), it_end = db.end();
+    for (; it != it_end; ++it)
+    {
+        element_t type = it->data ? it->type : element_type_empty;
+        uint32_t width = detail::raw_value_width(type);
+        uint64_t payload_size = width * static_cast<uint64_t>(it->size);
+
+        if (it->data && !width)
+        {
+            // The payload size is not known in advance.  Write it to a
+            // buffer first.
+            custom_os.str(std::string());
+            detail::write_block_payload(custom_os, type, *it->data, it->size, hook);
+            std::string buf = custom_os.str();
+
+            detail::write_raw(os, static_cast<int32_t>(type));
+            detail::write_raw(os, width);
+            detail::write_raw(os, static_cast<uint64_t>(it->size));
+            detail::write_raw(os, static_cast<uint64_t>(buf.size()));
+            os.write(buf.data(), buf.size());
+            os.write(padding, detail::serialize_padding(buf.size()));
+            continue;
+        }
+
+        detail::write_raw(os, static_cast<int32_t>(type));
+        detail::write_raw(os, width);
+        detail::write_raw(os, static_cast<uint64_t>(it->size));
+        detail::write_raw(os, payload_size);
+        if (it->data)
+            detail::write_block_payload(os, type, *it->data, it->size, hook);
+        os.write(padding, detail::serialize_padding(payload_size));
+    }
+}
+
+/**
+ * Read-only view of multi_type_vector content serialized by serialize(),
+ * which reads it directly from memory, such as a memory-mapped file.  The
+ * block headers get validated and indexed on construction, but no
+ * element values get copied; the values of the blocks stored as raw
+ * arrays can be accessed in place via get_span().
+ *
+ * The view does not own the memory, which must outlive the view and all
+ * spans obtained from it.
+ */
+class serialized_view
+{
+public:
+    /** Block of serialized content. */
+    struct block
+    {
+        /** type of the block. */
+        element_t type;
+
+        /** logical position of the first element of the block. */
+        size_t position;
+
+        /** number of elements in the block. */
+        size_t size;
+
+        /** pointer to the payload of the block. */
+        const char* payload;
+
+        /** size of the payload of the block in bytes. */
+        size_t payload_size;
+    };
+
+private:
+    std::vector<block> m_blocks;
+    size_t m_size;
+
+public:
+    /**
+     * Constructor.
+     *
+     * <p>It will throw an <code>mdds::general_error</code> exception if the
+     * data is not valid serialized content, or was written on a platform
+     * with a different byte order or different sizes of element types.</p>
+     *
+     * @param data pointer to the start of the serialized content.  It must
+     *             be aligned to 8 bytes for get_span() to work.
+     * @param size size of the serialized content in bytes.
+     */
+    serialized_view(const void* data, size_t size) : m_size(0)
+    {
+        const char* p = static_cast<const char*>(data);
+        const char* p_end = p + size;
+        if (size < detail::serialize_header_size)
+            throw general_error("mdds::mtv::serialized_view: data is too short.");
+
+        std::pair<uint64_t, uint64_t> counts = detail::parse_header(p);
+        p += detail::serialize_header_size;
+
+        if (counts.second > size / detail::serialize_block_header_size)
+            throw general_error("mdds::mtv::serialized_view: data is too short.");
+
+        m_blocks.reserve(counts.second);
+        for (uint64_t i = 0; i < counts.second; ++i)
+        {
+            if (size_t(p_end - p) < detail::serialize_block_header_size)
+                throw general_error("mdds::mtv::serialized_view: data is too short.");
+
+            detail::serialized_block_header hdr = detail::parse_block_header(p, counts.first - m_size);
+            p += detail::serialize_block_header_size;
+
+            if (size_t(p_end - p) < hdr.payload_size)
+                throw general_error("mdds::mtv::serialized_view: data is too short.");
+
+            block blk;
+            blk.type = hdr.type;
+            blk.position = m_size;
+            blk.size = hdr.size;
+            blk.payload = p;
+            blk.payload_size = hdr.payload_size;
+            m_blocks.push_back(blk);
+
+            m_size += hdr.size;
+            p += hdr.payload_size;
+            p += std::min<size_t>(detail::serialize_padding(hdr.payload_size), p_end - p);
+        }
+
+        if (m_size != counts.first)
+            throw general_error("mdds::mtv::serialized_view: number of elements does not match.");
+    }
+
+    /**
+     * @return total number of elements.
+     */
+    size_t size() const { return m_size; }
+
+    /**
+     * @return number of blocks.
+     */
+    size_t block_size() const { return m_blocks.size(); }
+
+    /**
+     * Get a block by its index.
+     *
+     * @param block_index index of the block.
+     *
+     * @return block at the specified index.
+     */
+    const block& get_block(size_t block_index) const
+    {
+        return m_blocks.at(block_index);
+    }
+
+    /**
+     * Get a read-only view of the values of a block stored as a raw array,
+     * directly from the serialized content.  The caller must specify the
+     * type of the element block as the template parameter.
+     *
+     * <p>The method will throw an <code>mdds::mtv::element_block_error</code>
+     * exception if the block is of a different type or is not stored as a
+     * raw array, and an <code>mdds::general_error</code> exception if the
+     * payload is not suitably aligned.</p>
+     *
+     * @param block_index index of the block.
+     *
+     * @return span referencing all values of the block.
+     */
+    template<typename _Blk>
+    element_span<const typename _Blk::value_type> get_span(size_t block_index) const
+    {
+        typedef typename _Blk::value_type value_type;
+        static_assert(std::is_trivially_copyable<value_type>::value,
+            "serialized_view::get_span: values are not stored as a raw array.");
+
+        const block& blk = get_block(block_index);
+        if (blk.type != _Blk::block_type || detail::raw_value_width(blk.type) != sizeof(value_type) ||
+            blk.type == element_type_boolean)
+            throw element_block_error("serialized_view::get_span: block is not of the requested type.");
+
+        if (reinterpret_cast<uintptr_t>(blk.payload) % alignof(value_type))
+            throw general_error("serialized_view::get_span: payload is not aligned.");
+
+        return element_span<const value_type>(
+            reinterpret_cast<const value_type*>(blk.payload), blk.size);
+    }
+};
+
+/**
+ * Load the content of a multi_type_vector from a view of serialized
+ * content, building each element block in a single pass.  The existing
+ * content of the container gets replaced.
+ *
+ * <p>The function will throw an <code>mdds::general_error</code> exception
+ * if the serializer does not support the type of a block, in which case
+ * the container keeps its existing content.</p>
+ *
+ * @param db container to load the content into.
+ * @param view view of the serialized content.
+ * @param hook serializer of the blocks of user-defined types.
+ */
+template<typename _MtvT, typename _Hook = standard_block_serializer>
+void deserialize(_MtvT& db, const serialized_view& view, const _Hook& hook = _Hook())
+{
+    detail::replace_content(db, [&]()
+    {
+        typename _MtvT::builder builder(db, view.block_size());
+        for (size_t i = 0, n = view.block_size(); i < n; ++i)
+        {
+            const serialized_view::block& blk = view.get_block(i);
+            detail::append_block(builder, blk.type, blk.size, blk.payload, blk.payload_size, hook);
+        }
+    });
+}
+
+/**
+ * Load the content of a multi_type_vector from a stream written by
+ * serialize(), building each element block in a single pass.  The
+ * existing content of the container gets replaced.
+ *
+ * <p>The function will throw an <code>mdds::general_error</code> exception
+ * if the stream does not contain valid serialized content, or if the
+ * serializer does not support the type of a block, in which case the
+ * container keeps its existing content.</p>
+ *
+ * @param db container to load the content into.
+ * @param is stream to read from.  It should be opened in binary mode.
+ * @param hook serializer of the blocks of user-defined types.
+ */
+template<typename _MtvT, typename _Hook = standard_block_serializer>
+void deserialize(_MtvT& db, std::istream& is, const _Hook& hook = _Hook())
+{
+    char header[detail::serialize_header_size];
+    if (!is.read(header, sizeof(header)))
+        throw general_error("mdds::mtv::deserialize: stream is too short.");
+
+    std::pair<uint64_t, uint64_t> counts = detail::parse_header(header);
+
+    detail::replace_content(db, [&]()
+    {
+        typename _MtvT::builder builder(db);
+
+        // Use 8-byte aligned storage for the payload.
+        std::vector<uint64_t> buf;
+        uint64_t total = 0;
+        for (uint64_t i = 0; i < counts.second; ++i)
+        {
+            char block_header[detail::serialize_block_header_size];
+            if (!is.read(block_header, sizeof(block_header)))
+                throw general_error("mdds::mtv::deserialize: stream is too short.");
+
+            detail::serialized_block_header hdr = detail::parse_block_header(block_header, counts.first - total);
+            size_t padded_size = hdr.payload_size + detail::serialize_padding(hdr.payload_size);
+
+            // Grow the buffer only as the payload actually arrives.
+            buf.clear();
+            for (size_t n_read = 0; n_read < padded_size; )
+            {
+                size_t n = std::min(padded_size - n_read, detail::serialize_read_chunk_size);
+                buf.resize((n_read + n) / sizeof(uint64_t));
+                if (!is.read(reinterpret_cast<char*>(buf.data()) + n_read, n))
+                    throw general_error("mdds::mtv::deserialize: stream is too short.");
+
+                n_read += n;
+            }
+
+            const char* payload = reinterpret_cast<const char*>(buf.data());
+            detail::append_block(builder, hdr.type, hdr.size, payload, hdr.payload_size, hook);
+            total += hdr.size;
+        }
+
+        if (total != counts.first)
+            throw general_error("mdds::mtv::deserialize: number of elements does not match.");
+    });
+}
+
+}}
+
+#endif
@@ -0,0 +1,440 @@
+/*************************************************************************
+ *
+ * Copyright (c) 2017 Kohei Yoshida
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ ************************************************************************/
+
+#ifndef INCLUDED_MDDS_MULTI_TYPE_VECTOR_SMALL_VECTOR_HPP
+#define INCLUDED_MDDS_MULTI_TYPE_VECTOR_SMALL_VECTOR_HPP
+
+#include "memory_resource.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace mdds { namespace mtv { namespace detail {
+
+/**
+ * Number of elements a small_vector stores without a separate heap
+ * allocation, by default.  The inline buffer is sized to hold about 32
+ * bytes worth of elements, but always at least one element.
+ */
+template<typename _T>
+struct small_vector_inline_capacity
+{
+    static const size_t value = sizeof(_T) < 32 ? 32 / sizeof(_T) : 1;
+};
+
+/**
+ * Contiguous array container with an interface similar to that of
+ * std::vector, which stores up to _N elements in a buffer embedded in the
+ * container itself, and only allocates its storage from the heap once it
+ * grows larger than that.
+ *
+ * Element blocks use this as their storage, so that a block that holds
+ * only a handful of elements, which is typical when the element type
+ * changes at nearly every position, requires only one heap allocation
+ * for the block itself.  Heap storage is allocated from the memory
+ * resource installed for the current thread, if any, and that memory
+ * resource is stored in the unused inline buffer.
+ */
+template<typename _T, size_t _N = small_vector_inline_capacity<_T>::value>
+class small_vector
+{
+public:
+    typedef _T value_type;
+    typedef size_t size_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef _T& reference;
+    typedef const _T& const_reference;
+    typedef _T* pointer;
+    typedef const _T* const_pointer;
+    typedef _T* iterator;
+    typedef const _T* const_iterator;
+    typedef std::reverse_iterator<iterator> reverse_iterator;
+    typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+
+private:
+    pointer m_data;
+    size_type m_size;
+    size_type m_capacity;
+
+    /**
+     * Inline buffer for up to _N elements.  While the elements are stored
+     * in a heap allocation instead, it stores the memory resource that
+     * allocation came from.
+     */
+    typename std::aligned_storage<
+        (sizeof(_T)*_N > sizeof(memory_resource*) ? sizeof(_T)*_N : sizeof(memory_resource*)),
+        (alignof(_T) > alignof(memory_resource*) ? alignof(_T) : alignof(memory_resource*))>::type m_buffer;
+
+    pointer local_buffer()
+    {
+        return reinterpret_cast<pointer>(&m_buffer);
+    }
+
+    const_pointer local_buffer() const
+    {
+        return reinterpret_cast<const_pointer>(&m_buffer);
+    }
+
+    bool is_local() const
+    {
+        return m_data == local_buffer();
+    }
+
+    memory_resource*& heap_resource()
+    {
+        return *reinterpret_cast<memory_resource**>(&m_buffer);
+    }
+
+    static pointer allocate(memory_resource* res, size_type n)
+    {
+        return static_cast<pointer>(detail::allocate(res, n*sizeof(_T), alignof(_T)));
+    }
+
+    static void deallocate(memory_resource* res, pointer p, size_type n)
+    {
+        detail::deallocate(res, p, n*sizeof(_T), alignof(_T));
+    }
+
+    void deallocate()
+    {
+        if (!is_local())
+            deallocate(heap_resource(), m_data, m_capacity);
+    }
+
+    void destroy(pointer it, pointer it_end)
+    {
+        for (; it != it_end; ++it)
+            it->~_T();
+    }
+
+    /**
+     * Move all stored elements into a new storage of the specified
+     * capacity.  If the capacity is not larger than the inline capacity,
+     * the elements move back into the inline buffer.
+     */
+    void reallocate(size_type new_capacity)
+    {
+        bool to_heap = new_capacity > _N;
+        if (!to_heap && is_local())
+            return;
+
+        // Moving the elements back into the inline buffer overwrites the
+        // memory resource stored there.
+        memory_resource* old_res = is_local() ? nullptr : heap_resource();
+        memory_resource* res = detail::current_memory_resource();
+        pointer p = to_heap ? allocate(res, new_capacity) : local_buffer();
+
+        try
+        {
+            std::uninitialized_copy(
+                std::make_move_iterator(m_data), std::make_move_iterator(m_data+m_size), p);
+        }
+        catch (...)
+        {
+            if (to_heap)
+                deallocate(res, p, new_capacity);
+            else
+                heap_resource() = old_res;
+            throw;
+        }
+
+        destroy(m_data, m_data+m_size);
+        if (!is_local())
+            deallocate(old_res, m_data, m_capacity);
+
+        m_data = p;
+        m_capacity = to_heap ? new_capacity : _N;
+        if (to_heap)
+            heap_resource() = res;
+    }
+
+    void grow(size_type n)
+    {
+        if (n > m_capacity)
+            reallocate(std::max(n, m_capacity*2));
+    }
+
+    void steal(small_vector& r)
+    {
+        if (r.is_local())
+        {
+            std::uninitialized_copy(
+                std::make_move_iterator(r.m_data), std::make_move_iterator(r.m_data+r.m_size), m_data);
+            m_size = r.m_size;
+            r.clear();
+            return;
+        }
+
+        m_data = r.m_data;
+        m_size = r.m_size;
+        m_capacity = r.m_capacity;
+        heap_resource() = r.heap_resource();
+        r.m_data = r.local_buffer();
+        r.m_size = 0;
+        r.m_capacity = _N;
+    }
+
+public:
+    small_vector() : m_data(local_buffer()), m_size(0), m_capacity(_N) {}
+
+    explicit small_vector(size_type n) : small_vector()
+    {
+        resize(n);
+    }
+
+    small_vector(size_type n, const _T& val) : small_vector()
+    {
+        reserve(n);
+        for (; m_size < n; ++m_size)
+            new (m_data+m_size) _T(val);
+    }
+
+    template<typename _Iter, typename = typename std::enable_if<!std::is_integral<_Iter>::value>::type>
+    small_vector(_Iter it_begin, _Iter it_end) : small_vector()
+    {
+        assign(it_begin, it_end);
+    }
+
+    small_vector(const small_vector& r) : small_vector()
+    {
+        assign(r.begin(), r.end());
+    }
+
+    small_vector(small_vector&& r) : small_vector()
+    {
+        steal(r);
+    }
+
+    ~small_vector()
+    {
+        clear();
+        deallocate();
+    }
+
+    small_vector& operator= (const small_vector& r)
+    {
+        if (this != &r)
+            assign(r.begin(), r.end());
+        return *this;
+    }
+
+    small_vector& operator= (small_vector&& r)
+    {
+        if (this != &r)
+        {
+            clear();
+            deallocate();
+            m_data = local_buffer();
+            m_capacity = _N;
+            steal(r);
+        }
+        return *this;
+    }
+
+    bool operator== (const small_vector& r) const
+    {
+        return m_size == r.m_size && std::equal(begin(), end(), r.begin());
+    }
+
+    bool operator!= (const small_vector& r) const
+    {
+        return !operator==(r);
+    }
+
+    iterator begin() { return m_data; }
+    iterator end() { return m_data + m_size; }
+    const_iterator begin() const { return m_data; }
+    const_iterator end() const { return m_data + m_size; }
+
+    reverse_iterator rbegin() { return reverse_iterator(end()); }
+    reverse_iterator rend() { return reverse_iterator(begin()); }
+    const_reverse_iterator rbegin() const { return const_reverse_iterator(end()); }
+    const_reverse_iterator rend() const { return const_reverse_iterator(begin()); }
+
+    size_type size() const { return m_size; }
+    size_type capacity() const { return m_capacity; }
+    bool empty() const { return m_size == 0; }
+
+    pointer data() { return m_data; }
+    const_pointer data() const { return m_data; }
+
+    reference operator[] (size_type pos) { return m_data[pos]; }
+    const_reference operator[] (size_type pos) const { return m_data[pos]; }
+
+    reference at(size_type pos)
+    {
+        if (pos >= m_size)
+            throw std::out_of_range("small_vector::at: position is out of range.");
+        return m_data[pos];
+    }
+
+    const_reference at(size_type pos) const
+    {
+        if (pos >= m_size)
+            throw std::out_of_range("small_vector::at: position is out of range.");
+        return m_data[pos];
+    }
+
+    reference front() { return m_data[0]; }
+    const_reference front() const { return m_data[0]; }
+    reference back() { return m_data[m_size-1]; }
+    const_reference back() const { return m_data[m_size-1]; }
+
+    void reserve(size_type n)
+    {
+        if (n > m_capacity)
+            reallocate(n);
+    }
+
+    void shrink_to_fit()
+    {
+        if (m_size < m_capacity && !is_local())
+            reallocate(m_size);
+    }
+
+    void clear()
+    {
+        destroy(m_data, m_data+m_size);
+        m_size = 0;
+    }
+
+    void resize(size_type n)
+    {
+        if (n < m_size)
+        {
+            destroy(m_data+n, m_data+m_size);
+            m_size = n;
+            return;
+        }
+
+        grow(n);
+        for (; m_size < n; ++m_size)
+            new (m_data+m_size) _T();
+    }
+
+    void push_back(const _T& val)
+    {
+        if (m_size < m_capacity)
+        {
+            new (m_data+m_size) _T(val);
+            ++m_size;
+            return;
+        }
+
+        // The value may refer to an element of this container, which
+        // growing the storage would invalidate.
+        _T tmp(val);
+        grow(m_size+1);
+        new (m_data+m_size) _T(std::move(tmp));
+        ++m_size;
+    }
+
+    void push_back(_T&& val)
+    {
+        grow(m_size+1);
+        new (m_data+m_size) _T(std::move(val));
+        ++m_size;
+    }
+
+    void pop_back()
+    {
+        --m_size;
+        m_data[m_size].~_T();
+    }
+
+    iterator insert(const_iterator pos, const _T& val)
+    {
+        size_type offset = pos - begin();
+        push_back(val);
+        std::rotate(begin()+offset, end()-1, end());
+        return begin() + offset;
+    }
+
+    iterator insert(const_iterator pos, _T&& val)
+    {
+        size_type offset = pos - begin();
+        push_back(std::move(val));
+        std::rotate(begin()+offset, end()-1, end());
+        return begin() + offset;
+    }
+
+    template<typename _Iter, typename = typename std::enable_if<!std::is_integral<_Iter>::value>::type>
+    iterator insert(const_iterator pos, _Iter it_begin, _Iter it_end)
+    {
+        size_type offset = pos - begin();
+        size_type old_size = m_size;
+        grow(m_size + std::distance(it_begin, it_end));
+
+        // Construct the new elements at the end, then rotate them into
+        // place.
+        for (; it_begin != it_end; ++it_begin, ++m_size)
+            new (m_data+m_size) _T(*it_begin);
+
+        std::rotate(begin()+offset, begin()+old_size, end());
+        return begin() + offset;
+    }
+
+    iterator erase(const_iterator pos)
+    {
+        return erase(pos, pos+1);
+    }
+
+    iterator erase(const_iterator it_begin, const_iterator it_end)
+    {
+        iterator it = begin() + (it_begin - begin());
+        iterator it_new_end = std::move(it + (it_end - it_begin), end(), it);
+        destroy(it_new_end, end());
+        m_size = it_new_end - begin();
+        return it;
+    }
+
+    template<typename _Iter, typename = typename std::enable_if<!std::is_integral<_Iter>::value>::type>
+    void assign(_Iter it_begin, _Iter it_end)
+    {
+        clear();
+        reserve(std::distance(it_begin, it_end));
+        for (; it_begin != it_end; ++it_begin, ++m_size)
+            new (m_data+m_size) _T(*it_begin);
+    }
+
+    void swap(small_vector& r)
+    {
+        small_vector tmp(std::move(r));
+        r = std::move(*this);
+        *this = std::move(tmp);
+    }
+};
+
+}}}
+
+#endif
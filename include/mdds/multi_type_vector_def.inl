@@ -102,24 +102,11 @@ MDDS_MTV_DEFINE_ELEMENT_CALLBACKS(char, mtv::element_type_char, 0, mtv::char_ele
 MDDS_MTV_DEFINE_ELEMENT_CALLBACKS(unsigned char, mtv::element_type_uchar, 0, mtv::uchar_element_block)
 
 template<typename _CellBlockFunc, typename _EventFunc>
-multi_type_vector<_CellBlockFunc, _EventFunc>::block::block() : m_size(0), mp_data(nullptr) {}
+multi_type_vector<_CellBlockFunc, _EventFunc>::block::block() : m_position(0), m_size(0), mp_data(nullptr) {}
 
 template<typename _CellBlockFunc, typename _EventFunc>
-multi_type_vector<_CellBlockFunc, _EventFunc>::block::block(size_type _size) : m_size(_size), mp_data(nullptr) {}
-
-template<typename _CellBlockFunc, typename _EventFunc>
-multi_type_vector<_CellBlockFunc, _EventFunc>::block::block(const block& other) :
-    m_size(other.m_size), mp_data(nullptr)
-{
-    if (other.mp_data)
-        mp_data = element_block_func::clone_block(*other.mp_data);
-}
-
-template<typename _CellBlockFunc, typename _EventFunc>
-multi_type_vector<_CellBlockFunc, _EventFunc>::block::~block()
-{
-    element_block_func::delete_block(mp_data);
-}
+multi_type_vector<_CellBlockFunc, _EventFunc>::block::block(size_type _size) :
+    m_position(0), m_size(_size), mp_data(nullptr) {}
 
 template<typename _CellBlockFunc, typename _EventFunc>
 multi_type_vector<_CellBlockFunc, _EventFunc>::blocks_to_transfer::blocks_to_transfer() : insert_index(0) {}
@@ -269,44 +256,46 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::event_handler() const
 }
 
 template<typename _CellBlockFunc, typename _EventFunc>
-multi_type_vector<_CellBlockFunc, _EventFunc>::multi_type_vector() : m_cur_size(0) {}
+multi_type_vector<_CellBlockFunc, _EventFunc>::multi_type_vector() :
+    m_cur_size(0), m_shift(0), m_shift_index(0), m_maybe_shared(false), m_edit_sessions(0) {}
 
 template<typename _CellBlockFunc, typename _EventFunc>
 multi_type_vector<_CellBlockFunc, _EventFunc>::multi_type_vector(const event_func& hdl) :
-    m_hdl_event(hdl), m_cur_size(0) {}
+    m_hdl_event(hdl), m_cur_size(0), m_shift(0), m_shift_index(0), m_maybe_shared(false), m_edit_sessions(0) {}
 
 template<typename _CellBlockFunc, typename _EventFunc>
 multi_type_vector<_CellBlockFunc, _EventFunc>::multi_type_vector(event_func&& hdl) :
-    m_hdl_event(std::move(hdl)), m_cur_size(0) {}
+    m_hdl_event(std::move(hdl)), m_cur_size(0), m_shift(0), m_shift_index(0), m_maybe_shared(false), m_edit_sessions(0) {}
 
 template<typename _CellBlockFunc, typename _EventFunc>
-multi_type_vector<_CellBlockFunc, _EventFunc>::multi_type_vector(size_type init_size) : m_cur_size(init_size)
+multi_type_vector<_CellBlockFunc, _EventFunc>::multi_type_vector(size_type init_size) :
+    m_cur_size(init_size), m_shift(0), m_shift_index(0), m_maybe_shared(false), m_edit_sessions(0)
 {
     if (!init_size)
         return;
 
     // Initialize with an empty block that spans from 0 to max.
-    m_blocks.push_back(new block(init_size));
+    m_blocks.emplace_back(init_size);
 }
 
 template<typename _CellBlockFunc, typename _EventFunc>
 template<typename _T>
 multi_type_vector<_CellBlockFunc, _EventFunc>::multi_type_vector(size_type init_size, const _T& value) :
-    m_cur_size(init_size)
+    m_cur_size(init_size), m_shift(0), m_shift_index(0), m_maybe_shared(false), m_edit_sessions(0)
 {
     if (!init_size)
         return;
 
-    std::unique_ptr<block> blk = make_unique<block>(init_size);
-    blk->mp_data = mdds_mtv_create_new_block(init_size, value);
-    m_hdl_event.element_block_acquired(blk->mp_data);
-    m_blocks.push_back(blk.release());
+    m_blocks.emplace_back(init_size);
+    block& blk = m_blocks.back();
+    blk.mp_data = mdds_mtv_create_new_block(init_size, value);
+    m_hdl_event.element_block_acquired(blk.mp_data);
 }
 
 template<typename _CellBlockFunc, typename _EventFunc>
 template<typename _T>
 multi_type_vector<_CellBlockFunc, _EventFunc>::multi_type_vector(size_type init_size, const _T& it_begin, const _T& it_end) :
-    m_cur_size(init_size)
+    m_cur_size(init_size), m_shift(0), m_shift_index(0), m_maybe_shared(false), m_edit_sessions(0)
 {
     if (!m_cur_size)
         return;
@@ -315,32 +304,55 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::multi_type_vector(size_type init_
     if (m_cur_size != data_len)
         throw invalid_arg_error("Specified size does not match the size of the initial data array.");
 
-    std::unique_ptr<block> blk = make_unique<block>(m_cur_size);
-    blk->mp_data = mdds_mtv_create_new_block(*it_begin, it_begin, it_end);
-    m_hdl_event.element_block_acquired(blk->mp_data);
-    m_blocks.push_back(blk.release());
+    m_blocks.emplace_back(m_cur_size);
+    block& blk = m_blocks.back();
+    blk.mp_data = mdds_mtv_create_new_block(*it_begin, it_begin, it_end);
+    m_hdl_event.element_block_acquired(blk.mp_data);
 }
 
 template<typename _CellBlockFunc, typename _EventFunc>
 multi_type_vector<_CellBlockFunc, _EventFunc>::multi_type_vector(const multi_type_vector& other) :
-    m_cur_size(other.m_cur_size)
+    m_cur_size(other.m_cur_size), m_shift(other.m_shift), m_shift_index(other.m_shift_index),
+    m_block_cache(other.m_block_cache), m_maybe_shared(false), m_edit_sessions(0)
 {
     // Clone all the blocks.
     m_blocks.reserve(other.m_blocks.size());
     typename blocks_type::const_iterator it = other.m_blocks.begin(), it_end = other.m_blocks.end();
     for (; it != it_end; ++it)
     {
-        block* blk = new block(**it);
-        m_blocks.push_back(blk);
-        if (blk->mp_data)
-            m_hdl_event.element_block_acquired(blk->mp_data);
+        m_blocks.push_back(*it);
+        block& blk = m_blocks.back();
+        if (blk.mp_data)
+        {
+            blk.mp_data = element_block_func::clone_block(*blk.mp_data);
+            m_hdl_event.element_block_acquired(blk.mp_data);
+        }
     }
+
+    // The copy is not in the session the source may be in.
+    if (other.m_edit_sessions)
+        merge_all_blocks();
+}
+
+template<typename _CellBlockFunc, typename _EventFunc>
+multi_type_vector<_CellBlockFunc, _EventFunc>::multi_type_vector(multi_type_vector&& other) noexcept :
+    m_hdl_event(std::move(other.m_hdl_event)),
+    m_blocks(std::move(other.m_blocks)),
+    m_cur_size(other.m_cur_size),
+    m_shift(other.m_shift), m_shift_index(other.m_shift_index),
+    m_block_cache(other.m_block_cache),
+    m_maybe_shared(other.m_maybe_shared.load(std::memory_order_relaxed)), m_edit_sessions(0)
+{
+    other.m_blocks.clear();
+    other.m_cur_size = 0;
+    other.m_shift = 0;
+    other.m_maybe_shared.store(false, std::memory_order_relaxed);
 }
 
 template<typename _CellBlockFunc, typename _EventFunc>
 multi_type_vector<_CellBlockFunc, _EventFunc>::~multi_type_vector()
 {
-    delete_blocks(m_blocks.begin(), m_blocks.end());
+    delete_element_blocks(m_blocks.begin(), m_blocks.end());
 }
 
 template<typename _CellBlockFunc, typename _EventFunc>
@@ -353,24 +365,20 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::set(size_type pos, const _T& valu
     if (!get_block_position(pos, start_row, block_index))
         detail::throw_block_position_not_found("multi_type_vector::set", __LINE__, pos, block_size(), size());
 
-#ifdef MDDS_MULTI_TYPE_VECTOR_DEBUG
-    std::ostringstream os_prev_block;
-    dump_blocks(os_prev_block);
-#endif
-
-    iterator ret = set_impl(pos, start_row, block_index, value);
+    return set_single_impl(pos, start_row, block_index, value);
+}
 
-#ifdef MDDS_MULTI_TYPE_VECTOR_DEBUG
-    if (!check_block_integrity())
-    {
-        cerr << "block integrity check failed in set (" << pos << ")" << endl;
-        cerr << "previous block state:" << endl;
-        cerr << os_prev_block.str();
-        abort();
-    }
-#endif
+template<typename _CellBlockFunc, typename _EventFunc>
+template<typename _T, typename>
+typename multi_type_vector<_CellBlockFunc, _EventFunc>::iterator
+multi_type_vector<_CellBlockFunc, _EventFunc>::set(size_type pos, _T&& value)
+{
+    size_type start_row = 0;
+    size_type block_index = 0;
+    if (!get_block_position(pos, start_row, block_index))
+        detail::throw_block_position_not_found("multi_type_vector::set", __LINE__, pos, block_size(), size());
 
-    return ret;
+    return set_single_impl(pos, start_row, block_index, std::move(value));
 }
 
 template<typename _CellBlockFunc, typename _EventFunc>
@@ -381,13 +389,39 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::set(const iterator& pos_hint, siz
     size_type start_row = 0;
     size_type block_index = 0;
     get_block_position(pos_hint, pos, start_row, block_index);
+    return set_single_impl(pos, start_row, block_index, value);
+}
+
+template<typename _CellBlockFunc, typename _EventFunc>
+template<typename _T, typename>
+typename multi_type_vector<_CellBlockFunc, _EventFunc>::iterator
+multi_type_vector<_CellBlockFunc, _EventFunc>::set(const iterator& pos_hint, size_type pos, _T&& value)
+{
+    size_type start_row = 0;
+    size_type block_index = 0;
+    get_block_position(pos_hint, pos, start_row, block_index);
+    return set_single_impl(pos, start_row, block_index, std::move(value));
+}
+
+template<typename _CellBlockFunc, typename _EventFunc>
+template<typename _T>
+typename multi_type_vector<_CellBlockFunc, _EventFunc>::iterator
+multi_type_vector<_CellBlockFunc, _EventFunc>::set_single_impl(
+    size_type pos, size_type start_row, size_type block_index, _T&& value)
+{
+    unshare_blocks(pos, pos);
+    prepare_block_positions(block_index);
 
 #ifdef MDDS_MULTI_TYPE_VECTOR_DEBUG
     std::ostringstream os_prev_block;
     dump_blocks(os_prev_block);
 #endif
 
-    iterator ret = set_impl(pos, start_row, block_index, value);
+    element_category_type old_type = range_event_type(start_row, block_index, pos);
+    element_category_type cat = mdds_mtv_get_element_type(value);
+    iterator ret = set_impl(pos, start_row, block_index, std::forward<_T>(value));
+    update_block_positions(block_index, pos+1);
+    notify_range_changed(mtv::range_change_modified, pos, pos, old_type, cat);
 
 #ifdef MDDS_MULTI_TYPE_VECTOR_DEBUG
     if (!check_block_integrity())
@@ -409,26 +443,65 @@ void multi_type_vector<_CellBlockFunc, _EventFunc>::delete_element_block(block*
         // This block is empty.
         return;
 
-    m_hdl_event.element_block_released(p->mp_data);
-    element_block_func::delete_block(p->mp_data);
+    release_element_block(p->mp_data);
     p->mp_data = nullptr;
 }
 
 template<typename _CellBlockFunc, typename _EventFunc>
-void multi_type_vector<_CellBlockFunc, _EventFunc>::delete_block(block* p)
+void multi_type_vector<_CellBlockFunc, _EventFunc>::release_element_block(element_block_type* data)
 {
-    delete_element_block(p);
-    delete p;
+    m_hdl_event.element_block_released(data);
+    if (mtv::detail::release_block_ref(*data))
+        element_block_func::delete_block(data);
+}
+
+template<typename _CellBlockFunc, typename _EventFunc>
+void multi_type_vector<_CellBlockFunc, _EventFunc>::unshare_blocks(size_type start_pos, size_type end_pos)
+{
+    if (!m_maybe_shared.load(std::memory_order_relaxed) || start_pos > end_pos)
+        return;
+
+    size_type start_row = 0, block_index1 = 0;
+    if (!get_block_position(start_pos, start_row, block_index1))
+        // Let the caller handle the invalid position.
+        return;
+
+    size_type block_index2 = m_blocks.size() - 1;
+    if (end_pos < m_cur_size)
+    {
+        block_index2 = block_index1;
+        get_block_position(end_pos, start_row, block_index2);
+    }
+
+    if (block_index1 > 0)
+        --block_index1;
+    if (block_index2 < m_blocks.size() - 1)
+        ++block_index2;
+
+    for (size_type i = block_index1; i <= block_index2; ++i)
+        unshare_block(m_blocks[i]);
+}
+
+template<typename _CellBlockFunc, typename _EventFunc>
+void multi_type_vector<_CellBlockFunc, _EventFunc>::unshare_block(block& blk)
+{
+    if (!blk.mp_data || !mtv::detail::is_block_shared(*blk.mp_data))
+        return;
+
+    element_block_type* data = element_block_func::clone_block(*blk.mp_data);
+    release_element_block(blk.mp_data);
+    blk.mp_data = data;
+    m_hdl_event.element_block_acquired(data);
 }
 
 template<typename _CellBlockFunc, typename _EventFunc>
-void multi_type_vector<_CellBlockFunc, _EventFunc>::delete_blocks(
+void multi_type_vector<_CellBlockFunc, _EventFunc>::delete_element_blocks(
     typename blocks_type::iterator it, typename blocks_type::iterator it_end)
 {
     std::for_each(it, it_end,
-        [&](block* p)
+        [&](block& r)
         {
-            delete_block(p);
+            delete_element_block(&r);
         }
     );
 }
@@ -437,13 +510,13 @@ template<typename _CellBlockFunc, typename _EventFunc>
 template<typename _T>
 typename multi_type_vector<_CellBlockFunc, _EventFunc>::iterator
 multi_type_vector<_CellBlockFunc, _EventFunc>::set_impl(
-    size_type pos, size_type start_row, size_type block_index, const _T& value)
+    size_type pos, size_type start_row, size_type block_index, _T&& value)
 {
     element_category_type cat = mdds_mtv_get_element_type(value);
 
     typename blocks_type::iterator block_pos = m_blocks.begin();
     std::advance(block_pos, block_index);
-    block* blk = *block_pos;
+    block* blk = &*block_pos;
     assert(blk->m_size > 0); // block size should never be zero at any time.
 
     assert(pos >= start_row);
@@ -453,7 +526,7 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::set_impl(
     if (!blk->mp_data)
     {
         // This is an empty block.
-        return set_cell_to_empty_block(start_row, block_index, pos_in_block, value);
+        return set_cell_to_empty_block(start_row, block_index, pos_in_block, std::forward<_T>(value));
     }
 
     assert(blk->mp_data);
@@ -464,7 +537,7 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::set_impl(
         // This block is of the same type as the cell being inserted.
         size_type i = pos - start_row;
         element_block_func::overwrite_values(*blk->mp_data, i, 1);
-        mdds_mtv_set_value(*blk->mp_data, i, value);
+        mdds_mtv_set_value(*blk->mp_data, i, std::forward<_T>(value));
         return iterator(block_pos, m_blocks.end(), start_row, block_index);
     }
 
@@ -474,7 +547,7 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::set_impl(
     {
         // Insertion point is at the start of the block.
         if (blk->m_size == 1)
-            return set_cell_to_block_of_size_one(start_row, block_index, value);
+            return set_cell_to_block_of_size_one(start_row, block_index, std::forward<_T>(value));
 
         assert(blk->m_size > 1);
         block* blk_prev = get_previous_block_of_type(block_index, cat);
@@ -486,18 +559,18 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::set_impl(
             element_block_func::overwrite_values(*blk->mp_data, 0, 1);
             element_block_func::erase(*blk->mp_data, 0);
             blk_prev->m_size += 1;
-            mdds_mtv_append_value(*blk_prev->mp_data, value);
+            mdds_mtv_append_value(*blk_prev->mp_data, std::forward<_T>(value));
             return get_iterator(block_index-1, start_row-offset);
         }
 
-        set_cell_to_top_of_data_block(block_index, value);
+        set_cell_to_top_of_data_block(block_index, std::forward<_T>(value));
         return get_iterator(block_index, start_row);
     }
 
     if (pos < (start_row + blk->m_size - 1))
     {
         // Insertion point is somewhere in the middle of the block.
-        return set_cell_to_middle_of_block(start_row, block_index, pos_in_block, value);
+        return set_cell_to_middle_of_block(start_row, block_index, pos_in_block, std::forward<_T>(value));
     }
 
     // Insertion point is at the end of the block.
@@ -512,7 +585,7 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::set_impl(
             // This is the only block.  Pop the last value from the
             // previous block, and insert a new block for the cell being
             // inserted.
-            set_cell_to_bottom_of_data_block(0, value);
+            set_cell_to_bottom_of_data_block(0, std::forward<_T>(value));
             iterator itr = end();
             --itr;
             return itr;
@@ -523,7 +596,7 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::set_impl(
         {
             // Pop the last cell of the current block, and insert a new block
             // with the new cell.
-            set_cell_to_bottom_of_data_block(0, value);
+            set_cell_to_bottom_of_data_block(0, std::forward<_T>(value));
             iterator itr = begin();
             ++itr;
             return itr;
@@ -534,7 +607,7 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::set_impl(
         element_block_func::overwrite_values(*blk->mp_data, blk->m_size-1, 1);
         element_block_func::erase(*blk->mp_data, blk->m_size-1);
         blk->m_size -= 1;
-        mdds_mtv_prepend_value(*blk_next->mp_data, value);
+        mdds_mtv_prepend_value(*blk_next->mp_data, std::forward<_T>(value));
         blk_next->m_size += 1;
 
         return get_iterator(block_index+1, start_row+blk->m_size);
@@ -545,7 +618,7 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::set_impl(
     if (block_index == m_blocks.size()-1)
     {
         // This is the last block.
-        set_cell_to_bottom_of_data_block(block_index, value);
+        set_cell_to_bottom_of_data_block(block_index, std::forward<_T>(value));
         iterator itr = end();
         --itr;
         return itr;
@@ -555,8 +628,8 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::set_impl(
     if (!blk_next)
     {
         // Next block is either empty or of different type than that of the cell being inserted.
-        set_cell_to_bottom_of_data_block(block_index, value);
-        return get_iterator(block_index+1, start_row+blk->m_size);
+        set_cell_to_bottom_of_data_block(block_index, std::forward<_T>(value));
+        return get_iterator(block_index+1, start_row+m_blocks[block_index].m_size);
     }
 
     // Pop the last element from the current block, and prepend the cell
@@ -564,7 +637,7 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::set_impl(
     element_block_func::overwrite_values(*blk->mp_data, blk->m_size-1, 1);
     element_block_func::erase(*blk->mp_data, blk->m_size-1);
     blk->m_size -= 1;
-    mdds_mtv_prepend_value(*blk_next->mp_data, value);
+    mdds_mtv_prepend_value(*blk_next->mp_data, std::forward<_T>(value));
     blk_next->m_size += 1;
 
     return get_iterator(block_index+1, start_row+blk->m_size);
@@ -576,7 +649,7 @@ typename multi_type_vector<_CellBlockFunc, _EventFunc>::iterator
 multi_type_vector<_CellBlockFunc, _EventFunc>::release_impl(
     size_type pos, size_type start_pos, size_type block_index, _T& value)
 {
-    const block* blk = m_blocks[block_index];
+    const block* blk = &m_blocks[block_index];
     assert(blk);
 
     if (!blk->mp_data)
@@ -604,11 +677,19 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::set(size_type pos, const _T& it_b
     if (!set_cells_precheck(pos, it_begin, it_end, end_pos))
         return end();
 
+    unshare_blocks(pos, end_pos);
+
     size_type block_index1 = 0, start_row1 = 0;
     if (!get_block_position(pos, start_row1, block_index1))
         detail::throw_block_position_not_found("multi_type_vector::set", __LINE__, pos, block_size(), size());
 
-    return set_cells_impl(pos, end_pos, start_row1, block_index1, it_begin, it_end);
+    prepare_block_positions(block_index1);
+    element_category_type old_type = range_event_type(start_row1, block_index1, end_pos);
+    iterator ret = set_cells_impl(pos, end_pos, start_row1, block_index1, it_begin, it_end);
+    update_block_positions(block_index1, end_pos+1);
+    notify_range_changed(
+        mtv::range_change_modified, pos, end_pos, old_type, mdds_mtv_get_element_type(*it_begin));
+    return ret;
 }
 
 template<typename _CellBlockFunc, typename _EventFunc>
@@ -620,10 +701,167 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::set(const iterator& pos_hint, siz
     if (!set_cells_precheck(pos, it_begin, it_end, end_pos))
         return end();
 
+    unshare_blocks(pos, end_pos);
+
     size_type block_index1 = 0, start_row1 = 0;
     get_block_position(pos_hint, pos, start_row1, block_index1);
 
-    return set_cells_impl(pos, end_pos, start_row1, block_index1, it_begin, it_end);
+    prepare_block_positions(block_index1);
+    element_category_type old_type = range_event_type(start_row1, block_index1, end_pos);
+    iterator ret = set_cells_impl(pos, end_pos, start_row1, block_index1, it_begin, it_end);
+    update_block_positions(block_index1, end_pos+1);
+    notify_range_changed(
+        mtv::range_change_modified, pos, end_pos, old_type, mdds_mtv_get_element_type(*it_begin));
+    return ret;
+}
+
+template<typename _CellBlockFunc, typename _EventFunc>
+template<typename _T>
+typename multi_type_vector<_CellBlockFunc, _EventFunc>::iterator
+multi_type_vector<_CellBlockFunc, _EventFunc>::set_sorted(const _T& it_begin, const _T& it_end)
+{
+    if (it_begin == it_end)
+        return end();
+
+    // Validate all the positions before modifying anything.
+    size_type first_pos = it_begin->first, last_pos = first_pos;
+    size_type value_count = 1;
+    for (_T it = std::next(it_begin); it != it_end; ++it, ++value_count)
+    {
+        if (it->first <= last_pos)
+            throw std::invalid_argument("multi_type_vector::set_sorted: positions are not sorted in ascending order.");
+        last_pos = it->first;
+    }
+
+    if (last_pos >= m_cur_size)
+        detail::throw_block_position_not_found("multi_type_vector::set_sorted", __LINE__, last_pos, block_size(), size());
+
+    unshare_blocks(first_pos, last_pos);
+
+    size_type start_row1 = 0, block_index1 = 0;
+    get_block_position(first_pos, start_row1, block_index1);
+    size_type start_row2 = start_row1, block_index2 = block_index1;
+    get_block_position(last_pos, start_row2, block_index2);
+    element_category_type old_type = range_event_type(start_row1, block_index1, last_pos);
+
+    // Rebuild all the blocks from the first to the last affected one, plus
+    // their immediate neighbors so that new blocks at either end can get
+    // merged with them.
+    size_type bi_begin = block_index1 > 0 ? block_index1 - 1 : 0;
+    size_type bi_end = std::min<size_type>(block_index2 + 2, m_blocks.size());
+    prepare_block_positions(block_index1);
+    size_type start_pos = block_position(bi_begin);
+
+    element_category_type cat = mdds_mtv_get_element_type(it_begin->second);
+    blocks_type new_blocks;
+    new_blocks.reserve(bi_end - bi_begin + value_count * 2);
+
+    _T it = it_begin;
+    for (size_type i = bi_begin; i < bi_end; ++i)
+    {
+        block& blk = m_blocks[i];
+        size_type blk_pos = block_position(i);
+        size_type blk_end = blk_pos + blk.m_size;
+
+        if (it == it_end || it->first >= blk_end)
+        {
+            // No values to set in this block.
+            append_block_merged(new_blocks, blk);
+            continue;
+        }
+
+        if (blk.mp_data && mdds::mtv::get_block_type(*blk.mp_data) == cat)
+        {
+            // Same type as the new values.  Overwrite them in place.
+            for (; it != it_end && it->first < blk_end; ++it)
+            {
+                size_type offset = it->first - blk_pos;
+                element_block_func::overwrite_values(*blk.mp_data, offset, 1);
+                mdds_mtv_set_value(*blk.mp_data, offset, it->second);
+            }
+
+            append_block_merged(new_blocks, blk);
+            continue;
+        }
+
+        // Split this block into segments of existing values and runs of
+        // new values.
+        size_type offset = 0;
+        for (; it != it_end && it->first < blk_end; ++it)
+        {
+            size_type pos_in_block = it->first - blk_pos;
+            if (pos_in_block > offset)
+                append_segment_merged(new_blocks, blk.mp_data, offset, pos_in_block - offset);
+
+            if (blk.mp_data)
+                element_block_func::overwrite_values(*blk.mp_data, pos_in_block, 1);
+
+            append_value_merged(new_blocks, it->second);
+            offset = pos_in_block + 1;
+        }
+
+        if (offset < blk.m_size)
+            append_segment_merged(new_blocks, blk.mp_data, offset, blk.m_size - offset);
+
+        if (blk.mp_data)
+        {
+            // All the remaining values have been copied to the new blocks.
+            element_block_func::resize_block(*blk.mp_data, 0);
+            delete_element_block(&blk);
+        }
+    }
+
+    assert(it == it_end);
+
+    // Replace the old blocks with the new ones.
+    size_type old_count = bi_end - bi_begin;
+    typename blocks_type::iterator it_blk = m_blocks.begin() + bi_begin;
+    if (new_blocks.size() >= old_count)
+    {
+        std::copy(new_blocks.begin(), new_blocks.begin() + old_count, it_blk);
+        m_blocks.insert(it_blk + old_count, new_blocks.begin() + old_count, new_blocks.end());
+    }
+    else
+    {
+        std::copy(new_blocks.begin(), new_blocks.end(), it_blk);
+        m_blocks.erase(it_blk + new_blocks.size(), it_blk + old_count);
+    }
+
+    size_type ret_index = bi_begin, ret_pos = start_pos;
+    for (size_type i = bi_begin, n = bi_begin + new_blocks.size(); i < n; ++i)
+    {
+        block& blk = m_blocks[i];
+        blk.m_position = start_pos;
+        if (start_pos <= last_pos)
+        {
+            ret_index = i;
+            ret_pos = start_pos;
+        }
+        start_pos += blk.m_size;
+    }
+
+    if (m_shift)
+    {
+        // The new blocks store their actual positions, while the blocks
+        // that follow still carry the pending shift.
+        m_shift_index = bi_begin + new_blocks.size();
+        move_position_shift(bi_begin);
+    }
+
+    // The range spans the elements between the new values too.
+    notify_range_changed(
+        mtv::range_change_modified, first_pos, last_pos, old_type,
+        value_count == last_pos - first_pos + 1 ? cat : range_event_type(first_pos, last_pos));
+
+#ifdef MDDS_MULTI_TYPE_VECTOR_DEBUG
+    if (!check_block_integrity())
+    {
+        cerr << "block integrity check failed in set_sorted" << endl;
+        abort();
+    }
+#endif
+
+    return get_iterator(ret_index, ret_pos);
 }
 
 template<typename _CellBlockFunc, typename _EventFunc>
@@ -631,9 +869,28 @@ template<typename _T>
 typename multi_type_vector<_CellBlockFunc, _EventFunc>::iterator
 multi_type_vector<_CellBlockFunc, _EventFunc>::push_back(const _T& value)
 {
+    return push_back_impl(value);
+}
+
+template<typename _CellBlockFunc, typename _EventFunc>
+template<typename _T, typename>
+typename multi_type_vector<_CellBlockFunc, _EventFunc>::iterator
+multi_type_vector<_CellBlockFunc, _EventFunc>::push_back(_T&& value)
+{
+    return push_back_impl(std::move(value));
+}
+
+template<typename _CellBlockFunc, typename _EventFunc>
+template<typename _T>
+typename multi_type_vector<_CellBlockFunc, _EventFunc>::iterator
+multi_type_vector<_CellBlockFunc, _EventFunc>::push_back_impl(_T&& value)
+{
+    if (m_cur_size)
+        unshare_blocks(m_cur_size-1, m_cur_size-1);
+
     element_category_type cat = mdds_mtv_get_element_type(value);
 
-    block* blk_last = m_blocks.empty() ? nullptr : m_blocks.back();
+    block* blk_last = m_blocks.empty() ? nullptr : &m_blocks.back();
     if (!blk_last || !blk_last->mp_data || cat != get_block_type(*blk_last->mp_data))
     {
         // Either there is no block, or the last block is empty or of
@@ -641,10 +898,12 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::push_back(const _T& value)
         size_type block_index = m_blocks.size();
         size_type start_pos = m_cur_size;
 
-        m_blocks.push_back(new block(1));
-        block* blk = m_blocks.back();
-        create_new_block_with_new_cell(blk->mp_data, value);
+        m_blocks.emplace_back(1);
+        block* blk = &m_blocks.back();
+        create_new_block_with_new_cell(blk->mp_data, std::forward<_T>(value));
         ++m_cur_size;
+        update_block_positions(block_index, start_pos);
+        notify_range_changed(mtv::range_change_inserted, start_pos, start_pos, mtv::element_type_empty, cat);
 
         return get_iterator(block_index, start_pos);
     }
@@ -657,9 +916,10 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::push_back(const _T& value)
     size_type block_index = m_blocks.size() - 1;
     size_type start_pos = m_cur_size - blk_last->m_size;
 
-    mdds_mtv_append_value(*blk_last->mp_data, value);
+    mdds_mtv_append_value(*blk_last->mp_data, std::forward<_T>(value));
     ++blk_last->m_size;
     ++m_cur_size;
+    notify_range_changed(mtv::range_change_inserted, m_cur_size-1, m_cur_size-1, mtv::element_type_empty, cat);
 
     return get_iterator(block_index, start_pos);
 }
@@ -670,23 +930,293 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::push_back_empty()
 {
     size_type last_block_size = 0;
     if (!m_blocks.empty())
-        last_block_size = m_blocks.back()->m_size;
+        last_block_size = m_blocks.back().m_size;
+
+    size_type block_index = m_blocks.size();
+    size_type start_pos = m_cur_size;
+
+    if (!append_empty(1))
+    {
+        // Last empty block has been extended.
+        --block_index;
+        start_pos -= last_block_size;
+    }
+    else
+        update_block_positions(block_index, start_pos);
+
+    notify_range_changed(
+        mtv::range_change_inserted, m_cur_size-1, m_cur_size-1, mtv::element_type_empty, mtv::element_type_empty);
+
+    // Get the iterator of the last block.
+    typename blocks_type::iterator block_pos = m_blocks.end();
+    --block_pos;
+
+    return iterator(block_pos, m_blocks.end(), start_pos, block_index);
+}
+
+template<typename _CellBlockFunc, typename _EventFunc>
+void multi_type_vector<_CellBlockFunc, _EventFunc>::append_block_merged(blocks_type& blocks, block& blk)
+{
+    if (blocks.empty() || !merge_into_prev_block(blocks.back(), blk))
+        blocks.push_back(blk);
+}
+
+template<typename _CellBlockFunc, typename _EventFunc>
+bool multi_type_vector<_CellBlockFunc, _EventFunc>::merge_into_prev_block(block& blk_prev, block& blk)
+{
+    if (!blk_prev.mp_data != !blk.mp_data)
+        return false;
+
+    if (!blk.mp_data)
+    {
+        // Both blocks are empty.
+        blk_prev.m_size += blk.m_size;
+        return true;
+    }
+
+    if (mdds::mtv::get_block_type(*blk_prev.mp_data) != mdds::mtv::get_block_type(*blk.mp_data))
+        return false;
+
+    // Move the values of the smaller block into the larger one.
+    if (blk_prev.m_size < blk.m_size)
+    {
+        element_block_func::prepend_values_from_block(*blk.mp_data, *blk_prev.mp_data, 0, blk_prev.m_size);
+        element_block_func::resize_block(*blk_prev.mp_data, 0);
+        release_element_block(blk_prev.mp_data);
+        blk_prev.mp_data = blk.mp_data;
+    }
+    else
+    {
+        element_block_func::append_values_from_block(*blk_prev.mp_data, *blk.mp_data);
+        element_block_func::resize_block(*blk.mp_data, 0);
+        release_element_block(blk.mp_data);
+    }
+
+    blk_prev.m_size += blk.m_size;
+    blk.mp_data = nullptr;
+    return true;
+}
+
+template<typename _CellBlockFunc, typename _EventFunc>
+void multi_type_vector<_CellBlockFunc, _EventFunc>::merge_all_blocks()
+{
+    if (m_blocks.size() < 2)
+        return;
+
+    // Merging does not change the start positions of the blocks that
+    // remain, but it does change their indices.
+    apply_position_shift();
+
+    size_type dest = 0;
+    for (size_type i = 1, n = m_blocks.size(); i < n; ++i)
+    {
+        block& blk_prev = m_blocks[dest];
+        block& blk = m_blocks[i];
+        if (m_maybe_shared.load(std::memory_order_relaxed) && blk_prev.mp_data && blk.mp_data &&
+            mdds::mtv::get_block_type(*blk_prev.mp_data) == mdds::mtv::get_block_type(*blk.mp_data))
+        {
+            unshare_block(blk_prev);
+            unshare_block(blk);
+        }
+
+        if (merge_into_prev_block(blk_prev, blk))
+            continue;
+
+        ++dest;
+        if (dest != i)
+            m_blocks[dest] = blk;
+    }
+
+    m_blocks.erase(m_blocks.begin()+dest+1, m_blocks.end());
+}
+
+template<typename _CellBlockFunc, typename _EventFunc>
+void multi_type_vector<_CellBlockFunc, _EventFunc>::append_segment_merged(
+    blocks_type& blocks, const element_block_type* data, size_type offset, size_type len)
+{
+    block* blk_last = blocks.empty() ? nullptr : &blocks.back();
+    if (!data)
+    {
+        if (blk_last && !blk_last->mp_data)
+            blk_last->m_size += len;
+        else
+            blocks.emplace_back(len);
+        return;
+    }
+
+    element_category_type cat = mdds::mtv::get_block_type(*data);
+    if (blk_last && blk_last->mp_data && mdds::mtv::get_block_type(*blk_last->mp_data) == cat)
+    {
+        element_block_func::append_values_from_block(*blk_last->mp_data, *data, offset, len);
+        blk_last->m_size += len;
+        return;
+    }
+
+    blocks.emplace_back(len);
+    block& blk = blocks.back();
+    blk.mp_data = element_block_func::create_new_block(cat, 0);
+    m_hdl_event.element_block_acquired(blk.mp_data);
+    element_block_func::assign_values_from_block(*blk.mp_data, *data, offset, len);
+}
+
+template<typename _CellBlockFunc, typename _EventFunc>
+template<typename _T>
+void multi_type_vector<_CellBlockFunc, _EventFunc>::append_value_merged(blocks_type& blocks, const _T& value)
+{
+    element_category_type cat = mdds_mtv_get_element_type(value);
+    block* blk_last = blocks.empty() ? nullptr : &blocks.back();
+    if (blk_last && blk_last->mp_data && mdds::mtv::get_block_type(*blk_last->mp_data) == cat)
+    {
+        mdds_mtv_append_value(*blk_last->mp_data, value);
+        ++blk_last->m_size;
+        return;
+    }
+
+    blocks.emplace_back(1);
+    create_new_block_with_new_cell(blocks.back().mp_data, value);
+}
+
+template<typename _CellBlockFunc, typename _EventFunc>
+multi_type_vector<_CellBlockFunc, _EventFunc>::builder::builder(
+    multi_type_vector& db, size_type block_size_hint) : m_db(db)
+{
+    if (block_size_hint > m_db.m_blocks.size())
+        m_db.m_blocks.reserve(block_size_hint);
+}
+
+template<typename _CellBlockFunc, typename _EventFunc>
+template<typename _T>
+void multi_type_vector<_CellBlockFunc, _EventFunc>::builder::append(const _T& value)
+{
+    const _T* p = &value;
+    append(p, p+1);
+}
+
+template<typename _CellBlockFunc, typename _EventFunc>
+template<typename _T, typename>
+void multi_type_vector<_CellBlockFunc, _EventFunc>::builder::append(_T&& value)
+{
+    std::move_iterator<_T*> it(&value);
+    append(it, std::next(it));
+}
+
+template<typename _CellBlockFunc, typename _EventFunc>
+template<typename _T>
+void multi_type_vector<_CellBlockFunc, _EventFunc>::builder::append(const _T& it_begin, const _T& it_end)
+{
+    if (m_db.m_cur_size)
+        m_db.unshare_blocks(m_db.m_cur_size-1, m_db.m_cur_size-1);
+
+    size_type length = std::distance(it_begin, it_end);
+    if (!length)
+        return;
+
+    blocks_type& blocks = m_db.m_blocks;
+    element_category_type cat = mdds_mtv_get_element_type(*it_begin);
+    block* blk_last = blocks.empty() ? nullptr : &blocks.back();
+    if (blk_last && blk_last->mp_data && cat == get_block_type(*blk_last->mp_data))
+    {
+        // Append the values to the last block of the same type.
+        mdds_mtv_append_values(*blk_last->mp_data, *it_begin, it_begin, it_end);
+        blk_last->m_size += length;
+        m_db.m_cur_size += length;
+        m_db.notify_range_changed(
+            mtv::range_change_inserted, m_db.m_cur_size-length, m_db.m_cur_size-1, mtv::element_type_empty, cat);
+        return;
+    }
+
+    // The new block stores its actual position.
+    m_db.apply_position_shift();
+
+    element_block_type* data = mdds_mtv_create_new_block(*it_begin, it_begin, it_end);
+    try
+    {
+        blocks.emplace_back(length);
+    }
+    catch (...)
+    {
+        element_block_func::delete_block(data);
+        throw;
+    }
+
+    block& blk = blocks.back();
+    blk.m_position = m_db.m_cur_size;
+    blk.mp_data = data;
+    m_db.m_hdl_event.element_block_acquired(data);
+    m_db.m_cur_size += length;
+    m_db.notify_range_changed(
+        mtv::range_change_inserted, blk.m_position, m_db.m_cur_size-1, mtv::element_type_empty, cat);
+}
+
+template<typename _CellBlockFunc, typename _EventFunc>
+multi_type_vector<_CellBlockFunc, _EventFunc>::edit_session::edit_session(multi_type_vector& db) :
+    m_db(db), m_active(true)
+{
+    ++m_db.m_edit_sessions;
+}
+
+template<typename _CellBlockFunc, typename _EventFunc>
+multi_type_vector<_CellBlockFunc, _EventFunc>::edit_session::~edit_session()
+{
+    try
+    {
+        commit();
+    }
+    catch (...)
+    {
+        // The blocks are left unmerged, which does not affect the stored
+        // values.
+    }
+}
+
+template<typename _CellBlockFunc, typename _EventFunc>
+void multi_type_vector<_CellBlockFunc, _EventFunc>::edit_session::commit()
+{
+    if (!m_active)
+        return;
+
+    m_active = false;
+    assert(m_db.m_edit_sessions > 0);
+    if (--m_db.m_edit_sessions)
+        // Another session is still active.
+        return;
+
+    m_db.merge_all_blocks();
+
+#ifdef MDDS_MULTI_TYPE_VECTOR_DEBUG
+    if (!m_db.check_block_integrity())
+    {
+        cerr << "block integrity check failed in edit_session::commit" << endl;
+        abort();
+    }
+#endif
+}
 
-    size_type block_index = m_blocks.size();
-    size_type start_pos = m_cur_size;
+template<typename _CellBlockFunc, typename _EventFunc>
+void multi_type_vector<_CellBlockFunc, _EventFunc>::builder::append_empty(size_type length)
+{
+    if (!length)
+        return;
 
-    if (!append_empty(1))
+    blocks_type& blocks = m_db.m_blocks;
+    if (!blocks.empty() && !blocks.back().mp_data)
     {
-        // Last empty block has been extended.
-        --block_index;
-        start_pos -= last_block_size;
+        // Extend the last empty block.
+        blocks.back().m_size += length;
     }
+    else
+    {
+        // The new block stores its actual position.
+        m_db.apply_position_shift();
 
-    // Get the iterator of the last block.
-    typename blocks_type::iterator block_pos = m_blocks.end();
-    --block_pos;
+        blocks.emplace_back(length);
+        blocks.back().m_position = m_db.m_cur_size;
+    }
 
-    return iterator(block_pos, m_blocks.end(), start_pos, block_index);
+    m_db.m_cur_size += length;
+    m_db.notify_range_changed(
+        mtv::range_change_inserted, m_db.m_cur_size-length, m_db.m_cur_size-1,
+        mtv::element_type_empty, mtv::element_type_empty);
 }
 
 template<typename _CellBlockFunc, typename _EventFunc>
@@ -694,6 +1224,8 @@ template<typename _T>
 typename multi_type_vector<_CellBlockFunc, _EventFunc>::iterator
 multi_type_vector<_CellBlockFunc, _EventFunc>::insert(size_type pos, const _T& it_begin, const _T& it_end)
 {
+    unshare_blocks(pos, pos);
+
     size_type block_index = 0, start_pos = 0;
     if (!get_block_position(pos, start_pos, block_index))
         detail::throw_block_position_not_found("multi_type_vector::insert", __LINE__, pos, block_size(), size());
@@ -703,7 +1235,13 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::insert(size_type pos, const _T& i
     dump_blocks(os_prev_block);
 #endif
 
+    prepare_block_positions(block_index);
     iterator ret = insert_cells_impl(pos, start_pos, block_index, it_begin, it_end);
+    update_block_positions(block_index, pos+std::distance(it_begin, it_end));
+    if (it_begin != it_end)
+        notify_range_changed(
+            mtv::range_change_inserted, pos, pos+std::distance(it_begin, it_end)-1,
+            mtv::element_type_empty, mdds_mtv_get_element_type(*it_begin));
 
 #ifdef MDDS_MULTI_TYPE_VECTOR_DEBUG
     if (!check_block_integrity())
@@ -723,6 +1261,8 @@ template<typename _T>
 typename multi_type_vector<_CellBlockFunc, _EventFunc>::iterator
 multi_type_vector<_CellBlockFunc, _EventFunc>::insert(const iterator& pos_hint, size_type pos, const _T& it_begin, const _T& it_end)
 {
+    unshare_blocks(pos, pos);
+
     size_type block_index = 0, start_pos = 0;
     get_block_position(pos_hint, pos, start_pos, block_index);
 
@@ -731,7 +1271,13 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::insert(const iterator& pos_hint,
     dump_blocks(os_prev_block);
 #endif
 
+    prepare_block_positions(block_index);
     iterator ret = insert_cells_impl(pos, start_pos, block_index, it_begin, it_end);
+    update_block_positions(block_index, pos+std::distance(it_begin, it_end));
+    if (it_begin != it_end)
+        notify_range_changed(
+            mtv::range_change_inserted, pos, pos+std::distance(it_begin, it_end)-1,
+            mtv::element_type_empty, mdds_mtv_get_element_type(*it_begin));
 
 #ifdef MDDS_MULTI_TYPE_VECTOR_DEBUG
     if (!check_block_integrity())
@@ -750,21 +1296,88 @@ template<typename _CellBlockFunc, typename _EventFunc>
 bool multi_type_vector<_CellBlockFunc, _EventFunc>::get_block_position(
     size_type row, size_type& start_row, size_type& block_index) const
 {
-    for (size_type i = block_index, n = m_blocks.size(); i < n; ++i)
+    size_type n = m_blocks.size();
+    if (row >= m_cur_size || block_index >= n)
+        return false;
+
+    if (m_block_cache.enabled && !block_index)
+    {
+        // Start from the block found by the last lookup, unless the row
+        // precedes it.
+        size_type cached = m_block_cache.index.load(std::memory_order_relaxed);
+        if (cached < n && block_position(cached) <= row)
+        {
+            block_index = cached;
+            start_row = block_position(cached);
+        }
+    }
+
+    assert(block_position(block_index) == start_row);
+
+    if (row < start_row + m_blocks[block_index].m_size)
+    {
+        // Row is in the initial block.
+        cache_block_index(block_index);
+        return true;
+    }
+
+    if (block_index + 1 < n)
     {
-        const block& blk = *m_blocks[i];
-        if (row < start_row + blk.m_size)
+        // Check the next block before searching, which is where the row
+        // is during sequential access.
+        size_type next_row = start_row + m_blocks[block_index].m_size;
+        if (row < next_row + m_blocks[block_index+1].m_size)
         {
-            // Row is in this block.
-            block_index = i;
+            ++block_index;
+            start_row = next_row;
+            cache_block_index(block_index);
             return true;
         }
+    }
+
+    // Find the last block whose start position is not greater than the row.
+    // The blocks before and after the start of the pending position shift
+    // are searched separately, since their stored positions are offset
+    // differently.
+    size_type first = block_index + 1;
+    size_type last = n;
+    size_type shift = 0;
+    if (m_shift && m_shift_index < n)
+    {
+        if (m_shift_index < first || block_position(m_shift_index) <= row)
+        {
+            first = std::max(first, m_shift_index);
+            shift = m_shift;
+        }
+        else
+            last = m_shift_index;
+    }
 
-        // Specified row is not in this block.
-        start_row += blk.m_size;
+    // Narrow the range down further to one side of the gap in the block
+    // array, so that the blocks can be searched as a contiguous array.
+    size_type gap = m_blocks.gap_position();
+    if (first < gap && gap < last)
+    {
+        if (m_blocks[gap].m_position + shift <= row)
+            first = gap;
+        else
+            last = gap;
     }
 
-    return false;
+    const block* blk_first = &m_blocks[first];
+    const block* blk = std::upper_bound(
+        blk_first, blk_first+last-first, row,
+        [shift](size_type _row, const block& _blk)
+        {
+            return _row < _blk.m_position + shift;
+        }
+    );
+
+    --blk;
+    block_index = first + std::distance(blk_first, blk);
+    start_row = blk->m_position + shift;
+    cache_block_index(block_index);
+    return true;
 }
 
 template<typename _CellBlockFunc, typename _EventFunc>
@@ -796,17 +1409,138 @@ void multi_type_vector<_CellBlockFunc, _EventFunc>::get_block_position(
 }
 
 template<typename _CellBlockFunc, typename _EventFunc>
-template<typename _T>
-void multi_type_vector<_CellBlockFunc, _EventFunc>::create_new_block_with_new_cell(element_block_type*& data, const _T& cell)
+typename multi_type_vector<_CellBlockFunc, _EventFunc>::element_category_type
+multi_type_vector<_CellBlockFunc, _EventFunc>::range_event_type(
+    size_type start_row, size_type block_index, size_type end_pos) const
 {
-    if (data)
+    if (!range_events_type::value)
+        return mtv::element_type_empty;
+
+    const block* blk = &m_blocks[block_index];
+    element_category_type cat = blk->mp_data ? mtv::get_block_type(*blk->mp_data) : mtv::element_type_empty;
+    size_type last_pos = start_row + blk->m_size - 1;
+
+    // Neighboring blocks are of different types except within an edit
+    // session, so this rarely looks past the first block.  The end
+    // position may be out of bound when the caller has yet to validate it.
+    for (++block_index; last_pos < end_pos && block_index < m_blocks.size(); ++block_index)
     {
-        m_hdl_event.element_block_released(data);
-        element_block_func::delete_block(data);
+        blk = &m_blocks[block_index];
+        element_category_type blk_cat = blk->mp_data ? mtv::get_block_type(*blk->mp_data) : mtv::element_type_empty;
+        if (blk_cat != cat)
+            return mtv::element_type_mixed;
+
+        last_pos += blk->m_size;
+    }
+
+    return cat;
+}
+
+template<typename _CellBlockFunc, typename _EventFunc>
+typename multi_type_vector<_CellBlockFunc, _EventFunc>::element_category_type
+multi_type_vector<_CellBlockFunc, _EventFunc>::range_event_type(size_type start_pos, size_type end_pos) const
+{
+    if (!range_events_type::value)
+        return mtv::element_type_empty;
+
+    size_type start_row = 0, block_index = 0;
+    if (!get_block_position(start_pos, start_row, block_index))
+        detail::throw_block_position_not_found("multi_type_vector::range_event_type", __LINE__, start_pos, block_size(), size());
+
+    return range_event_type(start_row, block_index, end_pos);
+}
+
+template<typename _CellBlockFunc, typename _EventFunc>
+void multi_type_vector<_CellBlockFunc, _EventFunc>::update_block_positions(size_type block_index, size_type end_pos)
+{
+    // Start from the block before the first modified block, since that
+    // block may have been resized.
+    if (block_index > 0)
+        --block_index;
+
+    // The new positions get computed from the blocks before it, which have
+    // not been modified.
+    move_position_shift(block_index);
+
+    size_type pos = 0;
+    if (block_index > 0)
+    {
+        const block* blk_prev = &m_blocks[block_index-1];
+        pos = blk_prev->m_position + blk_prev->m_size;
+    }
+
+    size_type i = block_index, n = m_blocks.size();
+    for (; i < n && pos <= end_pos; ++i)
+    {
+        block* blk = &m_blocks[i];
+        blk->m_position = pos;
+        pos += blk->m_size;
+    }
+
+    if (i == n)
+    {
+        // All blocks are up-to-date.
+        m_shift = 0;
+        return;
+    }
+
+    // This and all the blocks that follow have not been modified, and they
+    // all carry the same pending shift.  Fold the change in the container
+    // size into the shift instead of shifting their positions one by one.
+    m_shift = pos - m_blocks[i].m_position;
+    m_shift_index = i;
+
+    // Let the shift start at the first modified block again, so that the
+    // caller may keep modifying the blocks from there on.
+    move_position_shift(block_index);
+}
+
+template<typename _CellBlockFunc, typename _EventFunc>
+void multi_type_vector<_CellBlockFunc, _EventFunc>::prepare_block_positions(size_type block_index)
+{
+    // The block before the first modified block may get resized.
+    if (block_index > 0)
+        --block_index;
+
+    move_position_shift(block_index);
+}
+
+template<typename _CellBlockFunc, typename _EventFunc>
+void multi_type_vector<_CellBlockFunc, _EventFunc>::move_position_shift(size_type block_index)
+{
+    size_type n = m_blocks.size();
+    if (block_index > n)
+        block_index = n;
+
+    if (m_shift)
+    {
+        if (m_shift_index < block_index)
+        {
+            for (size_type i = m_shift_index; i < block_index; ++i)
+                m_blocks[i].m_position += m_shift;
+        }
+        else
+        {
+            for (size_type i = block_index, i_end = std::min(m_shift_index, n); i < i_end; ++i)
+                m_blocks[i].m_position -= m_shift;
+        }
     }
 
+    m_shift_index = block_index;
+    if (block_index == n)
+        // There is no block left for the shift to apply to.
+        m_shift = 0;
+}
+
+template<typename _CellBlockFunc, typename _EventFunc>
+template<typename _T>
+void multi_type_vector<_CellBlockFunc, _EventFunc>::create_new_block_with_new_cell(element_block_type*& data, _T&& cell)
+{
+    if (data)
+        release_element_block(data);
+
     // New cell block with size 1.
-    data = mdds_mtv_create_new_block(1, cell);
+    data = mdds_mtv_create_new_block(1, std::forward<_T>(cell));
     if (!data)
         throw general_error("Failed to create new block.");
 
@@ -817,32 +1551,32 @@ template<typename _CellBlockFunc, typename _EventFunc>
 template<typename _T>
 typename multi_type_vector<_CellBlockFunc, _EventFunc>::iterator
 multi_type_vector<_CellBlockFunc, _EventFunc>::set_cell_to_middle_of_block(
-    size_type start_row, size_type block_index, size_type pos_in_block, const _T& cell)
+    size_type start_row, size_type block_index, size_type pos_in_block, _T&& cell)
 {
     block* blk_new = set_new_block_to_middle(block_index, pos_in_block, 1, true);
-    create_new_block_with_new_cell(blk_new->mp_data, cell);
+    create_new_block_with_new_cell(blk_new->mp_data, std::forward<_T>(cell));
 
     // Return the iterator referencing the inserted block.
-    block* blk = m_blocks[block_index];
+    block* blk = &m_blocks[block_index];
     return get_iterator(block_index+1, start_row+blk->m_size);
 }
 
 template<typename _CellBlockFunc, typename _EventFunc>
 template<typename _T>
-void multi_type_vector<_CellBlockFunc, _EventFunc>::append_cell_to_block(size_type block_index, const _T& cell)
+void multi_type_vector<_CellBlockFunc, _EventFunc>::append_cell_to_block(size_type block_index, _T&& cell)
 {
-    block* blk = m_blocks[block_index];
+    block* blk = &m_blocks[block_index];
     blk->m_size += 1;
-    mdds_mtv_append_value(*blk->mp_data, cell);
+    mdds_mtv_append_value(*blk->mp_data, std::forward<_T>(cell));
 }
 
 template<typename _CellBlockFunc, typename _EventFunc>
 template<typename _T>
 typename multi_type_vector<_CellBlockFunc, _EventFunc>::iterator
 multi_type_vector<_CellBlockFunc, _EventFunc>::set_cell_to_empty_block(
-    size_type start_row, size_type block_index, size_type pos_in_block, const _T& cell)
+    size_type start_row, size_type block_index, size_type pos_in_block, _T&& cell)
 {
-    block* blk = m_blocks[block_index];
+    block* blk = &m_blocks[block_index];
 
     if (block_index == 0)
     {
@@ -855,7 +1589,7 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::set_cell_to_empty_block(
             {
                 // This column is allowed to have only one row!
                 assert(pos_in_block == 0);
-                create_new_block_with_new_cell(blk->mp_data, cell);
+                create_new_block_with_new_cell(blk->mp_data, std::forward<_T>(cell));
                 return begin();
             }
 
@@ -866,9 +1600,9 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::set_cell_to_empty_block(
                 blk->m_size -= 1;
                 assert(blk->m_size > 0);
 
-                m_blocks.insert(m_blocks.begin(), new block(1));
-                blk = m_blocks[block_index];
-                create_new_block_with_new_cell(blk->mp_data, cell);
+                m_blocks.emplace(m_blocks.begin(), 1);
+                blk = &m_blocks[block_index];
+                create_new_block_with_new_cell(blk->mp_data, std::forward<_T>(cell));
                 return begin();
             }
 
@@ -878,17 +1612,17 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::set_cell_to_empty_block(
                 blk->m_size -= 1;
                 assert(blk->m_size > 0);
 
-                m_blocks.push_back(new block(1));
-                blk = m_blocks.back();
+                m_blocks.emplace_back(1);
+                blk = &m_blocks.back();
 
-                create_new_block_with_new_cell(blk->mp_data, cell);
+                create_new_block_with_new_cell(blk->mp_data, std::forward<_T>(cell));
                 iterator ret = end();
                 --ret;
                 return ret;
             }
 
             // Insert into the middle of the block.
-            return set_cell_to_middle_of_block(start_row, block_index, pos_in_block, cell);
+            return set_cell_to_middle_of_block(start_row, block_index, pos_in_block, std::forward<_T>(cell));
         }
 
         // This topmost empty block is followed by a non-empty block.
@@ -905,22 +1639,21 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::set_cell_to_empty_block(
                 {
                     // Remove this one-cell empty block from the top, and
                     // prepend the cell to the next block.
-                    delete m_blocks.front();
                     m_blocks.erase(m_blocks.begin());
-                    blk = m_blocks.front();
+                    blk = &m_blocks.front();
                     blk->m_size += 1;
-                    mdds_mtv_prepend_value(*blk->mp_data, cell);
+                    mdds_mtv_prepend_value(*blk->mp_data, std::forward<_T>(cell));
                 }
                 else
-                    create_new_block_with_new_cell(blk->mp_data, cell);
+                    create_new_block_with_new_cell(blk->mp_data, std::forward<_T>(cell));
             }
             else
             {
                 assert(blk->m_size > 1);
                 blk->m_size -= 1;
-                m_blocks.insert(m_blocks.begin(), new block(1));
-                blk = m_blocks.front();
-                create_new_block_with_new_cell(blk->mp_data, cell);
+                m_blocks.emplace(m_blocks.begin(), 1);
+                blk = &m_blocks.front();
+                create_new_block_with_new_cell(blk->mp_data, std::forward<_T>(cell));
             }
 
             return begin();
@@ -937,37 +1670,37 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::set_cell_to_empty_block(
                 // Shrink this empty block by one, and prepend the cell to the next block.
                 blk->m_size -= 1;
                 blk_next->m_size += 1;
-                mdds_mtv_prepend_value(*blk_next->mp_data, cell);
+                mdds_mtv_prepend_value(*blk_next->mp_data, std::forward<_T>(cell));
             }
             else
             {
                 blk->m_size -= 1;
                 typename blocks_type::iterator it = m_blocks.begin();
                 std::advance(it, block_index+1);
-                m_blocks.insert(it, new block(1));
-                block* blk2 = m_blocks[block_index+1];
-                create_new_block_with_new_cell(blk2->mp_data, cell);
+                m_blocks.emplace(it, 1);
+                block* blk2 = &m_blocks[block_index+1];
+                create_new_block_with_new_cell(blk2->mp_data, std::forward<_T>(cell));
             }
 
-            return get_iterator(block_index+1, start_row+blk->m_size);
+            return get_iterator(block_index+1, start_row+m_blocks[block_index].m_size);
         }
 
         // Inserting into the middle of an empty block.
-        return set_cell_to_middle_of_block(start_row, block_index, pos_in_block, cell);
+        return set_cell_to_middle_of_block(start_row, block_index, pos_in_block, std::forward<_T>(cell));
     }
 
     // This empty block is right below a non-empty block.
-    assert(block_index > 0 && m_blocks[block_index-1]->mp_data != nullptr);
+    assert(block_index > 0 && m_blocks[block_index-1].mp_data != nullptr);
 
     if (pos_in_block == 0)
     {
         // New cell is right below the non-empty block.
-        element_category_type blk_cat_prev = mdds::mtv::get_block_type(*m_blocks[block_index-1]->mp_data);
+        element_category_type blk_cat_prev = mdds::mtv::get_block_type(*m_blocks[block_index-1].mp_data);
         element_category_type cat = mdds_mtv_get_element_type(cell);
         if (blk_cat_prev == cat)
         {
             // Extend the previous block by one to insert this cell.
-            size_type offset = m_blocks[block_index-1]->m_size; // for returned iterator
+            size_type offset = m_blocks[block_index-1].m_size; // for returned iterator
 
             if (blk->m_size == 1)
             {
@@ -976,9 +1709,8 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::set_cell_to_empty_block(
                 {
                     // Last block.  Delete this block and extend the previous
                     // block by one.
-                    delete m_blocks[block_index];
                     m_blocks.pop_back();
-                    append_cell_to_block(block_index-1, cell);
+                    append_cell_to_block(block_index-1, std::forward<_T>(cell));
                 }
                 else
                 {
@@ -992,7 +1724,7 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::set_cell_to_empty_block(
                         // delete the current and next blocks.  Be sure to
                         // resize the next block to zero to prevent the
                         // transferred cells to be deleted.
-                        block* blk_prev = m_blocks[block_index-1];
+                        block* blk_prev = &m_blocks[block_index-1];
 
                         // Check if the next block is bigger.
                         if (blk_prev->m_size < blk_next->m_size) 
@@ -1003,7 +1735,7 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::set_cell_to_empty_block(
 
                             // Increase the size of block and prepend the new cell
                             blk_next->m_size += 1;
-                            mdds_mtv_prepend_value(*blk_next->mp_data, cell);
+                            mdds_mtv_prepend_value(*blk_next->mp_data, std::forward<_T>(cell));
 
                             // Preprend the content of previous block to next one
                             element_block_func::prepend_values_from_block(*blk_next->mp_data, *blk_prev->mp_data, 0, blk_prev->m_size);
@@ -1011,12 +1743,9 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::set_cell_to_empty_block(
 
                             // Resize the previous block to zero
                             element_block_func::resize_block(*blk_prev->mp_data, 0);
-                            m_hdl_event.element_block_released(blk_prev->mp_data);
-
-                            // Release both blocks which are no longer used
-                            delete blk;
-                            delete blk_prev;
+                            delete_element_block(blk_prev);
 
+                            // Release both blocks which are no longer used.
                             // Get an iterator to previous block
                             typename blocks_type::iterator it = m_blocks.begin() + block_index - 1;
         
@@ -1028,12 +1757,10 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::set_cell_to_empty_block(
                             // Be sure to resize the next block to zero to prevent the
                             // transferred cells to be deleted. 
                             blk_prev->m_size += 1 + blk_next->m_size;
-                            mdds_mtv_append_value(*blk_prev->mp_data, cell);
+                            mdds_mtv_append_value(*blk_prev->mp_data, std::forward<_T>(cell));
                             element_block_func::append_values_from_block(*blk_prev->mp_data, *blk_next->mp_data);
                             element_block_func::resize_block(*blk_next->mp_data, 0);
-                            m_hdl_event.element_block_released(blk_next->mp_data);
-                            delete blk;
-                            delete blk_next;
+                            delete_element_block(blk_next);
                             typename blocks_type::iterator it = m_blocks.begin() + block_index;
                             m_blocks.erase(it, it+2);
                         }
@@ -1041,9 +1768,8 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::set_cell_to_empty_block(
                     else
                     {
                         // Ignore the next block. Just extend the previous block.
-                        delete m_blocks[block_index];
                         m_blocks.erase(m_blocks.begin() + block_index);
-                        append_cell_to_block(block_index-1, cell);
+                        append_cell_to_block(block_index-1, std::forward<_T>(cell));
                     }
                 }
             }
@@ -1052,7 +1778,7 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::set_cell_to_empty_block(
                 // Extend the previous block to append the cell.
                 assert(blk->m_size > 1);
                 blk->m_size -= 1;
-                append_cell_to_block(block_index-1, cell);
+                append_cell_to_block(block_index-1, std::forward<_T>(cell));
             }
 
             return get_iterator(block_index-1, start_row-offset);
@@ -1065,7 +1791,7 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::set_cell_to_empty_block(
                 if (block_index == m_blocks.size()-1)
                 {
                     // There is no more block below.
-                    create_new_block_with_new_cell(blk->mp_data, cell);
+                    create_new_block_with_new_cell(blk->mp_data, std::forward<_T>(cell));
                 }
                 else
                 {
@@ -1076,13 +1802,12 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::set_cell_to_empty_block(
                     {
                         // Remove this empty block, and prepend the cell to the next block.
                         blk_next->m_size += 1;
-                        mdds_mtv_prepend_value(*blk_next->mp_data, cell);
-                        delete m_blocks[block_index];
+                        mdds_mtv_prepend_value(*blk_next->mp_data, std::forward<_T>(cell));
                         m_blocks.erase(m_blocks.begin()+block_index);
                     }
                     else
                     {
-                        create_new_block_with_new_cell(blk->mp_data, cell);
+                        create_new_block_with_new_cell(blk->mp_data, std::forward<_T>(cell));
                     }
                 }
             }
@@ -1092,9 +1817,10 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::set_cell_to_empty_block(
                 // non-empty block of size 1, and insert a new empty block
                 // below whose size is one shorter than the current empty
                 // block.
-                create_new_block_with_new_cell(blk->mp_data, cell);
-                m_blocks.insert(m_blocks.begin()+block_index+1, new block(blk->m_size-1));
+                create_new_block_with_new_cell(blk->mp_data, std::forward<_T>(cell));
+                size_type new_size = blk->m_size - 1;
                 blk->m_size = 1;
+                m_blocks.emplace(m_blocks.begin()+block_index+1, new_size);
             }
 
             return get_iterator(block_index, start_row);
@@ -1108,9 +1834,9 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::set_cell_to_empty_block(
         {
             // This is the last block.
             blk->m_size -= 1;
-            m_blocks.push_back(new block(1));
-            blk = m_blocks.back();
-            create_new_block_with_new_cell(blk->mp_data, cell);
+            m_blocks.emplace_back(1);
+            blk = &m_blocks.back();
+            create_new_block_with_new_cell(blk->mp_data, std::forward<_T>(cell));
             iterator it = end();
             --it;
             return it;
@@ -1125,45 +1851,53 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::set_cell_to_empty_block(
                 // Shrink this empty block and extend the next block.
                 blk->m_size -= 1;
                 blk_next->m_size += 1;
-                mdds_mtv_prepend_value(*blk_next->mp_data, cell);
+                mdds_mtv_prepend_value(*blk_next->mp_data, std::forward<_T>(cell));
             }
             else
             {
                 // Just insert this new cell.
                 blk->m_size -= 1;
-                m_blocks.insert(m_blocks.begin()+block_index+1, new block(1));
-                block* blk2 = m_blocks[block_index+1];
-                create_new_block_with_new_cell(blk2->mp_data, cell);
+                m_blocks.emplace(m_blocks.begin()+block_index+1, 1);
+                block* blk2 = &m_blocks[block_index+1];
+                create_new_block_with_new_cell(blk2->mp_data, std::forward<_T>(cell));
             }
 
-            size_type offset = blk->m_size;
+            size_type offset = m_blocks[block_index].m_size;
             return get_iterator(block_index+1, start_row+offset);
         }
     }
 
     // New cell is somewhere in the middle of an empty block.
-    return set_cell_to_middle_of_block(start_row, block_index, pos_in_block, cell);
+    return set_cell_to_middle_of_block(start_row, block_index, pos_in_block, std::forward<_T>(cell));
 }
 
 template<typename _CellBlockFunc, typename _EventFunc>
 template<typename _T>
 typename multi_type_vector<_CellBlockFunc, _EventFunc>::iterator
 multi_type_vector<_CellBlockFunc, _EventFunc>::set_cell_to_block_of_size_one(
-    size_type start_row, size_type block_index, const _T& cell)
+    size_type start_row, size_type block_index, _T&& cell)
 {
-    block* blk = m_blocks[block_index];
+    block* blk = &m_blocks[block_index];
     assert(blk->m_size == 1);
     assert(blk->mp_data);
     element_category_type cat = mdds_mtv_get_element_type(cell);
     assert(mdds::mtv::get_block_type(*blk->mp_data) != cat);
 
+    if (m_edit_sessions)
+    {
+        // Merging is deferred until the edit session ends.  Just replace
+        // the current block.
+        create_new_block_with_new_cell(blk->mp_data, std::forward<_T>(cell));
+        return get_iterator(block_index, start_row);
+    }
+
     if (block_index == 0)
     {
         // This is the topmost block of size 1.
         if (block_index == m_blocks.size()-1)
         {
             // This is the only block.
-            create_new_block_with_new_cell(blk->mp_data, cell);
+            create_new_block_with_new_cell(blk->mp_data, std::forward<_T>(cell));
             return begin();
         }
 
@@ -1172,15 +1906,14 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::set_cell_to_block_of_size_one(
         if (!blk_next)
         {
             // Next block is empty or of different type.
-            create_new_block_with_new_cell(blk->mp_data, cell);
+            create_new_block_with_new_cell(blk->mp_data, std::forward<_T>(cell));
             return begin();
         }
 
         // Delete the current block, and prepend the cell to the next block.
         blk_next->m_size += 1;
-        mdds_mtv_prepend_value(*blk_next->mp_data, cell);
-        m_hdl_event.element_block_released(blk->mp_data);
-        delete blk;
+        mdds_mtv_prepend_value(*blk_next->mp_data, std::forward<_T>(cell));
+        delete_element_block(blk);
         m_blocks.erase(m_blocks.begin()+block_index);
         return begin();
     }
@@ -1190,20 +1923,19 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::set_cell_to_block_of_size_one(
     if (block_index == m_blocks.size()-1)
     {
         // This is the last block, and a block exists above.
-        block* blk_prev = m_blocks[block_index-1];
+        block* blk_prev = &m_blocks[block_index-1];
         if (!blk_prev->mp_data || mdds::mtv::get_block_type(*blk_prev->mp_data) != cat)
         {
             // Previous block is empty. Replace the current block with a new one.
-            create_new_block_with_new_cell(blk->mp_data, cell);
+            create_new_block_with_new_cell(blk->mp_data, std::forward<_T>(cell));
         }
         else
         {
             // Append the cell to the previos block, and remove the
             // current block.
-            mdds_mtv_append_value(*blk_prev->mp_data, cell);
+            mdds_mtv_append_value(*blk_prev->mp_data, std::forward<_T>(cell));
             blk_prev->m_size += 1;
-            m_hdl_event.element_block_released(blk->mp_data);
-            delete blk;
+            delete_element_block(blk);
             m_blocks.erase(m_blocks.begin()+block_index);
         }
 
@@ -1216,15 +1948,15 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::set_cell_to_block_of_size_one(
     // to the previous block, or prepended to the following block.
     // Also check if the blocks above and below need to be combined.
 
-    block* blk_prev = m_blocks[block_index-1];
-    block* blk_next = m_blocks[block_index+1];
+    block* blk_prev = &m_blocks[block_index-1];
+    block* blk_next = &m_blocks[block_index+1];
     if (!blk_prev->mp_data)
     {
         // Previous block is empty.
         if (!blk_next->mp_data)
         {
             // Next block is empty too.
-            create_new_block_with_new_cell(blk->mp_data, cell);
+            create_new_block_with_new_cell(blk->mp_data, std::forward<_T>(cell));
             return get_iterator(block_index, start_row);
         }
 
@@ -1233,17 +1965,16 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::set_cell_to_block_of_size_one(
         if (blk_cat_next == cat)
         {
             // Delete the current block, and prepend the new cell to the next block.
-            m_hdl_event.element_block_released(blk->mp_data);
-            delete blk;
+            delete_element_block(blk);
             m_blocks.erase(m_blocks.begin()+block_index);
-            blk = m_blocks[block_index];
+            blk = &m_blocks[block_index];
             blk->m_size += 1;
-            mdds_mtv_prepend_value(*blk->mp_data, cell);
+            mdds_mtv_prepend_value(*blk->mp_data, std::forward<_T>(cell));
             return get_iterator(block_index, start_row);
         }
 
         assert(blk_cat_next != cat);
-        create_new_block_with_new_cell(blk->mp_data, cell);
+        create_new_block_with_new_cell(blk->mp_data, std::forward<_T>(cell));
         return get_iterator(block_index, start_row);
     }
 
@@ -1257,15 +1988,14 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::set_cell_to_block_of_size_one(
             // Append to the previous block.
             size_type offset = blk_prev->m_size;
             blk_prev->m_size += 1;
-            mdds_mtv_append_value(*blk_prev->mp_data, cell);
-            m_hdl_event.element_block_released(blk->mp_data);
-            delete blk;
+            mdds_mtv_append_value(*blk_prev->mp_data, std::forward<_T>(cell));
+            delete_element_block(blk);
             m_blocks.erase(m_blocks.begin()+block_index);
             return get_iterator(block_index-1, start_row-offset);
         }
 
         // Just overwrite the current block.
-        create_new_block_with_new_cell(blk->mp_data, cell);
+        create_new_block_with_new_cell(blk->mp_data, std::forward<_T>(cell));
         return get_iterator(block_index, start_row);
     }
 
@@ -1283,15 +2013,13 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::set_cell_to_block_of_size_one(
             // deletion of mananged cells on block deletion.
             size_type offset = blk_prev->m_size;
             blk_prev->m_size += 1 + blk_next->m_size;
-            mdds_mtv_append_value(*blk_prev->mp_data, cell);
+            mdds_mtv_append_value(*blk_prev->mp_data, std::forward<_T>(cell));
             element_block_func::append_values_from_block(*blk_prev->mp_data, *blk_next->mp_data);
             element_block_func::resize_block(*blk_next->mp_data, 0);
 
             // Delete the current and next blocks.
-            m_hdl_event.element_block_released(blk->mp_data);
-            m_hdl_event.element_block_released(blk_next->mp_data);
-            delete blk;
-            delete blk_next;
+            delete_element_block(blk);
+            delete_element_block(blk_next);
             typename blocks_type::iterator it = m_blocks.begin() + block_index;
             typename blocks_type::iterator it_last = it + 2;
             m_blocks.erase(it, it_last);
@@ -1299,7 +2027,7 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::set_cell_to_block_of_size_one(
         }
 
         // Just overwrite the current block.
-        create_new_block_with_new_cell(blk->mp_data, cell);
+        create_new_block_with_new_cell(blk->mp_data, std::forward<_T>(cell));
         return get_iterator(block_index, start_row);
     }
 
@@ -1310,9 +2038,8 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::set_cell_to_block_of_size_one(
         // Append to the previous block.
         size_type offset = blk_prev->m_size;
         blk_prev->m_size += 1;
-        mdds_mtv_append_value(*blk_prev->mp_data, cell);
-        m_hdl_event.element_block_released(blk->mp_data);
-        delete blk;
+        mdds_mtv_append_value(*blk_prev->mp_data, std::forward<_T>(cell));
+        delete_element_block(blk);
         m_blocks.erase(m_blocks.begin()+block_index);
         return get_iterator(block_index-1, start_row-offset);
     }
@@ -1321,49 +2048,48 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::set_cell_to_block_of_size_one(
     {
         // Prepend to the next block.
         blk_next->m_size += 1;
-        mdds_mtv_prepend_value(*blk_next->mp_data, cell);
-        m_hdl_event.element_block_released(blk->mp_data);
-        delete blk;
+        mdds_mtv_prepend_value(*blk_next->mp_data, std::forward<_T>(cell));
+        delete_element_block(blk);
         m_blocks.erase(m_blocks.begin()+block_index);
         return get_iterator(block_index, start_row);
     }
 
     // Just overwrite the current block.
-    create_new_block_with_new_cell(blk->mp_data, cell);
+    create_new_block_with_new_cell(blk->mp_data, std::forward<_T>(cell));
     return get_iterator(block_index, start_row);
 }
 
 template<typename _CellBlockFunc, typename _EventFunc>
 template<typename _T>
-void multi_type_vector<_CellBlockFunc, _EventFunc>::set_cell_to_top_of_data_block(size_type block_index, const _T& cell)
+void multi_type_vector<_CellBlockFunc, _EventFunc>::set_cell_to_top_of_data_block(size_type block_index, _T&& cell)
 {
-    block* blk = m_blocks[block_index];
+    block* blk = &m_blocks[block_index];
     blk->m_size -= 1;
     if (blk->mp_data)
     {
         element_block_func::overwrite_values(*blk->mp_data, 0, 1);
         element_block_func::erase(*blk->mp_data, 0);
     }
-    m_blocks.insert(m_blocks.begin()+block_index, new block(1));
-    blk = m_blocks[block_index];
-    create_new_block_with_new_cell(blk->mp_data, cell);
+    m_blocks.emplace(m_blocks.begin()+block_index, 1);
+    blk = &m_blocks[block_index];
+    create_new_block_with_new_cell(blk->mp_data, std::forward<_T>(cell));
 }
 
 template<typename _CellBlockFunc, typename _EventFunc>
 template<typename _T>
-void multi_type_vector<_CellBlockFunc, _EventFunc>::set_cell_to_bottom_of_data_block(size_type block_index, const _T& cell)
+void multi_type_vector<_CellBlockFunc, _EventFunc>::set_cell_to_bottom_of_data_block(size_type block_index, _T&& cell)
 {
     assert(block_index < m_blocks.size());
-    block* blk = m_blocks[block_index];
+    block* blk = &m_blocks[block_index];
     if (blk->mp_data)
     {
         element_block_func::overwrite_values(*blk->mp_data, blk->m_size-1, 1);
         element_block_func::erase(*blk->mp_data, blk->m_size-1);
     }
     blk->m_size -= 1;
-    m_blocks.insert(m_blocks.begin()+block_index+1, new block(1));
-    blk = m_blocks[block_index+1];
-    create_new_block_with_new_cell(blk->mp_data, cell);
+    m_blocks.emplace(m_blocks.begin()+block_index+1, 1);
+    blk = &m_blocks[block_index+1];
+    create_new_block_with_new_cell(blk->mp_data, std::forward<_T>(cell));
 }
 
 template<typename _CellBlockFunc, typename _EventFunc>
@@ -1375,7 +2101,7 @@ void multi_type_vector<_CellBlockFunc, _EventFunc>::get(size_type pos, _T& value
     if (!get_block_position(pos, start_row, block_index))
         detail::throw_block_position_not_found("multi_type_vector::get", __LINE__, pos, block_size(), size());
 
-    const block* blk = m_blocks[block_index];
+    const block* blk = &m_blocks[block_index];
     assert(blk);
 
     if (!blk->mp_data)
@@ -1400,17 +2126,49 @@ _T multi_type_vector<_CellBlockFunc, _EventFunc>::get(size_type pos) const
     return cell;
 }
 
+template<typename _CellBlockFunc, typename _EventFunc>
+template<typename _Blk>
+mtv::element_span<const typename _Blk::value_type>
+multi_type_vector<_CellBlockFunc, _EventFunc>::get_span(size_type start_pos, size_type end_pos) const
+{
+    if (start_pos > end_pos)
+        throw std::out_of_range("multi_type_vector::get_span: start position is larger than the end position!");
+
+    if (end_pos >= m_cur_size)
+        throw std::out_of_range("multi_type_vector::get_span: end position is out of bound!");
+
+    size_type start_row = 0;
+    size_type block_index = 0;
+    if (!get_block_position(start_pos, start_row, block_index))
+        detail::throw_block_position_not_found("multi_type_vector::get_span", __LINE__, start_pos, block_size(), size());
+
+    const block& blk = m_blocks[block_index];
+    if (!blk.mp_data || mtv::get_block_type(*blk.mp_data) != _Blk::block_type)
+        throw mtv::element_block_error("multi_type_vector::get_span: block is not of the requested type.");
+
+    size_type offset = start_pos - start_row;
+    size_type len = std::min(blk.m_size - offset, end_pos - start_pos + 1);
+    const mtv::base_element_block& data = *blk.mp_data;
+    return mtv::element_span<const typename _Blk::value_type>(_Blk::data(data) + offset, len);
+}
+
 template<typename _CellBlockFunc, typename _EventFunc>
 template<typename _T>
 _T multi_type_vector<_CellBlockFunc, _EventFunc>::release(size_type pos)
 {
+    unshare_blocks(pos, pos);
+
     size_type start_pos = 0;
     size_type block_index = 0;
     if (!get_block_position(pos, start_pos, block_index))
         detail::throw_block_position_not_found("multi_type_vector::release", __LINE__, pos, block_size(), size());
 
+    prepare_block_positions(block_index);
+    element_category_type old_type = range_event_type(start_pos, block_index, pos);
     _T value;
     release_impl(pos, start_pos, block_index, value);
+    update_block_positions(block_index, pos+1);
+    notify_range_changed(mtv::range_change_modified, pos, pos, old_type, mtv::element_type_empty);
     return value;
 }
 
@@ -1419,12 +2177,19 @@ template<typename _T>
 typename multi_type_vector<_CellBlockFunc, _EventFunc>::iterator
 multi_type_vector<_CellBlockFunc, _EventFunc>::release(size_type pos, _T& value)
 {
+    unshare_blocks(pos, pos);
+
     size_type start_pos = 0;
     size_type block_index = 0;
     if (!get_block_position(pos, start_pos, block_index))
         detail::throw_block_position_not_found("multi_type_vector::release", __LINE__, pos, block_size(), size());
 
-    return release_impl(pos, start_pos, block_index, value);
+    prepare_block_positions(block_index);
+    element_category_type old_type = range_event_type(start_pos, block_index, pos);
+    iterator ret = release_impl(pos, start_pos, block_index, value);
+    update_block_positions(block_index, pos+1);
+    notify_range_changed(mtv::range_change_modified, pos, pos, old_type, mtv::element_type_empty);
+    return ret;
 }
 
 template<typename _CellBlockFunc, typename _EventFunc>
@@ -1432,42 +2197,63 @@ template<typename _T>
 typename multi_type_vector<_CellBlockFunc, _EventFunc>::iterator
 multi_type_vector<_CellBlockFunc, _EventFunc>::release(const iterator& pos_hint, size_type pos, _T& value)
 {
+    unshare_blocks(pos, pos);
+
     size_type start_pos = 0;
     size_type block_index = 0;
     get_block_position(pos_hint, pos, start_pos, block_index);
 
-    return release_impl(pos, start_pos, block_index, value);
+    prepare_block_positions(block_index);
+    element_category_type old_type = range_event_type(start_pos, block_index, pos);
+    iterator ret = release_impl(pos, start_pos, block_index, value);
+    update_block_positions(block_index, pos+1);
+    notify_range_changed(mtv::range_change_modified, pos, pos, old_type, mtv::element_type_empty);
+    return ret;
 }
 
 template<typename _CellBlockFunc, typename _EventFunc>
 void multi_type_vector<_CellBlockFunc, _EventFunc>::release()
 {
+    if (m_cur_size)
+        unshare_blocks(0, m_cur_size-1);
+
+    size_type old_size = m_cur_size;
+    element_category_type old_type = old_size ? range_event_type(0, old_size-1) : mtv::element_type_empty;
+
     typename blocks_type::iterator it = m_blocks.begin(), it_end = m_blocks.end();
     for (; it != it_end; ++it)
     {
-        block* blk = *it;
+        block* blk = &*it;
         if (blk->mp_data)
         {
             element_block_func::resize_block(*blk->mp_data, 0);
-            m_hdl_event.element_block_released(blk->mp_data);
+            delete_element_block(blk);
         }
-        delete blk;
     }
 
     m_blocks.clear();
     m_cur_size = 0;
+    m_shift = 0;
+
+    if (old_size)
+        notify_range_changed(mtv::range_change_erased, 0, old_size-1, old_type, mtv::element_type_empty);
 }
 
 template<typename _CellBlockFunc, typename _EventFunc>
 typename multi_type_vector<_CellBlockFunc, _EventFunc>::iterator
 multi_type_vector<_CellBlockFunc, _EventFunc>::release_range(size_type start_pos, size_type end_pos)
 {
+    unshare_blocks(start_pos, end_pos);
+
     size_type start_pos_in_block1 = 0;
     size_type block_index1 = 0;
     if (!get_block_position(start_pos, start_pos_in_block1, block_index1))
         detail::throw_block_position_not_found("multi_type_vector::release_range", __LINE__, start_pos, block_size(), size());
 
-    return set_empty_impl(start_pos, end_pos, start_pos_in_block1, block_index1, false);
+    element_category_type old_type = range_event_type(start_pos_in_block1, block_index1, end_pos);
+    iterator ret = set_empty_impl(start_pos, end_pos, start_pos_in_block1, block_index1, false);
+    notify_range_changed(mtv::range_change_modified, start_pos, end_pos, old_type, mtv::element_type_empty);
+    return ret;
 }
 
 template<typename _CellBlockFunc, typename _EventFunc>
@@ -1475,10 +2261,16 @@ typename multi_type_vector<_CellBlockFunc, _EventFunc>::iterator
 multi_type_vector<_CellBlockFunc, _EventFunc>::release_range(
     const iterator& pos_hint, size_type start_pos, size_type end_pos)
 {
+    unshare_blocks(start_pos, end_pos);
+
     size_type start_pos_in_block1 = 0;
     size_type block_index1 = 0;
     get_block_position(pos_hint, start_pos, start_pos_in_block1, block_index1);
-    return set_empty_impl(start_pos, end_pos, start_pos_in_block1, block_index1, false);
+
+    element_category_type old_type = range_event_type(start_pos_in_block1, block_index1, end_pos);
+    iterator ret = set_empty_impl(start_pos, end_pos, start_pos_in_block1, block_index1, false);
+    notify_range_changed(mtv::range_change_modified, start_pos, end_pos, old_type, mtv::element_type_empty);
+    return ret;
 }
 
 template<typename _CellBlockFunc, typename _EventFunc>
@@ -1541,6 +2333,9 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::transfer(
     if (&dest == this)
         throw invalid_arg_error("You cannot transfer between the same container.");
 
+    unshare_blocks(start_pos, end_pos);
+    dest.unshare_blocks(dest_pos, dest_pos+end_pos-start_pos);
+
     size_type start_pos_in_block1 = 0;
     size_type block_index1 = 0;
     if (!get_block_position(start_pos, start_pos_in_block1, block_index1))
@@ -1554,7 +2349,27 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::transfer(
     dest.dump_blocks(os_prev_block);
 #endif
 
+    size_type dest_start_pos_in_block = 0;
+    size_type dest_block_index = 0;
+    if (!dest.get_block_position(dest_pos, dest_start_pos_in_block, dest_block_index))
+        detail::throw_block_position_not_found("multi_type_vector::transfer", __LINE__, dest_pos, dest.block_size(), dest.size());
+
+    size_type dest_end_pos = dest_pos + end_pos - start_pos;
+    element_category_type old_type = range_event_type(start_pos_in_block1, block_index1, end_pos);
+    element_category_type dest_old_type = dest.range_event_type(dest_start_pos_in_block, dest_block_index, dest_end_pos);
+
+    prepare_block_positions(block_index1);
+    dest.prepare_block_positions(dest_block_index);
     iterator ret = transfer_impl(start_pos, end_pos, start_pos_in_block1, block_index1, dest, dest_pos);
+    update_block_positions(block_index1, end_pos+1);
+    dest.update_block_positions(dest_block_index, dest_end_pos+1);
+
+    if (m_edit_sessions && !dest.m_edit_sessions)
+        // The transferred blocks may not have been merged yet.
+        dest.merge_all_blocks();
+
+    notify_range_changed(mtv::range_change_modified, start_pos, end_pos, old_type, mtv::element_type_empty);
+    dest.notify_range_changed(mtv::range_change_modified, dest_pos, dest_end_pos, dest_old_type, old_type);
 
 #ifdef MDDS_MULTI_TYPE_VECTOR_DEBUG
     if (!check_block_integrity() || !dest.check_block_integrity())
@@ -1576,6 +2391,9 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::transfer(
     const iterator& pos_hint, size_type start_pos, size_type end_pos,
     multi_type_vector& dest, size_type dest_pos)
 {
+    unshare_blocks(start_pos, end_pos);
+    dest.unshare_blocks(dest_pos, dest_pos+end_pos-start_pos);
+
     size_type start_pos_in_block1 = 0;
     size_type block_index1 = 0;
     get_block_position(pos_hint, start_pos, start_pos_in_block1, block_index1);
@@ -1588,7 +2406,27 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::transfer(
     dest.dump_blocks(os_prev_block);
 #endif
 
+    size_type dest_start_pos_in_block = 0;
+    size_type dest_block_index = 0;
+    if (!dest.get_block_position(dest_pos, dest_start_pos_in_block, dest_block_index))
+        detail::throw_block_position_not_found("multi_type_vector::transfer", __LINE__, dest_pos, dest.block_size(), dest.size());
+
+    size_type dest_end_pos = dest_pos + end_pos - start_pos;
+    element_category_type old_type = range_event_type(start_pos_in_block1, block_index1, end_pos);
+    element_category_type dest_old_type = dest.range_event_type(dest_start_pos_in_block, dest_block_index, dest_end_pos);
+
+    prepare_block_positions(block_index1);
+    dest.prepare_block_positions(dest_block_index);
     iterator ret = transfer_impl(start_pos, end_pos, start_pos_in_block1, block_index1, dest, dest_pos);
+    update_block_positions(block_index1, end_pos+1);
+    dest.update_block_positions(dest_block_index, dest_end_pos+1);
+
+    if (m_edit_sessions && !dest.m_edit_sessions)
+        // The transferred blocks may not have been merged yet.
+        dest.merge_all_blocks();
+
+    notify_range_changed(mtv::range_change_modified, start_pos, end_pos, old_type, mtv::element_type_empty);
+    dest.notify_range_changed(mtv::range_change_modified, dest_pos, dest_end_pos, dest_old_type, old_type);
 
 #ifdef MDDS_MULTI_TYPE_VECTOR_DEBUG
     if (!check_block_integrity() || !dest.check_block_integrity())
@@ -1612,7 +2450,7 @@ mtv::element_t multi_type_vector<_CellBlockFunc, _EventFunc>::get_type(size_type
     if (!get_block_position(pos, start_row, block_index))
         detail::throw_block_position_not_found("multi_type_vector::get_type", __LINE__, pos, block_size(), size());
 
-    const block* blk = m_blocks[block_index];
+    const block* blk = &m_blocks[block_index];
     if (!blk->mp_data)
         return mtv::element_type_empty;
 
@@ -1627,12 +2465,29 @@ bool multi_type_vector<_CellBlockFunc, _EventFunc>::is_empty(size_type pos) cons
     if (!get_block_position(pos, start_row, block_index))
         detail::throw_block_position_not_found("multi_type_vector::is_empty", __LINE__, pos, block_size(), size());
 
-    return m_blocks[block_index]->mp_data == nullptr;
+    return m_blocks[block_index].mp_data == nullptr;
 }
 
 template<typename _CellBlockFunc, typename _EventFunc>
 typename multi_type_vector<_CellBlockFunc, _EventFunc>::iterator
 multi_type_vector<_CellBlockFunc, _EventFunc>::set_empty(size_type start_pos, size_type end_pos)
+{
+    unshare_blocks(start_pos, end_pos);
+
+    size_type start_pos_in_block1 = 0;
+    size_type block_index1 = 0;
+    if (!get_block_position(start_pos, start_pos_in_block1, block_index1))
+        detail::throw_block_position_not_found("multi_type_vector::set_empty", __LINE__, start_pos, block_size(), size());
+
+    element_category_type old_type = range_event_type(start_pos_in_block1, block_index1, end_pos);
+    iterator ret = set_empty_impl(start_pos, end_pos, start_pos_in_block1, block_index1, true);
+    notify_range_changed(mtv::range_change_modified, start_pos, end_pos, old_type, mtv::element_type_empty);
+    return ret;
+}
+
+template<typename _CellBlockFunc, typename _EventFunc>
+typename multi_type_vector<_CellBlockFunc, _EventFunc>::iterator
+multi_type_vector<_CellBlockFunc, _EventFunc>::set_empty_no_event(size_type start_pos, size_type end_pos)
 {
     size_type start_pos_in_block1 = 0;
     size_type block_index1 = 0;
@@ -1646,10 +2501,16 @@ template<typename _CellBlockFunc, typename _EventFunc>
 typename multi_type_vector<_CellBlockFunc, _EventFunc>::iterator
 multi_type_vector<_CellBlockFunc, _EventFunc>::set_empty(const iterator& pos_hint, size_type start_pos, size_type end_pos)
 {
+    unshare_blocks(start_pos, end_pos);
+
     size_type start_pos_in_block1 = 0;
     size_type block_index1 = 0;
     get_block_position(pos_hint, start_pos, start_pos_in_block1, block_index1);
-    return set_empty_impl(start_pos, end_pos, start_pos_in_block1, block_index1, true);
+
+    element_category_type old_type = range_event_type(start_pos_in_block1, block_index1, end_pos);
+    iterator ret = set_empty_impl(start_pos, end_pos, start_pos_in_block1, block_index1, true);
+    notify_range_changed(mtv::range_change_modified, start_pos, end_pos, old_type, mtv::element_type_empty);
+    return ret;
 }
 
 template<typename _CellBlockFunc, typename _EventFunc>
@@ -1698,12 +2559,12 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::transfer_single_block(
     size_type last_dest_pos = dest_pos + len - 1;
 
     // All elements are in the same block.
-    block* blk = m_blocks[block_index1];
+    block* blk = &m_blocks[block_index1];
 
     // Empty the region in the destination container where the elements
     // are to be transferred to. This ensures that the destination region
     // consists of a single block.
-    iterator it_dest_blk = dest.set_empty(dest_pos, last_dest_pos);
+    iterator it_dest_blk = dest.set_empty_no_event(dest_pos, last_dest_pos);
 
     if (!blk->mp_data)
         return get_iterator(block_index1, start_pos_in_block1);
@@ -1711,7 +2572,7 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::transfer_single_block(
     element_category_type cat = get_block_type(*blk->mp_data);
 
     size_type dest_block_index = it_dest_blk->__private_data.block_index;
-    block* blk_dest = dest.m_blocks[dest_block_index];
+    block* blk_dest = &dest.m_blocks[dest_block_index];
 
     size_type dest_pos_in_block = dest_pos - it_dest_blk->position;
     if (dest_pos_in_block == 0)
@@ -1725,8 +2586,8 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::transfer_single_block(
             // Shrink the existing block and insert a new block before it.
             assert(len < blk_dest->m_size);
             blk_dest->m_size -= len;
-            dest.m_blocks.insert(dest.m_blocks.begin()+dest_block_index, new block(len));
-            blk_dest = dest.m_blocks[dest_block_index];
+            dest.m_blocks.emplace(dest.m_blocks.begin()+dest_block_index, len);
+            blk_dest = &dest.m_blocks[dest_block_index];
         }
     }
     else if (dest_pos_in_block + len - 1 == it_dest_blk->size - 1)
@@ -1734,9 +2595,9 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::transfer_single_block(
         // Copy to the bottom part of destination block.
 
         // Insert a new block below current, and shrink the current block.
-        dest.m_blocks.insert(dest.m_blocks.begin()+dest_block_index+1, new block(len));
         blk_dest->m_size -= len;
-        blk_dest = dest.m_blocks[dest_block_index+1];
+        dest.m_blocks.emplace(dest.m_blocks.begin()+dest_block_index+1, len);
+        blk_dest = &dest.m_blocks[dest_block_index+1];
         ++dest_block_index; // Must point to the new copied block.
     }
     else
@@ -1745,12 +2606,12 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::transfer_single_block(
 
         // Insert two new blocks below current.
         size_type blk2_size = blk_dest->m_size - dest_pos_in_block - len;
-        dest.m_blocks.insert(dest.m_blocks.begin()+dest_block_index+1, 2u, nullptr);
-        dest.m_blocks[dest_block_index+1] = new block(len);
-        dest.m_blocks[dest_block_index+2] = new block(blk2_size);
         blk_dest->m_size = dest_pos_in_block;
+        dest.m_blocks.insert(dest.m_blocks.begin()+dest_block_index+1, 2u, block());
+        dest.m_blocks[dest_block_index+1] = block(len);
+        dest.m_blocks[dest_block_index+2] = block(blk2_size);
 
-        blk_dest = dest.m_blocks[dest_block_index+1];
+        blk_dest = &dest.m_blocks[dest_block_index+1];
 
         ++dest_block_index; // Must point to the new copied block.
     }
@@ -1804,11 +2665,11 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::transfer_multi_blocks(
     // Empty the region in the destination container where the elements
     // are to be transferred to. This ensures that the destination region
     // consists of a single block.
-    iterator it_dest_blk = dest.set_empty(dest_pos, last_dest_pos);
+    iterator it_dest_blk = dest.set_empty_no_event(dest_pos, last_dest_pos);
 
     size_type dest_block_index = it_dest_blk->__private_data.block_index;
     size_type dest_pos_in_block = dest_pos - it_dest_blk->position;
-    block* blk_dest = dest.m_blocks[dest_block_index];
+    block* blk_dest = &dest.m_blocks[dest_block_index];
     assert(!blk_dest->mp_data); // should be already emptied.
 
     size_type block_len = block_index2 - block_index1 + 1;
@@ -1823,23 +2684,23 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::transfer_multi_blocks(
         {
             // Shrink the existing block and insert slots for new blocks before it.
             blk_dest->m_size -= len;
-            dest.m_blocks.insert(dest.m_blocks.begin()+dest_block_index, block_len, nullptr);
+            dest.m_blocks.insert(dest.m_blocks.begin()+dest_block_index, block_len, block());
         }
         else
         {
             // Destination block is exactly of the length of the elements being transferred.
-            dest.delete_block(dest.m_blocks[dest_block_index]);
-            dest.m_blocks[dest_block_index] = nullptr;
+            dest.delete_element_block(blk_dest);
+            dest.m_blocks[dest_block_index] = block();
             if (block_len > 1)
-                dest.m_blocks.insert(dest.m_blocks.begin()+dest_block_index, block_len-1, nullptr);
+                dest.m_blocks.insert(dest.m_blocks.begin()+dest_block_index, block_len-1, block());
         }
     }
     else if (dest_pos_in_block + len - 1 == it_dest_blk->size - 1)
     {
         // Copy to the bottom part of destination block. Insert slots for new
         // blocks below current, and shrink the current block.
-        dest.m_blocks.insert(dest.m_blocks.begin()+dest_block_index+1, block_len, nullptr);
         blk_dest->m_size -= len;
+        dest.m_blocks.insert(dest.m_blocks.begin()+dest_block_index+1, block_len, block());
 
         ++dest_block_index1;
     }
@@ -1848,10 +2709,10 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::transfer_multi_blocks(
         // Copy to the middle of destination block. Insert slots for new
         // blocks (plus one for the bottom empty block) below current.
         size_type blk2_size = blk_dest->m_size - dest_pos_in_block - len;
-        dest.m_blocks.insert(dest.m_blocks.begin()+dest_block_index+1, block_len+1, nullptr);
-        assert(dest.m_blocks.size() > dest_block_index+block_len+1);
-        dest.m_blocks[dest_block_index+block_len+1] = new block(blk2_size);
         blk_dest->m_size = dest_pos_in_block;
+        dest.m_blocks.insert(dest.m_blocks.begin()+dest_block_index+1, block_len+1, block());
+        assert(dest.m_blocks.size() > dest_block_index+block_len+1);
+        dest.m_blocks[dest_block_index+block_len+1] = block(blk2_size);
 
         ++dest_block_index1;
     }
@@ -1866,13 +2727,13 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::transfer_multi_blocks(
     if (offset)
     {
         // Transfer the lower part of the first block.
-        block* blk = m_blocks[block_index1];
-        assert(!dest.m_blocks[dest_block_index1]);
-        dest.m_blocks[dest_block_index1] = new block(blk->m_size - offset);
+        block* blk = &m_blocks[block_index1];
+        assert(!dest.m_blocks[dest_block_index1].m_size);
+        dest.m_blocks[dest_block_index1] = block(blk->m_size - offset);
         if (blk->mp_data)
         {
             element_category_type cat = mtv::get_block_type(*blk->mp_data);
-            blk_dest = dest.m_blocks[dest_block_index1];
+            blk_dest = &dest.m_blocks[dest_block_index1];
             blk_dest->mp_data = element_block_func::create_new_block(cat, 0);
             assert(blk_dest->mp_data);
             dest.m_hdl_event.element_block_acquired(blk_dest->mp_data);
@@ -1893,14 +2754,14 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::transfer_multi_blocks(
     else
     {
         // Just move the whole block over.
-        block* blk = m_blocks[block_index1];
-        dest.m_blocks[dest_block_index1] = blk;
+        block* blk = &m_blocks[block_index1];
         if (blk->mp_data)
         {
             dest.m_hdl_event.element_block_acquired(blk->mp_data);
             m_hdl_event.element_block_released(blk->mp_data);
         }
-        m_blocks[block_index1] = nullptr;
+        dest.m_blocks[dest_block_index1] = *blk;
+        *blk = block();
     }
 
     if (block_len > 2)
@@ -1910,15 +2771,15 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::transfer_multi_blocks(
         {
             size_type src_block_pos = block_index1 + 1 + i;
             size_type dest_block_pos = dest_block_index1 + 1 + i;
-            assert(!dest.m_blocks[dest_block_pos]);
-            block* blk = m_blocks[src_block_pos];
-            dest.m_blocks[dest_block_pos] = blk;
+            assert(!dest.m_blocks[dest_block_pos].m_size);
+            block* blk = &m_blocks[src_block_pos];
             if (blk->mp_data)
             {
                 dest.m_hdl_event.element_block_acquired(blk->mp_data);
                 m_hdl_event.element_block_released(blk->mp_data);
             }
-            m_blocks[src_block_pos] = nullptr;
+            dest.m_blocks[dest_block_pos] = *blk;
+            *blk = block();
         }
     }
 
@@ -1927,14 +2788,14 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::transfer_multi_blocks(
     {
         size_type size_to_trans = end_pos - start_pos_in_block2 + 1;
         size_type dest_block_pos = dest_block_index1 + block_len - 1;
-        assert(!dest.m_blocks[dest_block_pos]);
+        assert(!dest.m_blocks[dest_block_pos].m_size);
 
-        block* blk = m_blocks[block_index2];
+        block* blk = &m_blocks[block_index2];
         if (size_to_trans < blk->m_size)
         {
             // Transfer the upper part of this block.
-            dest.m_blocks[dest_block_pos] = new block(size_to_trans);
-            blk_dest = dest.m_blocks[dest_block_pos];
+            dest.m_blocks[dest_block_pos] = block(size_to_trans);
+            blk_dest = &dest.m_blocks[dest_block_pos];
             if (blk->mp_data)
             {
                 element_category_type cat = mtv::get_block_type(*blk->mp_data);
@@ -1950,13 +2811,13 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::transfer_multi_blocks(
         else
         {
             // Just move the whole block over.
-            dest.m_blocks[dest_block_pos] = blk;
             if (blk->mp_data)
             {
                 dest.m_hdl_event.element_block_acquired(blk->mp_data);
                 m_hdl_event.element_block_released(blk->mp_data);
             }
-            m_blocks[block_index2] = nullptr;
+            dest.m_blocks[dest_block_pos] = *blk;
+            *blk = block();
         }
     }
 
@@ -1972,8 +2833,8 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::transfer_multi_blocks(
         // No blocks will be deleted.  See if we can just extend one of the
         // neighboring empty blocks.
 
-        block* blk1 = m_blocks[block_index1];
-        block* blk2 = m_blocks[block_index2];
+        block* blk1 = &m_blocks[block_index1];
+        block* blk2 = &m_blocks[block_index2];
 
         if (!blk1->mp_data)
         {
@@ -1996,15 +2857,15 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::transfer_multi_blocks(
         // Neither block1 nor block2 are empty. Just insert a new empty block
         // between them. After the insertion, the old block2 position becomes
         // the position of the inserted block.
-        m_blocks.insert(m_blocks.begin()+block_index2, new block(len));
+        m_blocks.emplace(m_blocks.begin()+block_index2, len);
         return get_iterator(block_index2, start_pos);
     }
 
-    if (del_index1 > 0 && !m_blocks[del_index1-1]->mp_data)
+    if (del_index1 > 0 && !m_blocks[del_index1-1].mp_data)
     {
         // The block before the first block to be deleted is empty.  Simply
         // extend that block to cover the deleted block segment.
-        block* blk_prev = m_blocks[del_index1-1];
+        block* blk_prev = &m_blocks[del_index1-1];
 
         // This previous empty block will be returned.  Adjust the return block position.
         --ret_block_index;
@@ -2017,7 +2878,7 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::transfer_multi_blocks(
     {
         // Block before is not empty (or doesn't exist).  Keep the first slot,
         // and erase the rest.
-        m_blocks[del_index1] = new block(len); // Insert an empty
+        m_blocks[del_index1] = block(len); // Insert an empty
         ++del_index1;
     }
 
@@ -2032,8 +2893,8 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::transfer_multi_blocks(
         typename blocks_type::iterator it_test = it_blk;
         for (; it_test != it_blk_end; ++it_test)
         {
-            // All slots to be erased should be nullptr.
-            assert(!*it_test);
+            // All slots to be erased should have been emptied.
+            assert(!it_test->m_size && !it_test->mp_data);
         }
 #endif
         m_blocks.erase(it_blk, it_blk_end);
@@ -2064,6 +2925,8 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::set_empty_impl(
     if (!get_block_position(end_pos, start_pos_in_block2, block_index2))
         detail::throw_block_position_not_found("multi_type_vector::set_empty_impl", __LINE__, end_pos, block_size(), size());
 
+    prepare_block_positions(block_index1);
+
 #ifdef MDDS_MULTI_TYPE_VECTOR_DEBUG
     std::ostringstream os_prev_block;
     dump_blocks(os_prev_block);
@@ -2076,6 +2939,8 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::set_empty_impl(
         ret_it = set_empty_in_multi_blocks(
             start_pos, end_pos, block_index1, start_pos_in_block1, block_index2, start_pos_in_block2, overwrite);
 
+    update_block_positions(block_index1, end_pos+1);
+
 #ifdef MDDS_MULTI_TYPE_VECTOR_DEBUG
     if (!check_block_integrity())
     {
@@ -2137,8 +3002,8 @@ void multi_type_vector<_CellBlockFunc, _EventFunc>::swap_single_block(
     multi_type_vector& other, size_type start_pos, size_type end_pos, size_type other_pos,
     size_type start_pos_in_block, size_type block_index, size_type start_pos_in_other_block, size_type other_block_index)
 {
-    block* blk_src = m_blocks[block_index];
-    block* blk_dst = other.m_blocks[other_block_index];
+    block* blk_src = &m_blocks[block_index];
+    block* blk_dst = &other.m_blocks[other_block_index];
     element_category_type cat_src = mtv::element_type_empty;
     element_category_type cat_dst = mtv::element_type_empty;
 
@@ -2220,8 +3085,8 @@ void multi_type_vector<_CellBlockFunc, _EventFunc>::swap_single_block(
         else
         {
             // Insert a new block to store the new elements.
-            m_blocks.insert(m_blocks.begin()+block_index, new block(len));
-            block* blk = m_blocks[block_index];
+            m_blocks.emplace(m_blocks.begin()+block_index, len);
+            block* blk = &m_blocks[block_index];
             blk->mp_data = dst_data.release();
             m_hdl_event.element_block_acquired(blk->mp_data);
         }
@@ -2250,8 +3115,8 @@ void multi_type_vector<_CellBlockFunc, _EventFunc>::swap_single_block(
         }
         else
         {
-            m_blocks.insert(m_blocks.begin()+block_index+1, new block(len));
-            block* blk = m_blocks[block_index+1];
+            m_blocks.emplace(m_blocks.begin()+block_index+1, len);
+            block* blk = &m_blocks[block_index+1];
             blk->mp_data = dst_data.release();
             m_hdl_event.element_block_acquired(blk->mp_data);
         }
@@ -2271,7 +3136,7 @@ void multi_type_vector<_CellBlockFunc, _EventFunc>::swap_single_to_multi_blocks(
     size_type start_pos_in_block, size_type block_index, size_type dst_start_pos_in_block1, size_type dst_block_index1,
     size_type dst_start_pos_in_block2, size_type dst_block_index2)
 {
-    block* blk_src = m_blocks[block_index];
+    block* blk_src = &m_blocks[block_index];
     element_category_type cat_src = mtv::element_type_empty;
     if (blk_src->mp_data)
         cat_src = mtv::get_block_type(*blk_src->mp_data);
@@ -2309,7 +3174,7 @@ void multi_type_vector<_CellBlockFunc, _EventFunc>::swap_single_to_multi_blocks(
         if (src_tail_len == 0)
         {
             // the whole block needs to be replaced.
-            delete_block(blk_src);
+            delete_element_block(blk_src);
             m_blocks.erase(m_blocks.begin()+block_index);
         }
         else
@@ -2342,7 +3207,7 @@ void multi_type_vector<_CellBlockFunc, _EventFunc>::swap_single_to_multi_blocks(
 
         // This creates an empty block at block_index+1.
         set_new_block_to_middle(block_index, src_offset, len, false);
-        delete_block(m_blocks[block_index+1]);
+        delete_element_block(&m_blocks[block_index+1]);
         m_blocks.erase(m_blocks.begin()+block_index+1);
     }
 
@@ -2371,7 +3236,8 @@ void multi_type_vector<_CellBlockFunc, _EventFunc>::swap_multi_to_multi_blocks(
     other.prepare_blocks_to_transfer(dst_bucket, dblock_index1, dst_offset1, dblock_index2, dst_offset2);
 
     m_blocks.insert(
-        m_blocks.begin()+src_bucket.insert_index, dst_bucket.blocks.begin(), dst_bucket.blocks.end());
+        m_blocks.begin()+src_bucket.insert_index,
+        dst_bucket.blocks.begin(), dst_bucket.blocks.end());
 
     // Merge the boundary blocks in the source.
     merge_with_next_block(src_bucket.insert_index + dst_bucket.blocks.size()-1);
@@ -2379,7 +3245,8 @@ void multi_type_vector<_CellBlockFunc, _EventFunc>::swap_multi_to_multi_blocks(
         merge_with_next_block(src_bucket.insert_index - 1);
 
     other.m_blocks.insert(
-        other.m_blocks.begin()+dst_bucket.insert_index, src_bucket.blocks.begin(), src_bucket.blocks.end());
+        other.m_blocks.begin()+dst_bucket.insert_index,
+        src_bucket.blocks.begin(), src_bucket.blocks.end());
 
     // Merge the boundary blocks in the destination.
     other.merge_with_next_block(dst_bucket.insert_index + src_bucket.blocks.size()-1);
@@ -2392,13 +3259,15 @@ void multi_type_vector<_CellBlockFunc, _EventFunc>::insert_blocks_at(
     size_type insert_pos, blocks_type& new_blocks)
 {
     std::for_each(new_blocks.begin(), new_blocks.end(),
-        [&](block* p)
+        [&](const block& r)
         {
-            if (p->mp_data)
-                m_hdl_event.element_block_acquired(p->mp_data);
+            if (r.mp_data)
+                m_hdl_event.element_block_acquired(r.mp_data);
         }
     );
-    m_blocks.insert(m_blocks.begin()+insert_pos, new_blocks.begin(), new_blocks.end());
+    m_blocks.insert(
+        m_blocks.begin()+insert_pos,
+        new_blocks.begin(), new_blocks.end());
 }
 
 template<typename _CellBlockFunc, typename _EventFunc>
@@ -2406,11 +3275,11 @@ void multi_type_vector<_CellBlockFunc, _EventFunc>::prepare_blocks_to_transfer(
     blocks_to_transfer& bucket, size_type block_index1, size_type offset1, size_type block_index2, size_type offset2)
 {
     assert(block_index1 < block_index2);
-    assert(offset1 < m_blocks[block_index1]->m_size);
-    assert(offset2 < m_blocks[block_index2]->m_size);
+    assert(offset1 < m_blocks[block_index1].m_size);
+    assert(offset2 < m_blocks[block_index2].m_size);
 
-    std::unique_ptr<block> block_first(nullptr);
-    std::unique_ptr<block> block_last(nullptr);
+    block block_first;
+    block block_last;
     typename blocks_type::iterator it_begin = m_blocks.begin();
     typename blocks_type::iterator it_end = m_blocks.begin();
 
@@ -2427,13 +3296,13 @@ void multi_type_vector<_CellBlockFunc, _EventFunc>::prepare_blocks_to_transfer(
     else
     {
         // Copy the lower part of the block for transfer.
-        block* blk = m_blocks[block_index1];
+        block* blk = &m_blocks[block_index1];
         size_type blk_size = blk->m_size - offset1;
-        block_first.reset(new block(blk_size));
+        block_first.m_size = blk_size;
         if (blk->mp_data)
         {
-            block_first->mp_data = element_block_func::create_new_block(mtv::get_block_type(*blk->mp_data), 0);
-            element_block_func::assign_values_from_block(*block_first->mp_data, *blk->mp_data, offset1, blk_size);
+            block_first.mp_data = element_block_func::create_new_block(mtv::get_block_type(*blk->mp_data), 0);
+            element_block_func::assign_values_from_block(*block_first.mp_data, *blk->mp_data, offset1, blk_size);
 
             // Shrink the existing block.
             element_block_func::resize_block(*blk->mp_data, offset1);
@@ -2442,7 +3311,7 @@ void multi_type_vector<_CellBlockFunc, _EventFunc>::prepare_blocks_to_transfer(
         blk->m_size = offset1;
     }
 
-    block* blk = m_blocks[block_index2];
+    block* blk = &m_blocks[block_index2];
     if (offset2 == blk->m_size-1)
     {
         // The whole last block needs to be swapped.
@@ -2452,11 +3321,11 @@ void multi_type_vector<_CellBlockFunc, _EventFunc>::prepare_blocks_to_transfer(
     {
         // Copy the upper part of the block for transfer.
         size_type blk_size = offset2 + 1;
-        block_last.reset(new block(blk_size));
+        block_last.m_size = blk_size;
         if (blk->mp_data)
         {
-            block_last->mp_data = element_block_func::create_new_block(mtv::get_block_type(*blk->mp_data), 0);
-            element_block_func::assign_values_from_block(*block_last->mp_data, *blk->mp_data, 0, blk_size);
+            block_last.mp_data = element_block_func::create_new_block(mtv::get_block_type(*blk->mp_data), 0);
+            element_block_func::assign_values_from_block(*block_last.mp_data, *blk->mp_data, 0, blk_size);
 
             // Shrink the existing block.
             element_block_func::erase(*blk->mp_data, 0, blk_size);
@@ -2465,23 +3334,23 @@ void multi_type_vector<_CellBlockFunc, _EventFunc>::prepare_blocks_to_transfer(
         blk->m_size -= blk_size;
     }
 
-    // Copy all blocks into the bucket.
-    if (block_first)
-        bucket.blocks.push_back(block_first.release());
+    // Move all blocks into the bucket.
+    if (block_first.m_size)
+        bucket.blocks.push_back(block_first);
 
     std::for_each(it_begin, it_end,
-        [&](block* p)
+        [&](block& r)
         {
-            if (p->mp_data)
-                m_hdl_event.element_block_released(p->mp_data);
-            bucket.blocks.push_back(p);
+            if (r.mp_data)
+                m_hdl_event.element_block_released(r.mp_data);
+            bucket.blocks.push_back(r);
         }
     );
 
-    if (block_last)
-        bucket.blocks.push_back(block_last.release());
+    if (block_last.m_size)
+        bucket.blocks.push_back(block_last);
 
-    // Remove the slots for these blocks (but don't delete the blocks).
+    // Remove the slots for these blocks, whose contents have been moved.
     m_blocks.erase(it_begin, it_end);
 }
 
@@ -2491,12 +3360,16 @@ void multi_type_vector<_CellBlockFunc, _EventFunc>::erase(size_type start_pos, s
     if (start_pos > end_pos)
         throw std::out_of_range("Start row is larger than the end row.");
 
+    unshare_blocks(start_pos, end_pos);
+
 #ifdef MDDS_MULTI_TYPE_VECTOR_DEBUG
     std::ostringstream os_prev_block;
     dump_blocks(os_prev_block);
 #endif
 
+    element_category_type old_type = range_event_type(start_pos, end_pos);
     erase_impl(start_pos, end_pos);
+    notify_range_changed(mtv::range_change_erased, start_pos, end_pos, old_type, mtv::element_type_empty);
 
 #ifdef MDDS_MULTI_TYPE_VECTOR_DEBUG
     if (!check_block_integrity())
@@ -2526,13 +3399,17 @@ void multi_type_vector<_CellBlockFunc, _EventFunc>::erase_impl(size_type start_r
     if (!get_block_position(end_row, start_row_in_block2, block_pos2))
         detail::throw_block_position_not_found("multi_type_vector::erase_impl", __LINE__, end_row, block_size(), size());
 
+    prepare_block_positions(block_pos1);
+
     if (block_pos1 == block_pos2)
     {
         erase_in_single_block(start_row, end_row, block_pos1, start_row_in_block1);
+        update_block_positions(block_pos1, start_row);
         return;
     }
 
     assert(block_pos1 < block_pos2);
+    size_type first_block_pos = block_pos1;
 
     // Initially, we set to erase all blocks between the first and the last.
     typename blocks_type::iterator it_erase_begin = m_blocks.begin() + block_pos1 + 1;
@@ -2547,7 +3424,7 @@ void multi_type_vector<_CellBlockFunc, _EventFunc>::erase_impl(size_type start_r
     else
     {
         // Erase the lower part of the first block.
-        block* blk = m_blocks[block_pos1];
+        block* blk = &m_blocks[block_pos1];
         size_type new_size = start_row - start_row_in_block1;
         if (blk->mp_data)
         {
@@ -2559,7 +3436,7 @@ void multi_type_vector<_CellBlockFunc, _EventFunc>::erase_impl(size_type start_r
     }
 
     // Then inspect the last block.
-    block* blk = m_blocks[block_pos2];
+    block* blk = &m_blocks[block_pos2];
     size_type last_row_in_block = start_row_in_block2 + blk->m_size - 1;
     if (last_row_in_block == end_row)
     {
@@ -2584,12 +3461,14 @@ void multi_type_vector<_CellBlockFunc, _EventFunc>::erase_impl(size_type start_r
         --block_pos1;
 
     // Now, erase all blocks in between.
-    delete_blocks(it_erase_begin, it_erase_end);
+    delete_element_blocks(it_erase_begin, it_erase_end);
     m_blocks.erase(it_erase_begin, it_erase_end);
     m_cur_size -= end_row - start_row + 1;
 
     if (!m_blocks.empty())
         merge_with_next_block(block_pos1);
+
+    update_block_positions(first_block_pos, start_row);
 }
 
 template<typename _CellBlockFunc, typename _EventFunc>
@@ -2597,7 +3476,7 @@ void multi_type_vector<_CellBlockFunc, _EventFunc>::erase_in_single_block(
     size_type start_pos, size_type end_pos, size_type block_pos, size_type start_pos_in_block)
 {
     // Range falls within the same block.
-    block* blk = m_blocks[block_pos];
+    block* blk = &m_blocks[block_pos];
     size_type size_to_erase = end_pos - start_pos + 1;
     if (blk->mp_data)
     {
@@ -2615,7 +3494,7 @@ void multi_type_vector<_CellBlockFunc, _EventFunc>::erase_in_single_block(
         return;
 
     // Delete the current block since it's become empty.
-    delete_block(blk);
+    delete_element_block(blk);
     m_blocks.erase(m_blocks.begin()+block_pos);
 
     if (block_pos == 0 || block_pos >= m_blocks.size())
@@ -2623,8 +3502,8 @@ void multi_type_vector<_CellBlockFunc, _EventFunc>::erase_in_single_block(
         return;
 
     // Check the previous and next blocks to see if they should be merged.
-    block* blk_prev = m_blocks[block_pos-1];
-    block* blk_next = m_blocks[block_pos];
+    block* blk_prev = &m_blocks[block_pos-1];
+    block* blk_next = &m_blocks[block_pos];
     if (blk_prev->mp_data)
     {
         // Previous block has data.
@@ -2641,7 +3520,7 @@ void multi_type_vector<_CellBlockFunc, _EventFunc>::erase_in_single_block(
             blk_prev->m_size += blk_next->m_size;
             // Resize to 0 to prevent deletion of cells in case of managed cells.
             element_block_func::resize_block(*blk_next->mp_data, 0);
-            delete_block(blk_next);
+            delete_element_block(blk_next);
             m_blocks.erase(m_blocks.begin()+block_pos);
         }
     }
@@ -2655,7 +3534,7 @@ void multi_type_vector<_CellBlockFunc, _EventFunc>::erase_in_single_block(
         // Both blocks are empty.  Simply increase the size of the
         // previous block.
         blk_prev->m_size += blk_next->m_size;
-        delete_block(blk_next);
+        delete_element_block(blk_next);
         m_blocks.erase(m_blocks.begin()+block_pos);
     }
 }
@@ -2668,6 +3547,8 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::insert_empty(size_type pos, size_
         // Nothing to insert.
         return end();
 
+    unshare_blocks(pos, pos);
+
     size_type start_pos = 0, block_index = 0;
     if (!get_block_position(pos, start_pos, block_index))
         detail::throw_block_position_not_found("multi_type_vector::insert_empty", __LINE__, pos, block_size(), size());
@@ -2677,7 +3558,11 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::insert_empty(size_type pos, size_
     dump_blocks(os_prev_block);
 #endif
 
+    prepare_block_positions(block_index);
     iterator ret = insert_empty_impl(pos, start_pos, block_index, length);
+    update_block_positions(block_index, pos+length);
+    notify_range_changed(
+        mtv::range_change_inserted, pos, pos+length-1, mtv::element_type_empty, mtv::element_type_empty);
 
 #ifdef MDDS_MULTI_TYPE_VECTOR_DEBUG
     if (!check_block_integrity())
@@ -2700,6 +3585,8 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::insert_empty(const iterator& pos_
         // Nothing to insert.
         return end();
 
+    unshare_blocks(pos, pos);
+
     size_type start_pos = 0, block_index = 0;
     get_block_position(pos_hint, pos, start_pos, block_index);
 
@@ -2708,7 +3595,11 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::insert_empty(const iterator& pos_
     dump_blocks(os_prev_block);
 #endif
 
+    prepare_block_positions(block_index);
     iterator ret = insert_empty_impl(pos, start_pos, block_index, length);
+    update_block_positions(block_index, pos+length);
+    notify_range_changed(
+        mtv::range_change_inserted, pos, pos+length-1, mtv::element_type_empty, mtv::element_type_empty);
 
 #ifdef MDDS_MULTI_TYPE_VECTOR_DEBUG
     if (!check_block_integrity())
@@ -2730,7 +3621,7 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::insert_empty_impl(
 {
     assert(pos < m_cur_size);
 
-    block* blk = m_blocks[block_index];
+    block* blk = &m_blocks[block_index];
     if (!blk->mp_data)
     {
         // Insertion point is already empty.  Just expand its size and be done
@@ -2756,7 +3647,7 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::insert_empty_impl(
         }
 
         // Insert a new empty block.
-        m_blocks.insert(m_blocks.begin()+block_index, new block(length));
+        m_blocks.emplace(m_blocks.begin()+block_index, length);
         m_cur_size += length;
         return get_iterator(block_index, pos);
     }
@@ -2770,12 +3661,13 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::insert_empty_impl(
     // Insert two new blocks below the current; one for the empty block being
     // inserted, and the other for the lower part of the current non-empty
     // block.
-    m_blocks.insert(m_blocks.begin()+block_index+1, 2u, nullptr);
+    m_blocks.insert(m_blocks.begin()+block_index+1, 2u, block());
 
-    m_blocks[block_index+1] = new block(length);
-    m_blocks[block_index+2] = new block(size_blk_next);
+    m_blocks[block_index+1] = block(length);
+    m_blocks[block_index+2] = block(size_blk_next);
 
-    block* blk_next = m_blocks[block_index+2];
+    blk = &m_blocks[block_index];
+    block* blk_next = &m_blocks[block_index+2];
     blk_next->mp_data =
         element_block_func::create_new_block(mdds::mtv::get_block_type(*blk->mp_data), 0);
     m_hdl_event.element_block_acquired(blk_next->mp_data);
@@ -2803,8 +3695,7 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::insert_empty_impl(
         blk->m_size = size_blk_next;
 
         // And now let's swap the blocks...
-        m_blocks[block_index] = blk_next;
-        m_blocks[block_index+2] = blk;
+        std::swap(*blk, *blk_next);
     }
 
     m_cur_size += length;
@@ -2862,7 +3753,7 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::insert_cells_impl(
         return end();
 
     element_category_type cat = mdds_mtv_get_element_type(*it_begin);
-    block* blk = m_blocks[block_index];
+    block* blk = &m_blocks[block_index];
     if (!blk->mp_data)
     {
         if (row == start_row)
@@ -2883,8 +3774,8 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::insert_cells_impl(
             }
 
             // Just insert a new block before the current block.
-            m_blocks.insert(m_blocks.begin()+block_index, new block(length));
-            blk = m_blocks[block_index];
+            m_blocks.emplace(m_blocks.begin()+block_index, length);
+            blk = &m_blocks[block_index];
             blk->mp_data = element_block_func::create_new_block(cat, 0);
             m_hdl_event.element_block_acquired(blk->mp_data);
             mdds_mtv_assign_values(*blk->mp_data, *it_begin, it_begin, it_end);
@@ -2928,8 +3819,8 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::insert_cells_impl(
         }
 
         // Just insert a new block before the current block.
-        m_blocks.insert(m_blocks.begin()+block_index, new block(length));
-        blk = m_blocks[block_index];
+        m_blocks.emplace(m_blocks.begin()+block_index, length);
+        blk = &m_blocks[block_index];
         blk->mp_data = element_block_func::create_new_block(cat, 0);
         m_hdl_event.element_block_acquired(blk->mp_data);
         mdds_mtv_assign_values(*blk->mp_data, *it_begin, it_begin, it_end);
@@ -2952,20 +3843,21 @@ void multi_type_vector<_CellBlockFunc, _EventFunc>::insert_cells_to_middle(
     const _T& it_begin, const _T& it_end)
 {
     size_type length = std::distance(it_begin, it_end);
-    block* blk = m_blocks[block_index];
+    block* blk = &m_blocks[block_index];
     element_category_type cat = mdds_mtv_get_element_type(*it_begin);
 
     // Insert two new blocks.
     size_type n1 = row - start_row;
     size_type n2 = blk->m_size - n1;
-    m_blocks.insert(m_blocks.begin()+block_index+1, 2u, nullptr);
+    m_blocks.insert(m_blocks.begin()+block_index+1, 2u, block());
+    blk = &m_blocks[block_index];
     blk->m_size = n1;
 
-    m_blocks[block_index+1] = new block(length);
-    m_blocks[block_index+2] = new block(n2);
+    m_blocks[block_index+1] = block(length);
+    m_blocks[block_index+2] = block(n2);
 
     // block for data series.
-    block* blk2 = m_blocks[block_index+1];
+    block* blk2 = &m_blocks[block_index+1];
     blk2->mp_data = element_block_func::create_new_block(cat, 0);
     m_hdl_event.element_block_acquired(blk2->mp_data);
     mdds_mtv_assign_values(*blk2->mp_data, *it_begin, it_begin, it_end);
@@ -2975,7 +3867,7 @@ void multi_type_vector<_CellBlockFunc, _EventFunc>::insert_cells_to_middle(
         element_category_type blk_cat = mdds::mtv::get_block_type(*blk->mp_data);
 
         // block to hold data from the lower part of the existing block.
-        block* blk3 = m_blocks[block_index+2];
+        block* blk3 = &m_blocks[block_index+2];
         blk3->mp_data = element_block_func::create_new_block(blk_cat, 0);
         m_hdl_event.element_block_acquired(blk3->mp_data);
 
@@ -2993,18 +3885,19 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::set_new_block_to_middle(
 {
     assert(block_index < m_blocks.size());
 
-    block* blk = m_blocks[block_index];
+    block* blk = &m_blocks[block_index];
 
     // First, insert two new blocks at position past the current block.
     size_type lower_block_size = blk->m_size - offset - new_block_size;
-    m_blocks.insert(m_blocks.begin()+block_index+1, 2u, nullptr);
-    m_blocks[block_index+1] = new block(new_block_size); // empty block.
-    m_blocks[block_index+2] = new block(lower_block_size);
+    m_blocks.insert(m_blocks.begin()+block_index+1, 2u, block());
+    m_blocks[block_index+1] = block(new_block_size); // empty block.
+    m_blocks[block_index+2] = block(lower_block_size);
+    blk = &m_blocks[block_index];
 
     if (blk->mp_data)
     {
         size_type lower_data_start = offset + new_block_size;
-        block* blk_lower = m_blocks[block_index+2];
+        block* blk_lower = &m_blocks[block_index+2];
         assert(blk_lower->m_size == lower_block_size);
         element_category_type cat = mtv::get_block_type(*blk->mp_data);
         blk_lower->mp_data = element_block_func::create_new_block(cat, 0);
@@ -3051,8 +3944,7 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::set_new_block_to_middle(
             blk_lower->m_size = offset;
 
             // And now let's swap the blocks...
-            m_blocks[block_index] = blk_lower;
-            m_blocks[block_index+2] = blk;         
+            std::swap(*blk, *blk_lower);
         }
     }
     else
@@ -3061,7 +3953,7 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::set_new_block_to_middle(
         blk->m_size = offset;
     }
     
-    return m_blocks[block_index+1];
+    return &m_blocks[block_index+1];
 }
 
 template<typename _CellBlockFunc, typename _EventFunc>
@@ -3073,7 +3965,7 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::get_previous_block_of_type(
         // No previous block.
         return nullptr;
 
-    block* blk = m_blocks[block_index-1];
+    block* blk = &m_blocks[block_index-1];
     if (blk->mp_data)
         return (cat == mtv::get_block_type(*blk->mp_data)) ? blk : nullptr;
 
@@ -3089,7 +3981,7 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::get_next_block_of_type(
         // No next block.
         return nullptr;
 
-    block* blk = m_blocks[block_index+1];
+    block* blk = &m_blocks[block_index+1];
     if (blk->mp_data)
         return (cat == mtv::get_block_type(*blk->mp_data)) ? blk : nullptr;
 
@@ -3103,7 +3995,7 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::exchange_elements(
     size_type dst_offset, size_type len)
 {
     assert(dst_index < m_blocks.size());
-    block* blk = m_blocks[dst_index];
+    block* blk = &m_blocks[dst_index];
     element_category_type cat_src = mtv::get_block_type(src_data);
     block* blk_next = get_next_block_of_type(dst_index, cat_src);
 
@@ -3130,7 +4022,6 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::exchange_elements(
                 ++it_end;
 
                 assert(!blk->mp_data);
-                delete blk; // no need to call delete_block since mp_data is null.
 
                 if (blk_next)
                 {
@@ -3138,7 +4029,7 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::exchange_elements(
                     element_block_func::append_values_from_block(*blk_prev->mp_data, *blk_next->mp_data);
                     blk_prev->m_size += blk_next->m_size;
                     ++it_end;
-                    delete_block(blk_next);
+                    delete_element_block(blk_next);
                 }
 
                 m_blocks.erase(it, it_end);
@@ -3151,9 +4042,9 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::exchange_elements(
                 // We need to merge with the next block.  Remove the current
                 // block and use the next block to store the new elements as
                 // well as the existing ones.
-                delete_block(blk);
+                delete_element_block(blk);
                 m_blocks.erase(m_blocks.begin()+dst_index);
-                blk = blk_next;
+                blk = &m_blocks[dst_index];
                 element_block_func::prepend_values_from_block(*blk->mp_data, src_data, src_offset, len);
                 blk->m_size += len;
             }
@@ -3193,8 +4084,8 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::exchange_elements(
         else
         {
             // Insert a new block to house the new elements.
-            m_blocks.insert(m_blocks.begin()+dst_index, new block(len));
-            blk = m_blocks[dst_index];
+            m_blocks.emplace(m_blocks.begin()+dst_index, len);
+            blk = &m_blocks[dst_index];
             blk->mp_data = element_block_func::create_new_block(cat_src, 0);
             m_hdl_event.element_block_acquired(blk->mp_data);
             element_block_func::assign_values_from_block(*blk->mp_data, src_data, src_offset, len);
@@ -3233,8 +4124,8 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::exchange_elements(
         else
         {
             // Insert a new block to store the new elements.
-            m_blocks.insert(m_blocks.begin()+dst_index+1, new block(len));
-            blk = m_blocks[dst_index+1];
+            m_blocks.emplace(m_blocks.begin()+dst_index+1, len);
+            blk = &m_blocks[dst_index+1];
             blk->mp_data = element_block_func::create_new_block(cat_src, 0);
             assert(blk->mp_data);
             m_hdl_event.element_block_acquired(blk->mp_data);
@@ -3264,13 +4155,13 @@ bool multi_type_vector<_CellBlockFunc, _EventFunc>::append_empty(size_type len)
     {
         // No existing block. Create a new one.
         assert(m_cur_size == 0);
-        m_blocks.push_back(new block(len));
+        m_blocks.emplace_back(len);
         m_cur_size = len;
         return true;
     }
 
     bool new_block_added = false;
-    block* blk_last = m_blocks.back();
+    block* blk_last = &m_blocks.back();
 
     if (!blk_last->mp_data)
     {
@@ -3280,7 +4171,7 @@ bool multi_type_vector<_CellBlockFunc, _EventFunc>::append_empty(size_type len)
     else
     {
         // Append a new empty block.
-        m_blocks.push_back(new block(len));
+        m_blocks.emplace_back(len);
         new_block_added = true;
     }
 
@@ -3296,14 +4187,14 @@ void multi_type_vector<_CellBlockFunc, _EventFunc>::exchange_elements(
     size_type len, blocks_type& new_blocks)
 {
     assert(dst_index1 < dst_index2);
-    assert(dst_offset1 < m_blocks[dst_index1]->m_size);
-    assert(dst_offset2 < m_blocks[dst_index2]->m_size);
+    assert(dst_offset1 < m_blocks[dst_index1].m_size);
+    assert(dst_offset2 < m_blocks[dst_index2].m_size);
 
     blocks_to_transfer bucket;
     prepare_blocks_to_transfer(bucket, dst_index1, dst_offset1, dst_index2, dst_offset2);
 
-    m_blocks.insert(m_blocks.begin()+bucket.insert_index, new block(len));
-    block* blk = m_blocks[bucket.insert_index];
+    m_blocks.emplace(m_blocks.begin()+bucket.insert_index, len);
+    block* blk = &m_blocks[bucket.insert_index];
     blk->mp_data = element_block_func::create_new_block(mtv::get_block_type(src_data), 0);
     m_hdl_event.element_block_acquired(blk->mp_data);
     element_block_func::assign_values_from_block(*blk->mp_data, src_data, src_offset, len);
@@ -3323,7 +4214,7 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::set_cells_to_single_block(
     assert(!m_blocks.empty());
 
     element_category_type cat = mdds_mtv_get_element_type(*it_begin);
-    block* blk = m_blocks[block_index];
+    block* blk = &m_blocks[block_index];
     size_type data_length = std::distance(it_begin, it_end);
 
     if (blk->mp_data && mdds::mtv::get_block_type(*blk->mp_data) == cat)
@@ -3346,10 +4237,10 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::set_cells_to_single_block(
         if (end_row == end_row_in_block)
         {
             // Check if we could append it to the previous block.
-            size_type offset = block_index > 0 ? m_blocks[block_index-1]->m_size : 0;
+            size_type offset = block_index > 0 ? m_blocks[block_index-1].m_size : 0;
             if (append_to_prev_block(block_index, cat, end_row-start_row+1, it_begin, it_end))
             {
-                delete_block(blk);
+                delete_element_block(blk);
                 m_blocks.erase(m_blocks.begin()+block_index);
 
                 // Check if we need to merge it with the next block.
@@ -3400,14 +4291,14 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::set_cells_to_single_block(
         }
 
         length = end_row - start_row + 1;
-        size_type offset = block_index > 0 ? m_blocks[block_index-1]->m_size : 0;
+        size_type offset = block_index > 0 ? m_blocks[block_index-1].m_size : 0;
         if (append_to_prev_block(block_index, cat, length, it_begin, it_end))
             return get_iterator(block_index-1, start_row_in_block-offset);
 
         // Insert a new block before the current block, and populate it with
         // the new data.
-        m_blocks.insert(m_blocks.begin()+block_index, new block(length));
-        blk = m_blocks[block_index];
+        m_blocks.emplace(m_blocks.begin()+block_index, length);
+        blk = &m_blocks[block_index];
         blk->mp_data = element_block_func::create_new_block(cat, 0);
         m_hdl_event.element_block_acquired(blk->mp_data);
         blk->m_size = length;
@@ -3442,8 +4333,8 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::set_cells_to_single_block(
             }
 
             // Next block has a different data type. Do the normal insertion.
-            m_blocks.insert(m_blocks.begin()+block_index+1, new block(new_size));
-            blk = m_blocks[block_index+1];
+            m_blocks.emplace(m_blocks.begin()+block_index+1, new_size);
+            blk = &m_blocks[block_index+1];
             blk->mp_data = element_block_func::create_new_block(cat, 0);
             m_hdl_event.element_block_acquired(blk->mp_data);
             mdds_mtv_assign_values(*blk->mp_data, *it_begin, it_begin, it_end);
@@ -3453,8 +4344,8 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::set_cells_to_single_block(
         // Last block.
         assert(block_index == m_blocks.size() - 1);
 
-        m_blocks.push_back(new block(new_size));
-        blk = m_blocks.back();
+        m_blocks.emplace_back(new_size);
+        blk = &m_blocks.back();
         blk->mp_data = element_block_func::create_new_block(cat, 0);
         m_hdl_event.element_block_acquired(blk->mp_data);
         mdds_mtv_assign_values(*blk->mp_data, *it_begin, it_begin, it_end);
@@ -3487,7 +4378,7 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::set_cells_to_multi_blocks(
     assert(it_begin != it_end);
     assert(!m_blocks.empty());
 
-    block* blk1 = m_blocks[block_index1];
+    block* blk1 = &m_blocks[block_index1];
     if (blk1->mp_data)
     {
         return set_cells_to_multi_blocks_block1_non_empty(
@@ -3513,8 +4404,8 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::set_cells_to_multi_blocks_block1_
     const _T& it_begin, const _T& it_end)
 {
     element_category_type cat = mdds_mtv_get_element_type(*it_begin);
-    block* blk1 = m_blocks[block_index1];
-    block* blk2 = m_blocks[block_index2];
+    block* blk1 = &m_blocks[block_index1];
+    block* blk2 = &m_blocks[block_index2];
     size_type length = std::distance(it_begin, it_end);
     size_type offset = start_row - start_row_in_block1;
     size_type end_row_in_block2 = start_row_in_block2 + blk2->m_size - 1;
@@ -3526,7 +4417,7 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::set_cells_to_multi_blocks_block1_
     typename blocks_type::iterator it_erase_end = m_blocks.begin() + block_index2;
 
     // Create the new data block first.
-    std::unique_ptr<block> data_blk = make_unique<block>(length);
+    block data_blk(length);
 
     bool blk0_copied = false;
     if (offset == 0)
@@ -3537,15 +4428,15 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::set_cells_to_multi_blocks_block1_
         // Check the type of the previous block (block 0) if exists.
         if (block_index1 > 0)
         {
-            block* blk0 = m_blocks[block_index1-1];
+            block* blk0 = &m_blocks[block_index1-1];
             if (blk0->mp_data && cat == mdds::mtv::get_block_type(*blk0->mp_data))
             {
                 // Transfer the whole data from block 0 to data block.
-                data_blk->mp_data = blk0->mp_data;
+                data_blk.mp_data = blk0->mp_data;
                 blk0->mp_data = nullptr;
 
                 start_row_itr -= blk0->m_size;
-                data_blk->m_size += blk0->m_size;
+                data_blk.m_size += blk0->m_size;
                 --it_erase_begin;
                 blk0_copied = true;
             }
@@ -3565,12 +4456,12 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::set_cells_to_multi_blocks_block1_
     }
 
     if (blk0_copied)
-        mdds_mtv_append_values(*data_blk->mp_data, *it_begin, it_begin, it_end);
+        mdds_mtv_append_values(*data_blk.mp_data, *it_begin, it_begin, it_end);
     else
     {
-        data_blk->mp_data = element_block_func::create_new_block(cat, 0);
-        m_hdl_event.element_block_acquired(data_blk->mp_data);
-        mdds_mtv_assign_values(*data_blk->mp_data, *it_begin, it_begin, it_end);
+        data_blk.mp_data = element_block_func::create_new_block(cat, 0);
+        m_hdl_event.element_block_acquired(data_blk.mp_data);
+        mdds_mtv_assign_values(*data_blk.mp_data, *it_begin, it_begin, it_end);
     }
 
     if (end_row == end_row_in_block2)
@@ -3580,14 +4471,14 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::set_cells_to_multi_blocks_block1_
 
         if (block_index2+1 < m_blocks.size())
         {
-            block* blk3 = m_blocks[block_index2+1];
+            block* blk3 = &m_blocks[block_index2+1];
             if (blk3->mp_data && mdds::mtv::get_block_type(*blk3->mp_data) == cat)
             {
                 // Merge the whole block 3 with the new data. Remove block 3
                 // afterward.  Resize block 3 to zero to prevent invalid free.
-                element_block_func::append_values_from_block(*data_blk->mp_data, *blk3->mp_data);
+                element_block_func::append_values_from_block(*data_blk.mp_data, *blk3->mp_data);
                 element_block_func::resize_block(*blk3->mp_data, 0);
-                data_blk->m_size += blk3->m_size;
+                data_blk.m_size += blk3->m_size;
                 ++it_erase_end;
             }
         }
@@ -3606,9 +4497,9 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::set_cells_to_multi_blocks_block1_
                 size_type copy_pos = end_row - start_row_in_block2 + 1;
                 size_type size_to_copy = end_row_in_block2 - end_row;
                 element_block_func::append_values_from_block(
-                    *data_blk->mp_data, *blk2->mp_data, copy_pos, size_to_copy);
+                    *data_blk.mp_data, *blk2->mp_data, copy_pos, size_to_copy);
                 element_block_func::resize_block(*blk2->mp_data, copy_pos);
-                data_blk->m_size += size_to_copy;
+                data_blk.m_size += size_to_copy;
 
                 ++it_erase_end;
                 erase_upper = false;
@@ -3631,11 +4522,11 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::set_cells_to_multi_blocks_block1_
     size_type insert_pos = std::distance(m_blocks.begin(), it_erase_begin);
 
     // Remove the in-between blocks first.
-    delete_blocks(it_erase_begin, it_erase_end);
+    delete_element_blocks(it_erase_begin, it_erase_end);
     m_blocks.erase(it_erase_begin, it_erase_end);
 
     // Insert the new data block.
-    m_blocks.insert(m_blocks.begin()+insert_pos, data_blk.release());
+    m_blocks.insert(m_blocks.begin()+insert_pos, data_blk);
 
     return get_iterator(insert_pos, start_row_itr);
 }
@@ -3650,13 +4541,13 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::set_cells_to_multi_blocks_block1_
     const _T& it_begin, const _T& it_end)
 {
     element_category_type cat = mdds_mtv_get_element_type(*it_begin);
-    block* blk1 = m_blocks[block_index1];
+    block* blk1 = &m_blocks[block_index1];
     assert(blk1->mp_data);
     element_category_type blk_cat1 = mdds::mtv::get_block_type(*blk1->mp_data);
 
     if (blk_cat1 == cat)
     {
-        block* blk2 = m_blocks[block_index2];
+        block* blk2 = &m_blocks[block_index2];
         size_type length = std::distance(it_begin, it_end);
         size_type offset = start_row - start_row_in_block1;
         size_type end_row_in_block2 = start_row_in_block2 + blk2->m_size - 1;
@@ -3710,8 +4601,14 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::set_cells_to_multi_blocks_block1_
             blk2->m_size -= size_to_erase;
         }
 
-        delete_blocks(it_erase_begin, it_erase_end);
+        bool blk2_erased = end_row == end_row_in_block2;
+        delete_element_blocks(it_erase_begin, it_erase_end);
         m_blocks.erase(it_erase_begin, it_erase_end);
+
+        if (blk2_erased)
+            // The block that followed block 2 may be of the same type.
+            merge_with_next_block(block_index1);
+
         return get_iterator(block_index1, start_row_in_block1);
     }
 
@@ -3729,7 +4626,13 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::merge_with_adjacent_blocks(size_t
 {
     assert(!m_blocks.empty());
     assert(block_index < m_blocks.size());
-    block* blk_prev = block_index > 0 ? m_blocks[block_index-1] : nullptr;
+
+    if (m_edit_sessions && m_blocks[block_index].mp_data)
+        // Merging of non-empty blocks is deferred until the edit session
+        // ends.
+        return 0;
+
+    block* blk_prev = block_index > 0 ? &m_blocks[block_index-1] : nullptr;
 
     if (!blk_prev)
     {
@@ -3739,8 +4642,8 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::merge_with_adjacent_blocks(size_t
     }
 
     size_type size_prev = blk_prev->m_size; // size of previous block.
-    block* blk = m_blocks[block_index];
-    block* blk_next = block_index < (m_blocks.size()-1) ? m_blocks[block_index+1] : nullptr;
+    block* blk = &m_blocks[block_index];
+    block* blk_next = block_index < (m_blocks.size()-1) ? &m_blocks[block_index+1] : nullptr;
 
     // Check the previous block.
     if (blk_prev->mp_data)
@@ -3765,8 +4668,8 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::merge_with_adjacent_blocks(size_t
             element_block_func::resize_block(*blk->mp_data, 0);
             element_block_func::resize_block(*blk_next->mp_data, 0);
 
-            delete_block(blk);
-            delete_block(blk_next);
+            delete_element_block(blk);
+            delete_element_block(blk_next);
 
             typename blocks_type::iterator it = m_blocks.begin();
             std::advance(it, block_index);
@@ -3800,8 +4703,6 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::merge_with_adjacent_blocks(size_t
     {
         // Next block is empty too. Merge all three.
         blk_prev->m_size += blk->m_size + blk_next->m_size;
-        delete blk; // No need to call delete_block since we know it's an empty block.
-        delete blk_next; // Same here.
         typename blocks_type::iterator it = m_blocks.begin();
         std::advance(it, block_index);
         typename blocks_type::iterator it_end = it;
@@ -3829,8 +4730,8 @@ bool multi_type_vector<_CellBlockFunc, _EventFunc>::merge_with_next_block(size_t
         return false;
 
     // Block exists below.
-    block* blk = m_blocks[block_index];
-    block* blk_next = m_blocks[block_index+1];
+    block* blk = &m_blocks[block_index];
+    block* blk_next = &m_blocks[block_index+1];
     if (!blk->mp_data)
     {
         // Empty block. Merge only if the next block is also empty.
@@ -3840,7 +4741,6 @@ bool multi_type_vector<_CellBlockFunc, _EventFunc>::merge_with_next_block(size_t
 
         // Merge the two blocks.
         blk->m_size += blk_next->m_size;
-        delete blk_next; // this block is empty.
         m_blocks.erase(m_blocks.begin()+block_index+1);
         return true;
     }
@@ -3848,6 +4748,11 @@ bool multi_type_vector<_CellBlockFunc, _EventFunc>::merge_with_next_block(size_t
     if (!blk_next->mp_data)
         return false;
 
+    if (m_edit_sessions)
+        // Merging of non-empty blocks is deferred until the edit session
+        // ends.
+        return false;
+
     if (mdds::mtv::get_block_type(*blk->mp_data) != mdds::mtv::get_block_type(*blk_next->mp_data))
         // Block types differ.  Don't merge.
         return false;
@@ -3856,7 +4761,7 @@ bool multi_type_vector<_CellBlockFunc, _EventFunc>::merge_with_next_block(size_t
     element_block_func::append_values_from_block(*blk->mp_data, *blk_next->mp_data);
     element_block_func::resize_block(*blk_next->mp_data, 0);
     blk->m_size += blk_next->m_size;
-    delete_block(blk_next);
+    delete_element_block(blk_next);
     m_blocks.erase(m_blocks.begin()+block_index+1);
     return true;
 }
@@ -3880,9 +4785,17 @@ bool multi_type_vector<_CellBlockFunc, _EventFunc>::append_to_prev_block(
 template<typename _CellBlockFunc, typename _EventFunc>
 void multi_type_vector<_CellBlockFunc, _EventFunc>::clear()
 {
-    delete_blocks(m_blocks.begin(), m_blocks.end());
+    size_type old_size = m_cur_size;
+    element_category_type old_type = old_size ? range_event_type(0, old_size-1) : mtv::element_type_empty;
+
+    delete_element_blocks(m_blocks.begin(), m_blocks.end());
     m_blocks.clear();
     m_cur_size = 0;
+    m_shift = 0;
+    m_maybe_shared.store(false, std::memory_order_relaxed);
+
+    if (old_size)
+        notify_range_changed(mtv::range_change_erased, 0, old_size-1, old_type, mtv::element_type_empty);
 }
 
 template<typename _CellBlockFunc, typename _EventFunc>
@@ -3920,7 +4833,12 @@ void multi_type_vector<_CellBlockFunc, _EventFunc>::resize(size_type new_size)
     if (new_size > m_cur_size)
     {
         // Append empty cells.
-        append_empty(new_size - m_cur_size);
+        size_type block_index = m_blocks.size();
+        size_type start_pos = m_cur_size;
+        if (append_empty(new_size - m_cur_size))
+            update_block_positions(block_index, start_pos);
+        notify_range_changed(
+            mtv::range_change_inserted, start_pos, new_size-1, mtv::element_type_empty, mtv::element_type_empty);
         return;
     }
 
@@ -3928,11 +4846,15 @@ void multi_type_vector<_CellBlockFunc, _EventFunc>::resize(size_type new_size)
 
     // Find out in which block the new end row will be.
     size_type new_end_row = new_size - 1;
+    unshare_blocks(new_end_row, new_end_row);
     size_type start_row_in_block = 0, block_index = 0;
     if (!get_block_position(new_end_row, start_row_in_block, block_index))
         detail::throw_block_position_not_found("multi_type_vector::resize", __LINE__, new_end_row, block_size(), size());
 
-    block* blk = m_blocks[block_index];
+    size_type old_end_row = m_cur_size - 1;
+    element_category_type old_type = range_event_type(new_size, old_end_row);
+
+    block* blk = &m_blocks[block_index];
     size_type end_row_in_block = start_row_in_block + blk->m_size - 1;
 
     if (new_end_row < end_row_in_block)
@@ -3948,16 +4870,24 @@ void multi_type_vector<_CellBlockFunc, _EventFunc>::resize(size_type new_size)
     }
 
     // Remove all blocks that are below this one.
+    prepare_block_positions(block_index+1);
     typename blocks_type::iterator it = m_blocks.begin() + block_index + 1;
-    delete_blocks(it, m_blocks.end());
+    delete_element_blocks(it, m_blocks.end());
     m_blocks.erase(it, m_blocks.end());
     m_cur_size = new_size;
+    apply_position_shift();
+    notify_range_changed(mtv::range_change_erased, new_size, old_end_row, old_type, mtv::element_type_empty);
 }
 
 template<typename _CellBlockFunc, typename _EventFunc>
 void multi_type_vector<_CellBlockFunc, _EventFunc>::swap(multi_type_vector& other)
 {
     std::swap(m_cur_size, other.m_cur_size);
+    std::swap(m_shift, other.m_shift);
+    std::swap(m_shift_index, other.m_shift_index);
+    bool maybe_shared = m_maybe_shared.load(std::memory_order_relaxed);
+    m_maybe_shared.store(other.m_maybe_shared.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    other.m_maybe_shared.store(maybe_shared, std::memory_order_relaxed);
     m_blocks.swap(other.m_blocks);
 }
 
@@ -3972,6 +4902,9 @@ void multi_type_vector<_CellBlockFunc, _EventFunc>::swap(size_type start_pos, si
     if (end_pos >= m_cur_size || other_end_pos >= other.m_cur_size)
         throw std::out_of_range("multi_type_vector::swap: end position is out of bound!");
 
+    unshare_blocks(start_pos, end_pos);
+    other.unshare_blocks(other_pos, other_end_pos);
+
     size_type start_pos1 = 0;
     size_type block_index1 = 0;
     if (!get_block_position(start_pos, start_pos1, block_index1))
@@ -3998,10 +4931,27 @@ void multi_type_vector<_CellBlockFunc, _EventFunc>::swap(size_type start_pos, si
     other.dump_blocks(os_prev_block_other);
 #endif
 
+    element_category_type old_type = range_event_type(start_pos1, block_index1, end_pos);
+    element_category_type other_old_type = other.range_event_type(dest_start_pos1, dest_block_index1, other_end_pos);
+
+    prepare_block_positions(block_index1);
+    other.prepare_block_positions(dest_block_index1);
     swap_impl(
         other, start_pos, end_pos, other_pos, start_pos1, block_index1, start_pos2, block_index2,
         dest_start_pos1, dest_block_index1, dest_start_pos2, dest_block_index2);
 
+    update_block_positions(block_index1, end_pos+1);
+    other.update_block_positions(dest_block_index1, other_end_pos+1);
+
+    // The swapped blocks may not have been merged yet.
+    if (m_edit_sessions && !other.m_edit_sessions)
+        other.merge_all_blocks();
+    else if (other.m_edit_sessions && !m_edit_sessions)
+        merge_all_blocks();
+
+    notify_range_changed(mtv::range_change_modified, start_pos, end_pos, old_type, other_old_type);
+    other.notify_range_changed(mtv::range_change_modified, other_pos, other_end_pos, other_old_type, old_type);
+
 #ifdef MDDS_MULTI_TYPE_VECTOR_DEBUG
     if (!check_block_integrity() || !other.check_block_integrity())
     {
@@ -4021,13 +4971,28 @@ void multi_type_vector<_CellBlockFunc, _EventFunc>::shrink_to_fit()
     typename blocks_type::iterator it = m_blocks.begin(), it_end = m_blocks.end();
     for (; it != it_end; ++it)
     {
-        block* blk = *it;
+        block* blk = &*it;
         assert(blk);
-        if (blk->mp_data)
+        // Shared blocks are left alone, as other containers may be
+        // reading from them.
+        if (blk->mp_data && !mtv::detail::is_block_shared(*blk->mp_data))
             element_block_func::shrink_to_fit(*blk->mp_data);
     }
 }
 
+template<typename _CellBlockFunc, typename _EventFunc>
+void multi_type_vector<_CellBlockFunc, _EventFunc>::enable_block_cache(bool enable)
+{
+    m_block_cache.enabled = enable;
+    m_block_cache.index.store(0, std::memory_order_relaxed);
+}
+
+template<typename _CellBlockFunc, typename _EventFunc>
+bool multi_type_vector<_CellBlockFunc, _EventFunc>::block_cache_enabled() const
+{
+    return m_block_cache.enabled;
+}
+
 template<typename _CellBlockFunc, typename _EventFunc>
 bool multi_type_vector<_CellBlockFunc, _EventFunc>::operator== (const multi_type_vector& other) const
 {
@@ -4047,8 +5012,8 @@ bool multi_type_vector<_CellBlockFunc, _EventFunc>::operator== (const multi_type
     typename blocks_type::const_iterator it2 = other.m_blocks.begin();
     for (; it != it_end; ++it, ++it2)
     {
-        const block* blk1 = *it;
-        const block* blk2 = *it2;
+        const block* blk1 = &*it;
+        const block* blk2 = &*it2;
 
         if (blk1->m_size != blk2->m_size)
             // Block sizes differ.
@@ -4074,6 +5039,10 @@ bool multi_type_vector<_CellBlockFunc, _EventFunc>::operator== (const multi_type
         }
 
         assert(blk1->mp_data && blk2->mp_data);
+        if (blk1->mp_data == blk2->mp_data)
+            // Shared block.
+            continue;
+
         if (!element_block_func::equal_block(*blk1->mp_data, *blk2->mp_data))
             return false;
     }
@@ -4087,6 +5056,27 @@ bool multi_type_vector<_CellBlockFunc, _EventFunc>::operator!= (const multi_type
     return !operator== (other);
 }
 
+template<typename _CellBlockFunc, typename _EventFunc>
+size_t multi_type_vector<_CellBlockFunc, _EventFunc>::fingerprint() const
+{
+    size_t h = 0;
+    typename blocks_type::const_iterator it = m_blocks.begin(), it_end = m_blocks.end();
+    for (; it != it_end; ++it)
+    {
+        h = mtv::detail::hash_combine(h, it->m_size);
+        if (!it->mp_data)
+        {
+            h = mtv::detail::hash_combine(h, mtv::element_type_empty);
+            continue;
+        }
+
+        h = mtv::detail::hash_combine(h, mtv::get_block_type(*it->mp_data));
+        h = mtv::detail::hash_combine(h, element_block_func::hash_block(*it->mp_data));
+    }
+
+    return h;
+}
+
 template<typename _CellBlockFunc, typename _EventFunc>
 multi_type_vector<_CellBlockFunc, _EventFunc>& multi_type_vector<_CellBlockFunc, _EventFunc>::operator= (const multi_type_vector& other)
 {
@@ -4095,6 +5085,62 @@ multi_type_vector<_CellBlockFunc, _EventFunc>& multi_type_vector<_CellBlockFunc,
     return *this;
 }
 
+template<typename _CellBlockFunc, typename _EventFunc>
+multi_type_vector<_CellBlockFunc, _EventFunc>& multi_type_vector<_CellBlockFunc, _EventFunc>::operator= (multi_type_vector&& other) noexcept
+{
+    if (this == &other)
+        return *this;
+
+    delete_element_blocks(m_blocks.begin(), m_blocks.end());
+    m_hdl_event = std::move(other.m_hdl_event);
+    m_blocks = std::move(other.m_blocks);
+    m_cur_size = other.m_cur_size;
+    m_shift = other.m_shift;
+    m_shift_index = other.m_shift_index;
+    m_maybe_shared.store(other.m_maybe_shared.load(std::memory_order_relaxed), std::memory_order_relaxed);
+
+    other.m_blocks.clear();
+    other.m_cur_size = 0;
+    other.m_shift = 0;
+    other.m_maybe_shared.store(false, std::memory_order_relaxed);
+    return *this;
+}
+
+template<typename _CellBlockFunc, typename _EventFunc>
+multi_type_vector<_CellBlockFunc, _EventFunc> multi_type_vector<_CellBlockFunc, _EventFunc>::snapshot() const
+{
+    multi_type_vector ret;
+    ret.m_blocks = m_blocks;
+    ret.m_cur_size = m_cur_size;
+    ret.m_shift = m_shift;
+    ret.m_shift_index = m_shift_index;
+    ret.m_maybe_shared.store(true, std::memory_order_relaxed);
+    m_maybe_shared.store(true, std::memory_order_relaxed);
+
+    std::for_each(ret.m_blocks.begin(), ret.m_blocks.end(),
+        [](const block& blk)
+        {
+            if (blk.mp_data)
+                mtv::detail::add_block_ref(*blk.mp_data);
+        }
+    );
+
+    std::for_each(ret.m_blocks.begin(), ret.m_blocks.end(),
+        [&](const block& blk)
+        {
+            if (blk.mp_data)
+                ret.m_hdl_event.element_block_acquired(blk.mp_data);
+        }
+    );
+
+    // The snapshot is not in the session this container may be in.
+    // Merging unshares the blocks it modifies.
+    if (m_edit_sessions)
+        ret.merge_all_blocks();
+
+    return ret;
+}
+
 template<typename _CellBlockFunc, typename _EventFunc>
 template<typename _T>
 mtv::element_t multi_type_vector<_CellBlockFunc, _EventFunc>::get_element_type(const _T& elem)
@@ -4107,7 +5153,7 @@ typename multi_type_vector<_CellBlockFunc, _EventFunc>::iterator
 multi_type_vector<_CellBlockFunc, _EventFunc>::set_whole_block_empty(
     size_type block_index, size_type start_pos_in_block, bool overwrite)
 {
-    block* blk = m_blocks[block_index];
+    block* blk = &m_blocks[block_index];
     if (!overwrite)
         // Resize block to 0 before deleting, to prevent its elements from getting deleted.
         element_block_func::resize_block(*blk->mp_data, 0);
@@ -4127,8 +5173,8 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::set_whole_block_empty(
             blk_prev->m_size += blk->m_size + blk_next->m_size;
 
             // Erase the current and next blocks.
-            delete_block(blk);
-            delete_block(blk_next);
+            delete_element_block(blk);
+            delete_element_block(blk_next);
 
             typename blocks_type::iterator it = m_blocks.begin();
             std::advance(it, block_index);
@@ -4142,7 +5188,7 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::set_whole_block_empty(
         // Only the preceding block is empty. Merge the current block with the previous.
         size_type offset = blk_prev->m_size;
         blk_prev->m_size += blk->m_size;
-        delete_block(blk);
+        delete_element_block(blk);
         typename blocks_type::iterator it = m_blocks.begin();
         std::advance(it, block_index);
         m_blocks.erase(it);
@@ -4153,7 +5199,7 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::set_whole_block_empty(
     {
         // Only the next block is empty. Merge the next block with the current.
         blk->m_size += blk_next->m_size;
-        delete_block(blk_next);
+        delete_element_block(blk_next);
         typename blocks_type::iterator it = m_blocks.begin();
         std::advance(it, block_index+1);
         m_blocks.erase(it);
@@ -4170,7 +5216,7 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::set_empty_in_single_block(
     size_type start_row, size_type end_row, size_type block_index, size_type start_row_in_block, bool overwrite)
 {
     // Range is within a single block.
-    block* blk = m_blocks[block_index];
+    block* blk = &m_blocks[block_index];
     if (!blk->mp_data)
         // This block is already empty.  Do nothing.
         return get_iterator(block_index, start_row_in_block);
@@ -4203,7 +5249,7 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::set_empty_in_single_block(
         }
 
         // Insert a new empty block before the current one.
-        m_blocks.insert(m_blocks.begin()+block_index, new block(empty_block_size));
+        m_blocks.emplace(m_blocks.begin()+block_index, empty_block_size);
         return get_iterator(block_index, start_row_in_block);
     }
 
@@ -4226,7 +5272,7 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::set_empty_in_single_block(
             blk_next->m_size += empty_block_size;
         else
             // Insert a new empty block after the current one.
-            m_blocks.insert(m_blocks.begin()+block_index+1, new block(empty_block_size));
+            m_blocks.emplace(m_blocks.begin()+block_index+1, empty_block_size);
 
         return get_iterator(block_index+1, start_row);
     }
@@ -4249,7 +5295,7 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::set_empty_in_multi_blocks(
 
     {
         // Empty the lower part of the first block.
-        block* blk = m_blocks[block_index1];
+        block* blk = &m_blocks[block_index1];
         if (blk->mp_data)
         {
             if (start_row_in_block1 == start_row)
@@ -4260,7 +5306,7 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::set_empty_in_multi_blocks(
                 block* blk_prev = nullptr;
                 if (block_index1 > 0)
                 {
-                    blk_prev = m_blocks[block_index1-1];
+                    blk_prev = &m_blocks[block_index1-1];
                     if (blk_prev->mp_data)
                         // Not empty.  Ignore it.
                         blk_prev = nullptr;
@@ -4306,7 +5352,7 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::set_empty_in_multi_blocks(
 
     {
         // Empty the upper part of the last block.
-        block* blk = m_blocks[block_index2];
+        block* blk = &m_blocks[block_index2];
         size_type last_row_in_block = start_row_in_block2 + blk->m_size - 1;
         if (blk->mp_data)
         {
@@ -4319,7 +5365,7 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::set_empty_in_multi_blocks(
                 block* blk_next = nullptr;
                 if (block_index2+1 < m_blocks.size())
                 {
-                    blk_next = m_blocks[block_index2+1];
+                    blk_next = &m_blocks[block_index2+1];
                     if (blk_next->mp_data)
                         // Not empty.  Ignore it.
                         blk_next = nullptr;
@@ -4358,11 +5404,11 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::set_empty_in_multi_blocks(
 
         for (size_type i = block_index1 + 1; i < end_block_to_erase; ++i)
         {
-            block* blk = m_blocks[i];
+            block* blk = &m_blocks[i];
             if (!overwrite && blk->mp_data)
                 element_block_func::resize_block(*blk->mp_data, 0);
 
-            delete_block(blk);
+            delete_element_block(blk);
         }
 
         typename blocks_type::iterator it = m_blocks.begin() + block_index1 + 1;
@@ -4370,12 +5416,12 @@ multi_type_vector<_CellBlockFunc, _EventFunc>::set_empty_in_multi_blocks(
         m_blocks.erase(it, it_end);
     }
 
-    block* blk = m_blocks[block_index1];
+    block* blk = &m_blocks[block_index1];
     size_type empty_block_size = end_row - start_row + 1;
     if (blk->mp_data)
     {
         // Insert a new empty block after the first block.
-        m_blocks.insert(m_blocks.begin()+block_index1+1, new block(empty_block_size));
+        m_blocks.emplace(m_blocks.begin()+block_index1+1, empty_block_size);
         return get_iterator(block_index1+1, start_row);
     }
 
@@ -4391,11 +5437,11 @@ void multi_type_vector<_CellBlockFunc, _EventFunc>::dump_blocks(std::ostream& os
     os << "--- blocks" << endl;
     for (size_type i = 0, n = m_blocks.size(); i < n; ++i)
     {
-        block* blk = m_blocks[i];
+        const block* blk = &m_blocks[i];
         element_category_type cat = mtv::element_type_empty;
         if (blk->mp_data)
             cat = mtv::get_block_type(*blk->mp_data);
-        os << "  block " << i << ": size=" << blk->m_size << " type=" << cat << endl;
+        os << "  block " << i << ": position=" << block_position(i) << " size=" << blk->m_size << " type=" << cat << endl;
     }
 }
 
@@ -4406,16 +5452,10 @@ bool multi_type_vector<_CellBlockFunc, _EventFunc>::check_block_integrity() cons
         // Nothing to check.
         return true;
 
-    if (m_blocks.size() == 1 && !m_blocks[0])
-    {
-        cerr << "block should never be null!" << endl;
-        return false;
-    }
-
-    const block* blk_prev = m_blocks[0];
-    if (!blk_prev)
+    const block* blk_prev = &m_blocks[0];
+    if (!blk_prev->m_size)
     {
-        cerr << "block should never be null!" << endl;
+        cerr << "block should never be zero sized!" << endl;
         return false;
     }
 
@@ -4423,13 +5463,28 @@ bool multi_type_vector<_CellBlockFunc, _EventFunc>::check_block_integrity() cons
     if (blk_prev->mp_data)
         cat_prev = mtv::get_block_type(*blk_prev->mp_data);
 
+    if (block_position(0) != 0)
+    {
+        cerr << "The first block should always start at position 0." << endl;
+        dump_blocks(cerr);
+        return false;
+    }
+
     size_type total_size = blk_prev->m_size;
     for (size_type i = 1, n = m_blocks.size(); i < n; ++i)
     {
-        block* blk = m_blocks[i];
-        if (!blk)
+        const block* blk = &m_blocks[i];
+        if (!blk->m_size)
+        {
+            cerr << "block should never be zero sized!" << endl;
+            return false;
+        }
+
+        if (block_position(i) != total_size)
         {
-            cerr << "block should never be null!" << endl;
+            cerr << "Block position is incorrect." << endl;
+            cerr << "block " << i << ": stored position=" << block_position(i) << " expected position=" << total_size << endl;
+            dump_blocks(cerr);
             return false;
         }
 
@@ -4437,7 +5492,7 @@ bool multi_type_vector<_CellBlockFunc, _EventFunc>::check_block_integrity() cons
         if (blk->mp_data)
             cat = mtv::get_block_type(*blk->mp_data);
 
-        if (cat_prev == cat)
+        if (cat_prev == cat && (cat == mtv::element_type_empty || !m_edit_sessions))
         {
             cerr << "Two adjacent blocks should never be of the same type." << endl;
             dump_blocks(cerr);
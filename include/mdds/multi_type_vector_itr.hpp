@@ -29,6 +29,7 @@
 #define MDDS_MULTI_TYPE_VECTOR_ITR_HPP
 
 #include "multi_type_vector_types.hpp"
+#include "multi_type_vector/element_span.hpp"
 
 #include <cstddef>
 
@@ -57,6 +58,8 @@ struct iterator_value_node
     iterator_value_node(const iterator_value_node& other) :
         type(other.type), position(other.position), size(other.size), data(other.data), __private_data(other.__private_data) {}
 
+    iterator_value_node& operator= (const iterator_value_node&) = default;
+
     void swap(iterator_value_node& other)
     {
         std::swap(type, other.type);
@@ -67,6 +70,27 @@ struct iterator_value_node
         __private_data.swap(other.__private_data);
     }
 
+    /**
+     * Get a read-only view of all elements of the block this node refers
+     * to, without copying them.  The caller must specify the type of the
+     * element block as the template parameter, and the block must store
+     * its elements contiguously.
+     *
+     * <p>The method will throw an <code>mdds::mtv::element_block_error</code>
+     * exception if the block is empty or is of a different type.</p>
+     *
+     * @return span referencing all elements of the block.
+     */
+    template<typename _Blk>
+    mdds::mtv::element_span<const typename _Blk::value_type> get_span() const
+    {
+        if (!data || type != _Blk::block_type)
+            throw mdds::mtv::element_block_error("iterator_value_node::get_span: block is not of the requested type.");
+
+        const mdds::mtv::base_element_block& blk = *data;
+        return mdds::mtv::element_span<const typename _Blk::value_type>(_Blk::data(blk), size);
+    }
+
     struct private_data
     {
         size_type block_index;
@@ -167,15 +191,15 @@ protected:
         if (m_pos == m_end)
             throw general_error("Current node position should never equal the end position during node update.");
 #endif
-        // blocks_type::value_type is a pointer to multi_type_vector::block.
-        typename blocks_type::value_type blk = *m_pos;
-        if (blk->mp_data)
-            m_cur_node.type = mdds::mtv::get_block_type(*blk->mp_data);
+        // blocks_type::value_type is multi_type_vector::block.
+        const typename blocks_type::value_type& blk = *m_pos;
+        if (blk.mp_data)
+            m_cur_node.type = mdds::mtv::get_block_type(*blk.mp_data);
         else
             m_cur_node.type = mdds::mtv::element_type_empty;
 
-        m_cur_node.size = blk->m_size;
-        m_cur_node.data = blk->mp_data;
+        m_cur_node.size = blk.m_size;
+        m_cur_node.data = blk.mp_data;
     }
 
     node* inc()
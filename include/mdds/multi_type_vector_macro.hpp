@@ -45,6 +45,11 @@ inline void mdds_mtv_set_value(mdds::mtv::base_element_block& block, size_t pos,
     _block_::set_value(block, pos, val); \
 } \
  \
+inline void mdds_mtv_set_value(mdds::mtv::base_element_block& block, size_t pos, _type_&& val) \
+{ \
+    _block_::set_value(block, pos, std::move(val)); \
+} \
+ \
 inline void mdds_mtv_get_value(const mdds::mtv::base_element_block& block, size_t pos, _type_& val) \
 { \
     _block_::get_value(block, pos, val); \
@@ -62,11 +67,21 @@ inline void mdds_mtv_append_value(mdds::mtv::base_element_block& block, const _t
     _block_::append_value(block, val); \
 } \
  \
+inline void mdds_mtv_append_value(mdds::mtv::base_element_block& block, _type_&& val) \
+{ \
+    _block_::append_value(block, std::move(val)); \
+} \
+ \
 inline void mdds_mtv_prepend_value(mdds::mtv::base_element_block& block, const _type_& val) \
 { \
     _block_::prepend_value(block, val); \
 } \
  \
+inline void mdds_mtv_prepend_value(mdds::mtv::base_element_block& block, _type_&& val) \
+{ \
+    _block_::prepend_value(block, std::move(val)); \
+} \
+ \
 template<typename _Iter> \
 void mdds_mtv_prepend_values(mdds::mtv::base_element_block& block, const _type_&, const _Iter& it_begin, const _Iter& it_end) \
 { \
@@ -97,6 +112,11 @@ inline mdds::mtv::base_element_block* mdds_mtv_create_new_block(size_t init_size
     return _block_::create_block_with_value(init_size, val); \
 } \
  \
+inline mdds::mtv::base_element_block* mdds_mtv_create_new_block(size_t init_size, _type_&& val) \
+{ \
+    return _block_::create_block_with_value(init_size, std::move(val)); \
+} \
+ \
 template<typename _Iter> \
 mdds::mtv::base_element_block* mdds_mtv_create_new_block(const _type_&, const _Iter& it_begin, const _Iter& it_end) \
 { \
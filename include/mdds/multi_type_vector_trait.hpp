@@ -34,623 +34,304 @@
 
 namespace mdds { namespace mtv {
 
-struct element_block_func_base
+namespace detail {
+
+/**
+ * Dispatch each block operation to the block type among _Blocks whose
+ * block_type matches the type of the block being operated on, and pass it
+ * on to _Fallback when none of them match.  The chain of comparisons gets
+ * generated at compile time and inlined into the caller, so the block
+ * types need not be enumerated by hand, and there is no limit on their
+ * number.
+ */
+template<typename _Fallback, typename... _Blocks>
+struct block_funcs_dispatch;
+
+template<typename _Fallback>
+struct block_funcs_dispatch<_Fallback> : public _Fallback {};
+
+template<typename _Fallback, typename _Block, typename... _Rest>
+struct block_funcs_dispatch<_Fallback, _Block, _Rest...>
 {
-    inline static base_element_block* create_new_block(element_t type, size_t init_size);
+    typedef block_funcs_dispatch<_Fallback, _Rest...> next_type;
 
-    inline static base_element_block* clone_block(const base_element_block& block);
+    static base_element_block* create_new_block(element_t type, size_t init_size)
+    {
+        if (type == _Block::block_type)
+            return _Block::create_block(init_size);
 
-    inline static void delete_block(const base_element_block* p);
+        return next_type::create_new_block(type, init_size);
+    }
 
-    inline static void resize_block(base_element_block& block, size_t new_size);
+    static base_element_block* clone_block(const base_element_block& block)
+    {
+        if (get_block_type(block) == _Block::block_type)
+            return _Block::clone_block(block);
 
-    inline static void print_block(const base_element_block& block);
+        return next_type::clone_block(block);
+    }
 
-    inline static void erase(base_element_block& block, size_t pos);
+    static void delete_block(const base_element_block* p)
+    {
+        if (get_block_type(*p) == _Block::block_type)
+            _Block::delete_block(p);
+        else
+            next_type::delete_block(p);
+    }
 
-    inline static void erase(base_element_block& block, size_t pos, size_t size);
+    static void resize_block(base_element_block& block, size_t new_size)
+    {
+        if (get_block_type(block) == _Block::block_type)
+            _Block::resize_block(block, new_size);
+        else
+            next_type::resize_block(block, new_size);
+    }
 
-    inline static void append_values_from_block(base_element_block& dest, const base_element_block& src);
+    static void print_block(const base_element_block& block)
+    {
+        if (get_block_type(block) == _Block::block_type)
+            _Block::print_block(block);
+        else
+            next_type::print_block(block);
+    }
 
-    inline static void append_values_from_block(
-        base_element_block& dest, const base_element_block& src, size_t begin_pos, size_t len);
+    static void erase(base_element_block& block, size_t pos)
+    {
+        if (get_block_type(block) == _Block::block_type)
+            _Block::erase_block(block, pos);
+        else
+            next_type::erase(block, pos);
+    }
 
-    inline static void assign_values_from_block(
-        base_element_block& dest, const base_element_block& src, size_t begin_pos, size_t len);
+    static void erase(base_element_block& block, size_t pos, size_t size)
+    {
+        if (get_block_type(block) == _Block::block_type)
+            _Block::erase_block(block, pos, size);
+        else
+            next_type::erase(block, pos, size);
+    }
 
-    inline static void prepend_values_from_block(
-        base_element_block& dest, const base_element_block& src, size_t begin_pos, size_t len);
+    static void append_values_from_block(base_element_block& dest, const base_element_block& src)
+    {
+        if (get_block_type(dest) == _Block::block_type)
+            _Block::append_values_from_block(dest, src);
+        else
+            next_type::append_values_from_block(dest, src);
+    }
 
-    inline static void swap_values(
-        base_element_block& blk1, base_element_block& blk2, size_t pos1, size_t pos2, size_t len);
+    static void append_values_from_block(
+        base_element_block& dest, const base_element_block& src, size_t begin_pos, size_t len)
+    {
+        if (get_block_type(dest) == _Block::block_type)
+            _Block::append_values_from_block(dest, src, begin_pos, len);
+        else
+            next_type::append_values_from_block(dest, src, begin_pos, len);
+    }
 
-    inline static bool equal_block(const base_element_block& left, const base_element_block& right);
+    static void assign_values_from_block(
+        base_element_block& dest, const base_element_block& src, size_t begin_pos, size_t len)
+    {
+        if (get_block_type(dest) == _Block::block_type)
+            _Block::assign_values_from_block(dest, src, begin_pos, len);
+        else
+            next_type::assign_values_from_block(dest, src, begin_pos, len);
+    }
 
-    /**
-     * This method gets called when cell values are being overwritten by new
-     * values.  This provides the client code an opportunity to delete
-     * overwritten instances in case the block stores pointers to managed
-     * objects.  For blocks that don't need to manage their stored objects (or
-     * store primitive values), this method can be left empty.
-     */
-    inline static void overwrite_values(base_element_block& block, size_t pos, size_t len);
+    static void prepend_values_from_block(
+        base_element_block& dest, const base_element_block& src, size_t begin_pos, size_t len)
+    {
+        if (get_block_type(dest) == _Block::block_type)
+            _Block::prepend_values_from_block(dest, src, begin_pos, len);
+        else
+            next_type::prepend_values_from_block(dest, src, begin_pos, len);
+    }
 
-    inline static void shrink_to_fit(base_element_block& block);
+    static void swap_values(
+        base_element_block& blk1, base_element_block& blk2, size_t pos1, size_t pos2, size_t len)
+    {
+        if (get_block_type(blk1) == _Block::block_type)
+            _Block::swap_values(blk1, blk2, pos1, pos2, len);
+        else
+            next_type::swap_values(blk1, blk2, pos1, pos2, len);
+    }
+
+    static bool equal_block(const base_element_block& left, const base_element_block& right)
+    {
+        if (get_block_type(left) == _Block::block_type)
+        {
+            if (get_block_type(right) != _Block::block_type)
+                return false;
+
+            return _Block::get(left) == _Block::get(right);
+        }
+        else if (get_block_type(right) == _Block::block_type)
+            return false;
+
+        return next_type::equal_block(left, right);
+    }
+
+    static size_t hash_block(const base_element_block& block)
+    {
+        if (get_block_type(block) == _Block::block_type)
+            return _Block::hash(block);
+
+        return next_type::hash_block(block);
+    }
+
+    static size_t match_length(
+        const base_element_block& left, size_t left_pos,
+        const base_element_block& right, size_t right_pos, size_t len, bool equal)
+    {
+        if (get_block_type(left) == _Block::block_type)
+            return _Block::match_length(left, left_pos, right, right_pos, len, equal);
+
+        return next_type::match_length(left, left_pos, right, right_pos, len, equal);
+    }
+
+    static void overwrite_values(base_element_block& block, size_t pos, size_t len)
+    {
+        if (get_block_type(block) == _Block::block_type)
+            _Block::overwrite_values(block, pos, len);
+        else
+            next_type::overwrite_values(block, pos, len);
+    }
+
+    static void shrink_to_fit(base_element_block& block)
+    {
+        if (get_block_type(block) == _Block::block_type)
+            _Block::shrink_to_fit(block);
+        else
+            next_type::shrink_to_fit(block);
+    }
 };
 
-base_element_block* element_block_func_base::create_new_block(element_t type, size_t init_size)
+/**
+ * End of the dispatch chain of the standard block types.  Getting here
+ * means that the block is of a type that no block function knows about.
+ */
+struct unknown_block_funcs
 {
-    switch (type)
-    {
-        case element_type_numeric:
-            return numeric_element_block::create_block(init_size);
-        case element_type_string:
-            return string_element_block::create_block(init_size);
-        case element_type_short:
-            return short_element_block::create_block(init_size);
-        case element_type_ushort:
-            return ushort_element_block::create_block(init_size);
-        case element_type_int:
-            return int_element_block::create_block(init_size);
-        case element_type_uint:
-            return uint_element_block::create_block(init_size);
-        case element_type_long:
-            return long_element_block::create_block(init_size);
-        case element_type_ulong:
-            return ulong_element_block::create_block(init_size);
-        case element_type_boolean:
-            return boolean_element_block::create_block(init_size);
-        case element_type_char:
-            return char_element_block::create_block(init_size);
-        case element_type_uchar:
-            return uchar_element_block::create_block(init_size);
-        default:
-            throw general_error("create_new_block: failed to create a new block of unknown type.");
+    static base_element_block* create_new_block(element_t, size_t)
+    {
+        throw general_error("create_new_block: failed to create a new block of unknown type.");
     }
-}
 
-base_element_block* element_block_func_base::clone_block(const base_element_block& block)
-{
-    switch (get_block_type(block))
-    {
-        case element_type_numeric:
-            return numeric_element_block::clone_block(block);
-        case element_type_string:
-            return string_element_block::clone_block(block);
-        case element_type_short:
-            return short_element_block::clone_block(block);
-        case element_type_ushort:
-            return ushort_element_block::clone_block(block);
-        case element_type_int:
-            return int_element_block::clone_block(block);
-        case element_type_uint:
-            return uint_element_block::clone_block(block);
-        case element_type_long:
-            return long_element_block::clone_block(block);
-        case element_type_ulong:
-            return ulong_element_block::clone_block(block);
-        case element_type_boolean:
-            return boolean_element_block::clone_block(block);
-        case element_type_char:
-            return char_element_block::clone_block(block);
-        case element_type_uchar:
-            return uchar_element_block::clone_block(block);
-        default:
-            throw general_error("clone_block: failed to clone a block of unknown type.");
+    static base_element_block* clone_block(const base_element_block&)
+    {
+        throw general_error("clone_block: failed to clone a block of unknown type.");
     }
-}
 
-void element_block_func_base::delete_block(const base_element_block* p)
-{
-    if (!p)
-        return;
-
-    switch (get_block_type(*p))
-    {
-        case element_type_numeric:
-            numeric_element_block::delete_block(p);
-        break;
-        case element_type_string:
-            string_element_block::delete_block(p);
-        break;
-        case element_type_short:
-            short_element_block::delete_block(p);
-        break;
-        case element_type_ushort:
-            ushort_element_block::delete_block(p);
-        break;
-        case element_type_int:
-            int_element_block::delete_block(p);
-        break;
-        case element_type_uint:
-            uint_element_block::delete_block(p);
-        break;
-        case element_type_long:
-            long_element_block::delete_block(p);
-        break;
-        case element_type_ulong:
-            ulong_element_block::delete_block(p);
-        break;
-        case element_type_boolean:
-            boolean_element_block::delete_block(p);
-        break;
-        case element_type_char:
-            char_element_block::delete_block(p);
-        break;
-        case element_type_uchar:
-            uchar_element_block::delete_block(p);
-        break;
-        default:
-            throw general_error("delete_block: failed to delete a block of unknown type.");
+    static void delete_block(const base_element_block*)
+    {
+        throw general_error("delete_block: failed to delete a block of unknown type.");
     }
-}
 
-void element_block_func_base::resize_block(base_element_block& block, size_t new_size)
-{
-    switch (get_block_type(block))
-    {
-        case element_type_numeric:
-            numeric_element_block::resize_block(block, new_size);
-        break;
-        case element_type_string:
-            string_element_block::resize_block(block, new_size);
-        break;
-        case element_type_short:
-            short_element_block::resize_block(block, new_size);
-        break;
-        case element_type_ushort:
-            ushort_element_block::resize_block(block, new_size);
-        break;
-        case element_type_int:
-            int_element_block::resize_block(block, new_size);
-        break;
-        case element_type_uint:
-            uint_element_block::resize_block(block, new_size);
-        break;
-        case element_type_long:
-            long_element_block::resize_block(block, new_size);
-        break;
-        case element_type_ulong:
-            ulong_element_block::resize_block(block, new_size);
-        break;
-        case element_type_boolean:
-            boolean_element_block::resize_block(block, new_size);
-        break;
-        case element_type_char:
-            char_element_block::resize_block(block, new_size);
-        break;
-        case element_type_uchar:
-            uchar_element_block::resize_block(block, new_size);
-        break;
-        default:
-            throw general_error("resize_block: failed to resize a block of unknown type.");
+    static void resize_block(base_element_block&, size_t)
+    {
+        throw general_error("resize_block: failed to resize a block of unknown type.");
     }
-}
 
-void element_block_func_base::print_block(const base_element_block& block)
-{
-    switch (get_block_type(block))
-    {
-        case element_type_numeric:
-            numeric_element_block::print_block(block);
-        break;
-        case element_type_string:
-            string_element_block::print_block(block);
-        break;
-        case element_type_short:
-            short_element_block::print_block(block);
-        break;
-        case element_type_ushort:
-            ushort_element_block::print_block(block);
-        break;
-        case element_type_int:
-            int_element_block::print_block(block);
-        break;
-        case element_type_uint:
-            uint_element_block::print_block(block);
-        break;
-        case element_type_long:
-            long_element_block::print_block(block);
-        break;
-        case element_type_ulong:
-            ulong_element_block::print_block(block);
-        break;
-        case element_type_boolean:
-            boolean_element_block::print_block(block);
-        break;
-        case element_type_char:
-            char_element_block::print_block(block);
-        break;
-        case element_type_uchar:
-            uchar_element_block::print_block(block);
-        break;
-        default:
-            throw general_error("print_block: failed to print a block of unknown type.");
+    static void print_block(const base_element_block&)
+    {
+        throw general_error("print_block: failed to print a block of unknown type.");
     }
-}
 
-void element_block_func_base::erase(base_element_block& block, size_t pos)
-{
-    switch (get_block_type(block))
-    {
-        case element_type_numeric:
-            numeric_element_block::erase_block(block, pos);
-        break;
-        case element_type_string:
-            string_element_block::erase_block(block, pos);
-        break;
-        case element_type_short:
-            short_element_block::erase_block(block, pos);
-        break;
-        case element_type_ushort:
-            ushort_element_block::erase_block(block, pos);
-        break;
-        case element_type_int:
-            int_element_block::erase_block(block, pos);
-        break;
-        case element_type_uint:
-            uint_element_block::erase_block(block, pos);
-        break;
-        case element_type_long:
-            long_element_block::erase_block(block, pos);
-        break;
-        case element_type_ulong:
-            ulong_element_block::erase_block(block, pos);
-        break;
-        case element_type_boolean:
-            boolean_element_block::erase_block(block, pos);
-        break;
-        case element_type_char:
-            char_element_block::erase_block(block, pos);
-        break;
-        case element_type_uchar:
-            uchar_element_block::erase_block(block, pos);
-        break;
-        default:
-            throw general_error("erase: failed to erase an element from a block of unknown type.");
+    static void erase(base_element_block&, size_t)
+    {
+        throw general_error("erase: failed to erase an element from a block of unknown type.");
     }
-}
 
-void element_block_func_base::erase(base_element_block& block, size_t pos, size_t size)
-{
-    switch (get_block_type(block))
-    {
-        case element_type_numeric:
-            numeric_element_block::erase_block(block, pos, size);
-        break;
-        case element_type_string:
-            string_element_block::erase_block(block, pos, size);
-        break;
-        case element_type_short:
-            short_element_block::erase_block(block, pos, size);
-        break;
-        case element_type_ushort:
-            ushort_element_block::erase_block(block, pos, size);
-        break;
-        case element_type_int:
-            int_element_block::erase_block(block, pos, size);
-        break;
-        case element_type_uint:
-            uint_element_block::erase_block(block, pos, size);
-        break;
-        case element_type_long:
-            long_element_block::erase_block(block, pos, size);
-        break;
-        case element_type_ulong:
-            ulong_element_block::erase_block(block, pos, size);
-        break;
-        case element_type_boolean:
-            boolean_element_block::erase_block(block, pos, size);
-        break;
-        case element_type_char:
-            char_element_block::erase_block(block, pos, size);
-        break;
-        case element_type_uchar:
-            uchar_element_block::erase_block(block, pos, size);
-        break;
-        default:
-            throw general_error("erase: failed to erase elements from a block of unknown type.");
+    static void erase(base_element_block&, size_t, size_t)
+    {
+        throw general_error("erase: failed to erase elements from a block of unknown type.");
     }
-}
 
-void element_block_func_base::append_values_from_block(base_element_block& dest, const base_element_block& src)
-{
-    switch (get_block_type(dest))
-    {
-        case element_type_numeric:
-            numeric_element_block::append_values_from_block(dest, src);
-        break;
-        case element_type_string:
-            string_element_block::append_values_from_block(dest, src);
-        break;
-        case element_type_short:
-            short_element_block::append_values_from_block(dest, src);
-        break;
-        case element_type_ushort:
-            ushort_element_block::append_values_from_block(dest, src);
-        break;
-        case element_type_int:
-            int_element_block::append_values_from_block(dest, src);
-        break;
-        case element_type_uint:
-            uint_element_block::append_values_from_block(dest, src);
-        break;
-        case element_type_long:
-            long_element_block::append_values_from_block(dest, src);
-        break;
-        case element_type_ulong:
-            ulong_element_block::append_values_from_block(dest, src);
-        break;
-        case element_type_boolean:
-            boolean_element_block::append_values_from_block(dest, src);
-        break;
-        case element_type_char:
-            char_element_block::append_values_from_block(dest, src);
-        break;
-        case element_type_uchar:
-            uchar_element_block::append_values_from_block(dest, src);
-        break;
-        default:
-            throw general_error("append_values: failed to append values to a block of unknown type.");
+    static void append_values_from_block(base_element_block&, const base_element_block&)
+    {
+        throw general_error("append_values: failed to append values to a block of unknown type.");
     }
-}
 
-void element_block_func_base::append_values_from_block(
-    base_element_block& dest, const base_element_block& src, size_t begin_pos, size_t len)
-{
-    switch (get_block_type(dest))
-    {
-        case element_type_numeric:
-            numeric_element_block::append_values_from_block(dest, src, begin_pos, len);
-        break;
-        case element_type_string:
-            string_element_block::append_values_from_block(dest, src, begin_pos, len);
-        break;
-        case element_type_short:
-            short_element_block::append_values_from_block(dest, src, begin_pos, len);
-        break;
-        case element_type_ushort:
-            ushort_element_block::append_values_from_block(dest, src, begin_pos, len);
-        break;
-        case element_type_int:
-            int_element_block::append_values_from_block(dest, src, begin_pos, len);
-        break;
-        case element_type_uint:
-            uint_element_block::append_values_from_block(dest, src, begin_pos, len);
-        break;
-        case element_type_long:
-            long_element_block::append_values_from_block(dest, src, begin_pos, len);
-        break;
-        case element_type_ulong:
-            ulong_element_block::append_values_from_block(dest, src, begin_pos, len);
-        break;
-        case element_type_boolean:
-            boolean_element_block::append_values_from_block(dest, src, begin_pos, len);
-        break;
-        case element_type_char:
-            char_element_block::append_values_from_block(dest, src, begin_pos, len);
-        break;
-        case element_type_uchar:
-            uchar_element_block::append_values_from_block(dest, src, begin_pos, len);
-        break;
-        default:
-            throw general_error("append_values: failed to append values to a block of unknown type.");
+    static void append_values_from_block(
+        base_element_block&, const base_element_block&, size_t, size_t)
+    {
+        throw general_error("append_values: failed to append values to a block of unknown type.");
     }
-}
 
-void element_block_func_base::assign_values_from_block(
-    base_element_block& dest, const base_element_block& src, size_t begin_pos, size_t len)
-{
-    switch (get_block_type(dest))
-    {
-        case element_type_numeric:
-            numeric_element_block::assign_values_from_block(dest, src, begin_pos, len);
-        break;
-        case element_type_string:
-            string_element_block::assign_values_from_block(dest, src, begin_pos, len);
-        break;
-        case element_type_short:
-            short_element_block::assign_values_from_block(dest, src, begin_pos, len);
-        break;
-        case element_type_ushort:
-            ushort_element_block::assign_values_from_block(dest, src, begin_pos, len);
-        break;
-        case element_type_int:
-            int_element_block::assign_values_from_block(dest, src, begin_pos, len);
-        break;
-        case element_type_uint:
-            uint_element_block::assign_values_from_block(dest, src, begin_pos, len);
-        break;
-        case element_type_long:
-            long_element_block::assign_values_from_block(dest, src, begin_pos, len);
-        break;
-        case element_type_ulong:
-            ulong_element_block::assign_values_from_block(dest, src, begin_pos, len);
-        break;
-        case element_type_boolean:
-            boolean_element_block::assign_values_from_block(dest, src, begin_pos, len);
-        break;
-        case element_type_char:
-            char_element_block::assign_values_from_block(dest, src, begin_pos, len);
-        break;
-        case element_type_uchar:
-            uchar_element_block::assign_values_from_block(dest, src, begin_pos, len);
-        break;
-        default:
-            throw general_error("assign_values_from_block: failed to assign values to a block of unknown type.");
+    static void assign_values_from_block(
+        base_element_block&, const base_element_block&, size_t, size_t)
+    {
+        throw general_error("assign_values_from_block: failed to assign values to a block of unknown type.");
     }
-}
 
-void element_block_func_base::prepend_values_from_block(
-    base_element_block& dest, const base_element_block& src, size_t begin_pos, size_t len)
-{
-    switch (get_block_type(dest))
-    {
-        case element_type_numeric:
-            numeric_element_block::prepend_values_from_block(dest, src, begin_pos, len);
-        break;
-        case element_type_string:
-            string_element_block::prepend_values_from_block(dest, src, begin_pos, len);
-        break;
-        case element_type_short:
-            short_element_block::prepend_values_from_block(dest, src, begin_pos, len);
-        break;
-        case element_type_ushort:
-            ushort_element_block::prepend_values_from_block(dest, src, begin_pos, len);
-        break;
-        case element_type_int:
-            int_element_block::prepend_values_from_block(dest, src, begin_pos, len);
-        break;
-        case element_type_uint:
-            uint_element_block::prepend_values_from_block(dest, src, begin_pos, len);
-        break;
-        case element_type_long:
-            long_element_block::prepend_values_from_block(dest, src, begin_pos, len);
-        break;
-        case element_type_ulong:
-            ulong_element_block::prepend_values_from_block(dest, src, begin_pos, len);
-        break;
-        case element_type_boolean:
-            boolean_element_block::prepend_values_from_block(dest, src, begin_pos, len);
-        break;
-        case element_type_char:
-            char_element_block::prepend_values_from_block(dest, src, begin_pos, len);
-        break;
-        case element_type_uchar:
-            uchar_element_block::prepend_values_from_block(dest, src, begin_pos, len);
-        break;
-        default:
-            throw general_error("prepend_values_from_block: failed to prepend values to a block of unknown type.");
+    static void prepend_values_from_block(
+        base_element_block&, const base_element_block&, size_t, size_t)
+    {
+        throw general_error("prepend_values_from_block: failed to prepend values to a block of unknown type.");
     }
-}
 
-void element_block_func_base::swap_values(
-    base_element_block& blk1, base_element_block& blk2, size_t pos1, size_t pos2, size_t len)
-{
-    element_t blk1_type = get_block_type(blk1);
-    assert(blk1_type == get_block_type(blk2));
-    switch (blk1_type)
-    {
-        case element_type_numeric:
-            numeric_element_block::swap_values(blk1, blk2, pos1, pos2, len);
-        break;
-        case element_type_string:
-            string_element_block::swap_values(blk1, blk2, pos1, pos2, len);
-        break;
-        case element_type_short:
-            short_element_block::swap_values(blk1, blk2, pos1, pos2, len);
-        break;
-        case element_type_ushort:
-            ushort_element_block::swap_values(blk1, blk2, pos1, pos2, len);
-        break;
-        case element_type_int:
-            int_element_block::swap_values(blk1, blk2, pos1, pos2, len);
-        break;
-        case element_type_uint:
-            uint_element_block::swap_values(blk1, blk2, pos1, pos2, len);
-        break;
-        case element_type_long:
-            long_element_block::swap_values(blk1, blk2, pos1, pos2, len);
-        break;
-        case element_type_ulong:
-            ulong_element_block::swap_values(blk1, blk2, pos1, pos2, len);
-        break;
-        case element_type_boolean:
-            boolean_element_block::swap_values(blk1, blk2, pos1, pos2, len);
-        break;
-        case element_type_char:
-            char_element_block::swap_values(blk1, blk2, pos1, pos2, len);
-        break;
-        case element_type_uchar:
-            uchar_element_block::swap_values(blk1, blk2, pos1, pos2, len);
-        break;
-        default:
-            throw general_error("swap_values: block of unknown type.");
+    static void swap_values(
+        base_element_block&, base_element_block&, size_t, size_t, size_t)
+    {
+        throw general_error("swap_values: block of unknown type.");
     }
-}
 
-bool element_block_func_base::equal_block(const base_element_block& left, const base_element_block& right)
-{
-    element_t block_type = get_block_type(left);
-    if (block_type != get_block_type(right))
+    static bool equal_block(const base_element_block&, const base_element_block&)
+    {
         return false;
+    }
 
-    switch (block_type)
-    {
-        case element_type_numeric:
-            return numeric_element_block::get(left) == numeric_element_block::get(right);
-        case element_type_string:
-            return string_element_block::get(left) == string_element_block::get(right);
-        case element_type_short:
-            return short_element_block::get(left) == short_element_block::get(right);
-        case element_type_ushort:
-            return ushort_element_block::get(left) == ushort_element_block::get(right);
-        case element_type_int:
-            return int_element_block::get(left) == int_element_block::get(right);
-        case element_type_uint:
-            return uint_element_block::get(left) == uint_element_block::get(right);
-        case element_type_long:
-            return long_element_block::get(left) == long_element_block::get(right);
-        case element_type_ulong:
-            return ulong_element_block::get(left) == ulong_element_block::get(right);
-        case element_type_boolean:
-            return boolean_element_block::get(left) == boolean_element_block::get(right);
-        case element_type_char:
-            return char_element_block::get(left) == char_element_block::get(right);
-        case element_type_uchar:
-            return uchar_element_block::get(left) == uchar_element_block::get(right);
-        default:
-            ;
-    }
-    return false;
-}
+    static size_t hash_block(const base_element_block&)
+    {
+        throw general_error("hash_block: failed to hash a block of unknown type.");
+    }
+
+    static size_t match_length(
+        const base_element_block&, size_t, const base_element_block&, size_t, size_t, bool)
+    {
+        throw general_error("match_length: failed to compare the elements of a block of unknown type.");
+    }
+
+    static void overwrite_values(base_element_block&, size_t, size_t)
+    {
+    }
+
+    static void shrink_to_fit(base_element_block&)
+    {
+        throw general_error("shrink_to_fit: failed to shrink a block of unknown type.");
+    }
+};
 
-void element_block_func_base::overwrite_values(base_element_block&, size_t, size_t)
-{
-    // Do nothing for the standard types.
 }
 
-void element_block_func_base::shrink_to_fit(base_element_block& block)
+/**
+ * Block functions for the standard block types.
+ */
+struct element_block_func_base : public detail::block_funcs_dispatch<
+    detail::unknown_block_funcs,
+    numeric_element_block, string_element_block,
+    short_element_block, ushort_element_block,
+    int_element_block, uint_element_block,
+    long_element_block, ulong_element_block,
+    boolean_element_block, char_element_block, uchar_element_block>
 {
-    switch (get_block_type(block))
-    {
-        case element_type_numeric:
-            numeric_element_block::shrink_to_fit(block);
-        break;
-        case element_type_string:
-            string_element_block::shrink_to_fit(block);
-        break;
-        case element_type_short:
-            short_element_block::shrink_to_fit(block);
-        break;
-        case element_type_ushort:
-            ushort_element_block::shrink_to_fit(block);
-        break;
-        case element_type_int:
-            int_element_block::shrink_to_fit(block);
-        break;
-        case element_type_uint:
-            uint_element_block::shrink_to_fit(block);
-        break;
-        case element_type_long:
-            long_element_block::shrink_to_fit(block);
-        break;
-        case element_type_ulong:
-            ulong_element_block::shrink_to_fit(block);
-        break;
-        case element_type_boolean:
-            boolean_element_block::shrink_to_fit(block);
-        break;
-        case element_type_char:
-            char_element_block::shrink_to_fit(block);
-        break;
-        case element_type_uchar:
-            uchar_element_block::shrink_to_fit(block);
-        break;
-        default:
-            throw general_error("shrink_to_fit: failed to print a block of unknown type.");
+    static void delete_block(const base_element_block* p)
+    {
+        if (p)
+            block_funcs_dispatch::delete_block(p);
     }
-}
+
+    /**
+     * This method gets called when cell values are being overwritten by new
+     * values.  This provides the client code an opportunity to delete
+     * overwritten instances in case the block stores pointers to managed
+     * objects.  For blocks that don't need to manage their stored objects (or
+     * store primitive values), this method can be left empty.
+     */
+    static void overwrite_values(base_element_block&, size_t, size_t)
+    {
+        // Do nothing for the standard types.
+    }
+};
 
 /**
  * Default cell block function definitions.  Implementation can use this if
@@ -658,6 +339,27 @@ void element_block_func_base::shrink_to_fit(base_element_block& block)
  */
 struct element_block_func : public element_block_func_base {};
 
+/**
+ * Block function template for multi_type_vector with any number of
+ * user-defined blocks.  The functions for the user-defined blocks get
+ * dispatched in the order the blocks are listed, before falling back to
+ * those for the standard block types.
+ *
+ * A block type that is listed here takes precedence over a standard
+ * block type of the same type identifier.
+ */
+template<typename... _Blocks>
+struct element_block_funcs : public detail::block_funcs_dispatch<element_block_func, _Blocks...>
+{
+    typedef detail::block_funcs_dispatch<element_block_func, _Blocks...> dispatch_type;
+
+    static void delete_block(const base_element_block* p)
+    {
+        if (p)
+            dispatch_type::delete_block(p);
+    }
+};
+
 }}
 
 #endif
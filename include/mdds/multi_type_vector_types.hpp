@@ -30,14 +30,22 @@
 
 #include "default_deleter.hpp"
 #include "global.hpp"
+#include "multi_type_vector/memory_resource.hpp"
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <functional>
 #include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
 
 #ifdef MDDS_MULTI_TYPE_VECTOR_USE_DEQUE
 #include <deque>
 #else
+#include "multi_type_vector/small_vector.hpp"
 #include <vector>
 #endif
 
@@ -69,6 +77,53 @@ const element_t element_type_uchar   = 10;
 
 const element_t element_type_user_start = 50;
 
+/**
+ * Type reported in a range change event for a range that stores elements
+ * of more than one type.
+ */
+const element_t element_type_mixed = -2;
+
+/**
+ * Kind of change reported in a range change event.
+ */
+enum range_change_t
+{
+    /** The elements in the range got overwritten or emptied in place. */
+    range_change_modified,
+    /** The range got inserted, which moved all the elements below it down. */
+    range_change_inserted,
+    /** The range got erased, which moved all the elements below it up. */
+    range_change_erased
+};
+
+/**
+ * Change to a range of elements, reported to the range_changed event
+ * handler once for each modifying call.
+ */
+struct range_change_event
+{
+    /** Kind of change. */
+    range_change_t kind;
+
+    /** Logical position of the first element in the range. */
+    size_t start;
+
+    /** Logical position past the last element in the range. */
+    size_t end;
+
+    /**
+     * Type of the elements in the range before the change, or
+     * element_type_empty for an inserted range.
+     */
+    element_t old_type;
+
+    /**
+     * Type of the elements in the range after the change, or
+     * element_type_empty for an erased range.
+     */
+    element_t new_type;
+};
+
 /**
  * Generic exception used for errors specific to element block operations.
  */
@@ -81,6 +136,162 @@ public:
 struct base_element_block;
 element_t get_block_type(const base_element_block&);
 
+namespace detail {
+
+void add_block_ref(const base_element_block&);
+bool release_block_ref(const base_element_block&);
+bool is_block_shared(const base_element_block&);
+std::mutex& constant_run_mutex();
+
+}
+
+namespace detail {
+
+template<typename _T>
+auto values_equal_impl(const _T& left, const _T& right, int) -> decltype(bool(left == right))
+{
+    return left == right;
+}
+
+template<typename _T>
+bool values_equal_impl(const _T&, const _T&, long)
+{
+    return false;
+}
+
+/**
+ * Compare two element values when their type supports comparison.  Values
+ * of a type that does not are never considered equal, which only prevents
+ * constant runs of such values from being extended.
+ */
+template<typename _T>
+bool values_equal(const _T& left, const _T& right)
+{
+    return values_equal_impl(left, right, 0);
+}
+
+template<typename _T>
+auto value_hash_impl(const _T& val, int) -> decltype(size_t(std::hash<_T>()(val)))
+{
+    return std::hash<_T>()(val);
+}
+
+template<typename _T>
+size_t value_hash_impl(const _T&, long)
+{
+    return 0;
+}
+
+/**
+ * Hash an element value with std::hash when it supports the value type.
+ * All values of a type that it does not support hash to the same value.
+ */
+template<typename _T>
+size_t value_hash(const _T& val)
+{
+    return value_hash_impl(val, 0);
+}
+
+/**
+ * Mix a value into a running hash.  The result depends on the order in
+ * which the values get mixed in.
+ */
+inline size_t hash_combine(size_t seed, size_t val)
+{
+    return seed ^ (val + 0x9e3779b9 + (seed << 6) + (seed >> 2));
+}
+
+/**
+ * Multiplier of the polynomial hash of the elements of a block.  It is the
+ * 64-bit FNV prime, which remains odd when truncated to a 32-bit size_t.
+ */
+const size_t element_hash_multiplier = static_cast<size_t>(0x100000001b3ULL);
+
+/**
+ * Append a value to a polynomial hash of a sequence of values.  The hash
+ * of v1, ..., vn is v1*P^(n-1) + ... + vn, modulo the range of size_t.
+ */
+inline size_t hash_append(size_t h, size_t val)
+{
+    return h * element_hash_multiplier + val;
+}
+
+/**
+ * Append n copies of a value to a polynomial hash, with the same result
+ * as calling hash_append() n times but in O(log n) time.  It computes
+ * P^n and 1 + P + ... + P^(n-1) by repeated squaring.
+ */
+inline size_t hash_append_copies(size_t h, size_t val, size_t n)
+{
+    size_t pow = 1, sum = 0; // P^m and the sum for the m copies so far
+    size_t step_pow = element_hash_multiplier, step_sum = 1; // same for 2^k copies
+
+    for (; n; n >>= 1)
+    {
+        if (n & 1)
+        {
+            sum = sum * step_pow + step_sum;
+            pow *= step_pow;
+        }
+
+        step_sum = step_sum * step_pow + step_sum;
+        step_pow *= step_pow;
+    }
+
+    return h * pow + val * sum;
+}
+
+/**
+ * Check whether a storage type stores its elements in one contiguous
+ * array, which it does when it provides data() that returns a pointer to
+ * it.  std::vector<bool>, std::deque and gap_buffer do not.
+ */
+template<typename _Store, typename = void>
+struct is_contiguous_store : std::false_type {};
+
+template<typename _Store>
+struct is_contiguous_store<_Store, typename std::enable_if<std::is_same<
+    decltype(std::declval<const _Store&>().data()),
+    const typename _Store::value_type*>::value>::type> : std::true_type {};
+
+#ifdef MDDS_MULTI_TYPE_VECTOR_USE_DEQUE
+
+/**
+ * Storage type used by element blocks to store their elements by default.
+ */
+template<typename _Data>
+struct element_store_type
+{
+    typedef std::deque<_Data> type;
+};
+
+#else
+
+/**
+ * Storage type used by element blocks to store their elements by default.
+ * Elements are stored in a small_vector so that a block with only a few
+ * elements does not require a second heap allocation for its array.
+ */
+template<typename _Data>
+struct element_store_type
+{
+    typedef small_vector<_Data> type;
+};
+
+/**
+ * Boolean elements stay in std::vector<bool> whose bit-packed storage is
+ * more compact than any inline buffer.
+ */
+template<>
+struct element_store_type<bool>
+{
+    typedef std::vector<bool, resource_allocator<bool>> type;
+};
+
+#endif
+
+}
+
 /**
  * Non-template common base type necessary for blocks of all types to be
  * stored in a single container.
@@ -88,13 +299,39 @@ element_t get_block_type(const base_element_block&);
 struct base_element_block
 {
     friend element_t get_block_type(const base_element_block&);
+    friend void detail::add_block_ref(const base_element_block&);
+    friend bool detail::release_block_ref(const base_element_block&);
+    friend bool detail::is_block_shared(const base_element_block&);
 protected:
     element_t type;
-    base_element_block(element_t _t) : type(_t) {}
+
+    /**
+     * Number of containers that reference this block.  It is greater than
+     * one only for blocks shared between a container and its snapshots.
+     */
+    mutable std::atomic<unsigned int> ref_count;
+
+    /**
+     * Cached hash of the elements, or 0 if it has not been computed since
+     * the block was last modified.
+     */
+    mutable std::atomic<size_t> content_hash;
+
+    base_element_block(element_t _t) : type(_t), ref_count(1), content_hash(0) {}
+    base_element_block(const base_element_block& r) :
+        type(r.type), ref_count(1), content_hash(r.content_hash.load(std::memory_order_relaxed)) {}
     ~base_element_block() {}
+
+    base_element_block& operator=(const base_element_block& r)
+    {
+        type = r.type;
+        content_hash.store(0, std::memory_order_relaxed);
+        return *this;
+    }
 };
 
-template<typename _Self, element_t _TypeId, typename _Data>
+template<typename _Self, element_t _TypeId, typename _Data,
+    typename _Store = typename detail::element_store_type<_Data>::type>
 class element_block : public base_element_block
 {
 #ifdef MDDS_UNIT_TEST
@@ -108,23 +345,201 @@ class element_block : public base_element_block
 #endif
 
 protected:
-#ifdef MDDS_MULTI_TYPE_VECTOR_USE_DEQUE
-    typedef std::deque<_Data> store_type;
-#else
-    typedef std::vector<_Data> store_type;
-#endif
+    typedef _Store store_type;
+
+    /**
+     * Memory resource the block was allocated from.  The constructor runs
+     * right after operator new on the same thread, so both see the same
+     * memory resource installed.
+     */
+    memory_resource* mp_resource;
+
     store_type m_array;
 
-    element_block() : base_element_block(_TypeId) {}
-    element_block(size_t n) : base_element_block(_TypeId), m_array(n) {}
-    element_block(size_t n, const _Data& val) : base_element_block(_TypeId), m_array(n, val) {}
+    /**
+     * Length and value of a constant run.  It is allocated separately from
+     * the block, so that blocks that never store a constant run do not pay
+     * for it.
+     */
+    struct constant_run
+    {
+        std::atomic<size_t> size;
+        _Data value;
+
+        constant_run(size_t n, const _Data& val) : size(n), value(val) {}
+    };
+
+    /**
+     * A block whose elements all have the same value may store that value
+     * only once, as a constant run.  In that case mp_run stores the number
+     * of elements and the value of all of them, and m_array is empty.
+     * Otherwise mp_run is either null or stores a length of 0, and m_array
+     * stores all elements.
+     *
+     * A constant run gets expanded into m_array the first time its
+     * elements are accessed in a way that requires contiguous storage.
+     * Expansion via a const accessor leaves the value in place, which
+     * keeps any reference to it obtained via a const accessor valid; it
+     * gets freed when the block is next accessed for modification.
+     */
+    constant_run* mp_run;
+
+    element_block() :
+        base_element_block(_TypeId), mp_resource(detail::current_memory_resource()),
+        mp_run(nullptr) {}
+
+    element_block(size_t n) :
+        base_element_block(_TypeId), mp_resource(detail::current_memory_resource()),
+        m_array(n), mp_run(nullptr) {}
+
+    element_block(size_t n, const _Data& val) :
+        base_element_block(_TypeId), mp_resource(detail::current_memory_resource()),
+        m_array(n, val), mp_run(nullptr) {}
 
     template<typename _Iter>
-    element_block(const _Iter& it_begin, const _Iter& it_end) : base_element_block(_TypeId), m_array(it_begin, it_end) {}
+    element_block(const _Iter& it_begin, const _Iter& it_end) :
+        base_element_block(_TypeId), mp_resource(detail::current_memory_resource()),
+        m_array(it_begin, it_end), mp_run(nullptr) {}
+
+    element_block(const element_block& r) :
+        base_element_block(r), mp_resource(detail::current_memory_resource()),
+        mp_run(nullptr)
+    {
+        // The source may get expanded concurrently by a reader, but its
+        // m_array is stable once it no longer stores a constant run, and
+        // its value stays in place until it gets modified.
+        size_t n = r.run_size();
+        if (n)
+            mp_run = create_run(n, r.mp_run->value);
+        else
+            m_array = r.m_array;
+    }
+
+    ~element_block()
+    {
+        release_run();
+    }
+
+    /**
+     * @return number of elements in the constant run, or 0 if the block
+     *         does not store a constant run.
+     */
+    size_t run_size() const
+    {
+        return mp_run ? mp_run->size.load(std::memory_order_acquire) : 0;
+    }
+
+    constant_run* create_run(size_t n, const _Data& val) const
+    {
+        void* p = detail::allocate(mp_resource, sizeof(constant_run), alignof(constant_run));
+        try
+        {
+            return new (p) constant_run(n, val);
+        }
+        catch (...)
+        {
+            detail::deallocate(mp_resource, p, sizeof(constant_run), alignof(constant_run));
+            throw;
+        }
+    }
+
+    void release_run()
+    {
+        if (!mp_run)
+            return;
+
+        mp_run->~constant_run();
+        detail::deallocate(mp_resource, mp_run, sizeof(constant_run), alignof(constant_run));
+        mp_run = nullptr;
+    }
+
+    /**
+     * Turn this block into a constant run of the specified value.
+     */
+    void assign_constant(size_t n, const _Data& val)
+    {
+        if (mp_run)
+        {
+            mp_run->value = val;
+            mp_run->size.store(n, std::memory_order_relaxed);
+        }
+        else
+            mp_run = create_run(n, val);
+
+        m_array.clear();
+    }
+
+    /**
+     * Expand a constant run, if any, into m_array.  It may get called on a
+     * block that is being read concurrently by multiple threads; the
+     * expansion is serialized so that it happens only once.
+     */
+    void expand() const
+    {
+        if (!run_size())
+            return;
+
+        std::lock_guard<std::mutex> lock(detail::constant_run_mutex());
+        size_t n = mp_run->size.load(std::memory_order_relaxed);
+        if (!n)
+            // Another thread has expanded it in the meantime.
+            return;
+
+        store_type& array = const_cast<store_type&>(m_array);
+        store_type expanded(n, mp_run->value);
+        array.swap(expanded);
+        mp_run->size.store(0, std::memory_order_release);
+    }
+
+    const store_type& array() const
+    {
+        expand();
+        return m_array;
+    }
+
+    store_type& array()
+    {
+        expand();
+        release_run();
+        return m_array;
+    }
+
+    size_t size() const
+    {
+        size_t n = run_size();
+        return n ? n : m_array.size();
+    }
 
 public:
     static const element_t block_type = _TypeId;
 
+    /**
+     * Whether this block type stores its elements in one contiguous array,
+     * which can be accessed directly via data().
+     */
+    static const bool contiguous = detail::is_contiguous_store<_Store>::value;
+
+    /**
+     * Element blocks are allocated from the memory resource installed for
+     * the current thread, if any.  They must be destroyed via
+     * delete_block(), which returns the memory to the memory resource it
+     * came from.
+     */
+    static void* operator new(size_t size)
+    {
+        return detail::allocate(detail::current_memory_resource(), size, alignof(_Self));
+    }
+
+    /**
+     * Called when the constructor throws, or when a block gets deleted
+     * directly rather than via delete_block(), which is only correct while
+     * the same memory resource is installed as when the block was created.
+     */
+    static void operator delete(void* p, size_t size)
+    {
+        detail::deallocate(detail::current_memory_resource(), p, size, alignof(_Self));
+    }
+
     typedef typename store_type::iterator iterator;
     typedef typename store_type::reverse_iterator reverse_iterator;
     typedef typename store_type::const_iterator const_iterator;
@@ -133,6 +548,27 @@ public:
 
     bool operator== (const _Self& r) const
     {
+        if (this == &r)
+            return true;
+
+        size_t h1 = content_hash.load(std::memory_order_relaxed);
+        size_t h2 = r.content_hash.load(std::memory_order_relaxed);
+        if (h1 && h2 && h1 != h2)
+            // Blocks with different hashes cannot be equal.
+            return false;
+
+        size_t n1 = run_size();
+        size_t n2 = r.run_size();
+
+        if (n1 && n2)
+            return n1 == n2 && mp_run->value == r.mp_run->value;
+
+        if (n1)
+            return r.equals_constant(n1, mp_run->value);
+
+        if (n2)
+            return equals_constant(n2, r.mp_run->value);
+
         return m_array == r.m_array;
     }
 
@@ -141,54 +577,194 @@ public:
         return !operator==(r);
     }
 
+    /**
+     * Check whether a block stores all of its elements as a constant run
+     * of a single value.  Such a block uses the same amount of memory
+     * regardless of the number of its elements, until its elements get
+     * accessed via iterators or modified.
+     *
+     * @param block element block to check.
+     *
+     * @return true if the block stores its elements as a constant run,
+     *         false otherwise.
+     */
+    static bool is_constant(const base_element_block& block)
+    {
+        return get(block).run_size() != 0;
+    }
+
+    /**
+     * Compute a hash of the elements stored in a block.  The hash gets
+     * cached in the block until the block is next accessed for
+     * modification, so that hashing an unmodified block again takes
+     * constant time.  Blocks whose elements compare equal have the same
+     * hash, regardless of whether they store them as a constant run.
+     * Hashing a constant run takes logarithmic time in its length.
+     *
+     * <p>Elements are hashed with std::hash; elements of a type that it
+     * does not support all contribute the same value.  Modifying elements
+     * through an iterator or a pointer obtained before the hash got
+     * computed leaves a stale hash in the block.</p>
+     *
+     * @param block element block to hash.
+     *
+     * @return hash of the elements, which is never 0.
+     */
+    static size_t hash(const base_element_block& block)
+    {
+        const _Self& blk = get(block);
+        size_t h = blk.content_hash.load(std::memory_order_relaxed);
+        if (h)
+            return h;
+
+        size_t n = blk.run_size();
+        if (n)
+            h = detail::hash_append_copies(h, detail::value_hash(blk.mp_run->value), n);
+        else
+        {
+            for (const _Data& val : blk.m_array)
+                h = detail::hash_append(h, detail::value_hash(val));
+        }
+
+        if (!h)
+            // 0 marks a hash that has not been computed.
+            h = 1;
+
+        blk.content_hash.store(h, std::memory_order_relaxed);
+        return h;
+    }
+
+    /**
+     * Compare the elements of two blocks of this type pairwise, starting
+     * at the specified positions, and count the leading pairs that compare
+     * equal, or the leading pairs that do not.  Constant runs do not get
+     * expanded.
+     *
+     * @param left first block.
+     * @param left_pos position of the first element to compare in the
+     *                 first block.
+     * @param right second block.
+     * @param right_pos position of the first element to compare in the
+     *                  second block.
+     * @param len number of pairs to compare at most.
+     * @param equal true to count the leading pairs that compare equal,
+     *              false to count the leading pairs that do not.
+     *
+     * @return number of leading pairs counted, which equals len if all of
+     *         them are.
+     */
+    static size_t match_length(
+        const base_element_block& left, size_t left_pos,
+        const base_element_block& right, size_t right_pos, size_t len, bool equal)
+    {
+        const _Self& blk1 = get(left);
+        const _Self& blk2 = get(right);
+        bool run1 = blk1.run_size() != 0;
+        bool run2 = blk2.run_size() != 0;
+
+        if (run1 && run2)
+            return detail::values_equal(blk1.mp_run->value, blk2.mp_run->value) == equal ? len : 0;
+
+        size_t i = 0;
+        if (run1)
+        {
+            for (; i < len; ++i)
+                if (detail::values_equal<_Data>(blk1.mp_run->value, blk2.m_array[right_pos+i]) != equal)
+                    break;
+        }
+        else if (run2)
+        {
+            for (; i < len; ++i)
+                if (detail::values_equal<_Data>(blk1.m_array[left_pos+i], blk2.mp_run->value) != equal)
+                    break;
+        }
+        else
+        {
+            for (; i < len; ++i)
+                if (detail::values_equal<_Data>(blk1.m_array[left_pos+i], blk2.m_array[right_pos+i]) != equal)
+                    break;
+        }
+
+        return i;
+    }
+
     static const value_type& at(const base_element_block& block, typename store_type::size_type pos)
     {
-        return get(block).m_array.at(pos);
+        const _Self& blk = get(block);
+        size_t n = blk.run_size();
+        if (!n)
+            return blk.m_array.at(pos);
+
+        if (pos >= n)
+            throw std::out_of_range("element_block::at: position is out of range.");
+
+        return blk.mp_run->value;
     }
 
     static value_type& at(base_element_block& block, typename store_type::size_type pos)
     {
-        return get(block).m_array.at(pos);
+        return get(block).array().at(pos);
+    }
+
+    /**
+     * Get a pointer to the contiguous array of elements stored in a block.
+     * A block storing a constant run gets expanded first.  This is only
+     * available for block types whose storage is contiguous.
+     *
+     * @param block element block to get the elements of.
+     *
+     * @return pointer to the first element of the block.
+     */
+    static const value_type* data(const base_element_block& block)
+    {
+        static_assert(contiguous, "element_block::data: element storage is not contiguous.");
+        return get(block).array().data();
+    }
+
+    static value_type* data(base_element_block& block)
+    {
+        static_assert(contiguous, "element_block::data: element storage is not contiguous.");
+        return get(block).array().data();
     }
 
     static iterator begin(base_element_block& block)
     {
-        return get(block).m_array.begin();
+        return get(block).array().begin();
     }
 
     static iterator end(base_element_block& block)
     {
-        return get(block).m_array.end();
+        return get(block).array().end();
     }
 
     static const_iterator begin(const base_element_block& block)
     {
-        return get(block).m_array.begin();
+        return get(block).array().begin();
     }
 
     static const_iterator end(const base_element_block& block)
     {
-        return get(block).m_array.end();
+        return get(block).array().end();
     }
 
     static reverse_iterator rbegin(base_element_block& block)
     {
-        return get(block).m_array.rbegin();
+        return get(block).array().rbegin();
     }
 
     static reverse_iterator rend(base_element_block& block)
     {
-        return get(block).m_array.rend();
+        return get(block).array().rend();
     }
 
     static const_reverse_iterator rbegin(const base_element_block& block)
     {
-        return get(block).m_array.rbegin();
+        return get(block).array().rbegin();
     }
 
     static const_reverse_iterator rend(const base_element_block& block)
     {
-        return get(block).m_array.rend();
+        return get(block).array().rend();
     }
 
     static _Self& get(base_element_block& block)
@@ -201,7 +777,12 @@ public:
             throw general_error(os.str());
         }
 #endif
-        return static_cast<_Self&>(block);
+        // Any modification of a block goes through here, so drop its
+        // cached hash.
+        _Self& blk = static_cast<_Self&>(block);
+        if (blk.content_hash.load(std::memory_order_relaxed))
+            blk.content_hash.store(0, std::memory_order_relaxed);
+        return blk;
     }
 
     static const _Self& get(const base_element_block& block)
@@ -219,25 +800,65 @@ public:
 
     static void set_value(base_element_block& blk, size_t pos, const _Data& val)
     {
-        get(blk).m_array[pos] = val;
+        _Self& self = get(blk);
+        if (self.run_size() && detail::values_equal(self.mp_run->value, val))
+            return;
+
+        self.array()[pos] = val;
+    }
+
+    static void set_value(base_element_block& blk, size_t pos, _Data&& val)
+    {
+        _Self& self = get(blk);
+        if (self.run_size() && detail::values_equal(self.mp_run->value, val))
+            return;
+
+        self.array()[pos] = std::move(val);
     }
 
     static void get_value(const base_element_block& blk, size_t pos, _Data& val)
     {
-        val = get(blk).m_array[pos];
+        const _Self& self = get(blk);
+        if (self.run_size())
+            val = self.mp_run->value;
+        else
+            val = self.m_array[pos];
     }
 
     static void append_value(base_element_block& blk, const _Data& val)
     {
-        get(blk).m_array.push_back(val);
+        _Self& self = get(blk);
+        if (!self.extend_constant(1, val))
+            self.array().push_back(val);
+    }
+
+    static void append_value(base_element_block& blk, _Data&& val)
+    {
+        _Self& self = get(blk);
+        if (!self.extend_constant(1, val))
+            self.array().push_back(std::move(val));
     }
 
     static void prepend_value(base_element_block& blk, const _Data& val)
     {
-        store_type& blk2 = get(blk).m_array;
+        _Self& self = get(blk);
+        if (self.extend_constant(1, val))
+            return;
+
+        store_type& blk2 = self.array();
         blk2.insert(blk2.begin(), val);
     }
 
+    static void prepend_value(base_element_block& blk, _Data&& val)
+    {
+        _Self& self = get(blk);
+        if (self.extend_constant(1, val))
+            return;
+
+        store_type& blk2 = self.array();
+        blk2.insert(blk2.begin(), std::move(val));
+    }
+
     static _Self* create_block(size_t init_size)
     {
         return new _Self(init_size);
@@ -245,12 +866,27 @@ public:
 
     static void delete_block(const base_element_block* p)
     {
-        delete static_cast<const _Self*>(p);
+        if (!p)
+            return;
+
+        _Self* blk = const_cast<_Self*>(static_cast<const _Self*>(p));
+        memory_resource* res = blk->mp_resource;
+        blk->~_Self();
+        detail::deallocate(res, blk, sizeof(_Self), alignof(_Self));
     }
 
     static void resize_block(base_element_block& blk, size_t new_size)
     {
-        store_type& st = get(blk).m_array;
+        _Self& self = get(blk);
+        size_t n = self.run_size();
+        if (n && new_size <= n)
+        {
+            // Shrinking a constant run only changes its length.
+            self.mp_run->size.store(new_size, std::memory_order_relaxed);
+            return;
+        }
+
+        store_type& st = self.array();
         st.resize(new_size);
 
         // Test if the vector's capacity is larger than twice its current
@@ -262,9 +898,15 @@ public:
 #ifdef MDDS_UNIT_TEST
     static void print_block(const base_element_block& blk)
     {
-        const store_type& blk2 = get(blk).m_array;
-        std::for_each(blk2.begin(), blk2.end(), print_block_array());
-        std::cout << std::endl;
+        const _Self& self = get(blk);
+        size_t n = self.run_size();
+        if (n)
+            std::cout << "(" << n << " x) " << self.mp_run->value << std::endl;
+        else
+        {
+            std::for_each(self.m_array.begin(), self.m_array.end(), print_block_array());
+            std::cout << std::endl;
+        }
     }
 #else
     static void print_block(const base_element_block&) {}
@@ -272,28 +914,53 @@ public:
 
     static void erase_block(base_element_block& blk, size_t pos)
     {
-        store_type& blk2 = get(blk).m_array;
-        blk2.erase(blk2.begin()+pos);
+        erase_block(blk, pos, 1);
     }
 
     static void erase_block(base_element_block& blk, size_t pos, size_t size)
     {
-        store_type& blk2 = get(blk).m_array;
+        _Self& self = get(blk);
+        size_t n = self.run_size();
+        if (n)
+        {
+            assert(pos + size <= n);
+            self.mp_run->size.store(n - size, std::memory_order_relaxed);
+            return;
+        }
+
+        store_type& blk2 = self.m_array;
         blk2.erase(blk2.begin()+pos, blk2.begin()+pos+size);
     }
 
     static void append_values_from_block(base_element_block& dest, const base_element_block& src)
     {
-        store_type& d = get(dest).m_array;
-        const store_type& s = get(src).m_array;
+        _Self& d_self = get(dest);
+        const _Self& s_self = get(src);
+        size_t n = s_self.run_size();
+        if (n)
+        {
+            d_self.append_copies(n, s_self.mp_run->value);
+            return;
+        }
+
+        store_type& d = d_self.array();
+        const store_type& s = s_self.m_array;
         d.insert(d.end(), s.begin(), s.end());
     }
 
     static void append_values_from_block(
         base_element_block& dest, const base_element_block& src, size_t begin_pos, size_t len)
     {
-        store_type& d = get(dest).m_array;
-        const store_type& s = get(src).m_array;
+        _Self& d_self = get(dest);
+        const _Self& s_self = get(src);
+        if (s_self.run_size())
+        {
+            d_self.append_copies(len, s_self.mp_run->value);
+            return;
+        }
+
+        store_type& d = d_self.array();
+        const store_type& s = s_self.m_array;
         std::pair<const_iterator,const_iterator> its = get_iterator_pair(s, begin_pos, len);
 #ifndef MDDS_MULTI_TYPE_VECTOR_USE_DEQUE
         d.reserve(d.size() + len);
@@ -304,8 +971,17 @@ public:
     static void assign_values_from_block(
         base_element_block& dest, const base_element_block& src, size_t begin_pos, size_t len)
     {
-        store_type& d = get(dest).m_array;
-        const store_type& s = get(src).m_array;
+        _Self& d_self = get(dest);
+        const _Self& s_self = get(src);
+        if (s_self.run_size())
+        {
+            d_self.assign_constant(len, s_self.mp_run->value);
+            return;
+        }
+
+        d_self.release_run();
+        store_type& d = d_self.m_array;
+        const store_type& s = s_self.m_array;
         std::pair<const_iterator,const_iterator> its = get_iterator_pair(s, begin_pos, len);
         d.assign(its.first, its.second);
     }
@@ -313,8 +989,16 @@ public:
     static void prepend_values_from_block(
         base_element_block& dest, const base_element_block& src, size_t begin_pos, size_t len)
     {
-        store_type& d = get(dest).m_array;
-        const store_type& s = get(src).m_array;
+        _Self& d_self = get(dest);
+        const _Self& s_self = get(src);
+        if (s_self.run_size())
+        {
+            d_self.prepend_copies(len, s_self.mp_run->value);
+            return;
+        }
+
+        store_type& d = d_self.array();
+        const store_type& s = s_self.m_array;
         std::pair<const_iterator,const_iterator> its = get_iterator_pair(s, begin_pos, len);
 #ifndef MDDS_MULTI_TYPE_VECTOR_USE_DEQUE
         d.reserve(d.size() + len);
@@ -325,8 +1009,8 @@ public:
     static void swap_values(
         base_element_block& blk1, base_element_block& blk2, size_t pos1, size_t pos2, size_t len)
     {
-        store_type& st1 = get(blk1).m_array;
-        store_type& st2 = get(blk2).m_array;
+        store_type& st1 = get(blk1).array();
+        store_type& st2 = get(blk2).array();
         assert(pos1 + len <= st1.size());
         assert(pos2 + len <= st2.size());
 
@@ -349,7 +1033,7 @@ public:
     static void set_values(
         base_element_block& block, size_t pos, const _Iter& it_begin, const _Iter& it_end)
     {
-        store_type& d = get(block).m_array;
+        store_type& d = get(block).array();
         typename store_type::iterator it_dest = d.begin();
         std::advance(it_dest, pos);
         for (_Iter it = it_begin; it != it_end; ++it, ++it_dest)
@@ -359,7 +1043,7 @@ public:
     template<typename _Iter>
     static void append_values(base_element_block& block, const _Iter& it_begin, const _Iter& it_end)
     {
-        store_type& d = get(block).m_array;
+        store_type& d = get(block).array();
         typename store_type::iterator it = d.end();
         d.insert(it, it_begin, it_end);
     }
@@ -367,25 +1051,31 @@ public:
     template<typename _Iter>
     static void prepend_values(base_element_block& block, const _Iter& it_begin, const _Iter& it_end)
     {
-        store_type& d = get(block).m_array;
+        store_type& d = get(block).array();
         d.insert(d.begin(), it_begin, it_end);
     }
 
     template<typename _Iter>
     static void assign_values(base_element_block& dest, const _Iter& it_begin, const _Iter& it_end)
     {
-        store_type& d = get(dest).m_array;
-        d.assign(it_begin, it_end);
+        _Self& self = get(dest);
+        self.release_run();
+        self.m_array.assign(it_begin, it_end);
     }
 
     template<typename _Iter>
     static void insert_values(
         base_element_block& block, size_t pos, const _Iter& it_begin, const _Iter& it_end)
     {
-        store_type& blk = get(block).m_array;
+        store_type& blk = get(block).array();
         blk.insert(blk.begin()+pos, it_begin, it_end);
     }
 
+    /**
+     * @return number of elements the block can store without allocating
+     *         more memory.  A block storing a constant run reports the
+     *         capacity of its currently unused element storage.
+     */
     static size_t capacity(const base_element_block& block)
     {
 #ifdef MDDS_MULTI_TYPE_VECTOR_USE_DEQUE
@@ -414,12 +1104,74 @@ private:
         std::advance(it_end, len);
         return std::pair<const_iterator,const_iterator>(it, it_end);
     }
+
+    /**
+     * Extend the constant run by the specified number of copies of a value
+     * if the value matches the run, or turn an empty block into a constant
+     * run.
+     *
+     * @return true if the block has been extended, false otherwise.
+     */
+    bool extend_constant(size_t len, const _Data& val)
+    {
+        size_t n = run_size();
+        if (n)
+        {
+            if (!detail::values_equal(mp_run->value, val))
+                return false;
+
+            mp_run->size.store(n + len, std::memory_order_relaxed);
+            return true;
+        }
+
+        if (!m_array.empty() || len < 2)
+            return false;
+
+        assign_constant(len, val);
+        return true;
+    }
+
+    void append_copies(size_t len, const _Data& val)
+    {
+        if (extend_constant(len, val))
+            return;
+
+        store_type& d = array();
+        for (; len; --len)
+            d.push_back(val);
+    }
+
+    void prepend_copies(size_t len, const _Data& val)
+    {
+        if (extend_constant(len, val))
+            return;
+
+        store_type copies(len, val);
+        store_type& d = array();
+        d.insert(d.begin(), copies.begin(), copies.end());
+    }
+
+    bool equals_constant(size_t n, const _Data& val) const
+    {
+        const store_type& st = array();
+        if (st.size() != n)
+            return false;
+
+        for (const_iterator it = st.begin(), it_end = st.end(); it != it_end; ++it)
+        {
+            if (!(*it == val))
+                return false;
+        }
+
+        return true;
+    }
 };
 
-template<typename _Self, element_t _TypeId, typename _Data>
-class copyable_element_block : public element_block<_Self, _TypeId, _Data>
+template<typename _Self, element_t _TypeId, typename _Data,
+    typename _Store = typename detail::element_store_type<_Data>::type>
+class copyable_element_block : public element_block<_Self, _TypeId, _Data, _Store>
 {
-    typedef element_block<_Self,_TypeId,_Data> base_type;
+    typedef element_block<_Self,_TypeId,_Data,_Store> base_type;
 protected:
     copyable_element_block() : base_type() {}
     copyable_element_block(size_t n) : base_type(n) {}
@@ -438,10 +1190,11 @@ public:
     }
 };
 
-template<typename _Self, element_t _TypeId, typename _Data>
-class noncopyable_element_block : public element_block<_Self, _TypeId, _Data>
+template<typename _Self, element_t _TypeId, typename _Data,
+    typename _Store = typename detail::element_store_type<_Data>::type>
+class noncopyable_element_block : public element_block<_Self, _TypeId, _Data, _Store>
 {
-    typedef element_block<_Self,_TypeId,_Data> base_type;
+    typedef element_block<_Self,_TypeId,_Data,_Store> base_type;
 protected:
     noncopyable_element_block() : base_type() {}
     noncopyable_element_block(size_t n) : base_type(n) {}
@@ -472,15 +1225,67 @@ inline element_t get_block_type(const base_element_block& blk)
     return blk.type;
 }
 
+namespace detail {
+
+/**
+ * Add a reference to an element block that is about to be shared with
+ * another container.
+ */
+inline void add_block_ref(const base_element_block& blk)
+{
+    blk.ref_count.fetch_add(1, std::memory_order_relaxed);
+}
+
+/**
+ * Drop a reference to an element block.
+ *
+ * @return true if the caller held the last reference, in which case it is
+ *         responsible for deleting the block, or false if the block is
+ *         still referenced by another container.
+ */
+inline bool release_block_ref(const base_element_block& blk)
+{
+    if (blk.ref_count.load(std::memory_order_acquire) == 1)
+        return true;
+
+    return blk.ref_count.fetch_sub(1, std::memory_order_acq_rel) == 1;
+}
+
+inline bool is_block_shared(const base_element_block& blk)
+{
+    return blk.ref_count.load(std::memory_order_acquire) > 1;
+}
+
+/**
+ * Mutex that serializes the expansion of constant runs stored in element
+ * blocks.  Expansion happens at most once per block, so a single mutex
+ * shared by all blocks suffices.
+ */
+inline std::mutex& constant_run_mutex()
+{
+    static std::mutex mtx;
+    return mtx;
+}
+
+}
+
 /**
  * Template for default, unmanaged element block for use in
  * multi_type_vector.
+ *
+ * The optional third template parameter specifies the container type the
+ * block stores its elements in.  It must provide an interface compatible
+ * with that of std::vector, including random access iterators.  Use
+ * gap_buffer for a block that receives many insertions and erasures in
+ * the middle.
  */
-template<element_t _TypeId, typename _Data>
-struct default_element_block : public copyable_element_block<default_element_block<_TypeId,_Data>, _TypeId, _Data>
+template<element_t _TypeId, typename _Data,
+    typename _Store = typename detail::element_store_type<_Data>::type>
+struct default_element_block :
+    public copyable_element_block<default_element_block<_TypeId,_Data,_Store>, _TypeId, _Data, _Store>
 {
-    typedef copyable_element_block<default_element_block, _TypeId, _Data> base_type;
-    typedef default_element_block<_TypeId,_Data> self_type;
+    typedef copyable_element_block<default_element_block, _TypeId, _Data, _Store> base_type;
+    typedef default_element_block<_TypeId,_Data,_Store> self_type;
 
     default_element_block() : base_type() {}
     default_element_block(size_t n) : base_type(n) {}
@@ -491,7 +1296,24 @@ struct default_element_block : public copyable_element_block<default_element_blo
 
     static self_type* create_block_with_value(size_t init_size, const _Data& val)
     {
-        return new self_type(init_size, val);
+        if (init_size < 2)
+            return new self_type(init_size, val);
+
+        // Store the value only once, as a constant run.
+        std::unique_ptr<self_type> blk = make_unique<self_type>();
+        blk->assign_constant(init_size, val);
+        return blk.release();
+    }
+
+    static self_type* create_block_with_value(size_t init_size, _Data&& val)
+    {
+        // Only a block of size one can take over the value.
+        if (init_size != 1)
+            return create_block_with_value(init_size, static_cast<const _Data&>(val));
+
+        std::unique_ptr<self_type> blk = make_unique<self_type>();
+        self_type::append_value(*blk, std::move(val));
+        return blk.release();
     }
 
     template<typename _Iter>
@@ -32,6 +32,8 @@
 
 #include <string>
 #include <ostream>
+#include <type_traits>
+#include <utility>
 
 using namespace mdds;
 using namespace std;
@@ -720,6 +722,31 @@ void mtm_test_assignment()
     assert(mx_orig == mx_copied);
 }
 
+void mtm_test_move()
+{
+    stack_printer __stack_printer__("::mtm_test_move");
+    static_assert(std::is_nothrow_move_constructible<mtx_type>::value, "move constructor should be noexcept.");
+    static_assert(std::is_nothrow_move_assignable<mtx_type>::value, "move assignment should be noexcept.");
+
+    mtx_type mx_orig(5, 5, 1.2);
+    mx_orig.set(1, 1, string("foo"));
+    mtx_type mx_copied = mx_orig;
+
+    mtx_type mx_moved(std::move(mx_orig));
+    assert(mx_moved == mx_copied);
+    assert(mx_orig.empty());
+    assert(mx_orig.size() == mtx_type::size_pair_type(0, 0));
+
+    mtx_type mx_assigned(2, 2);
+    mx_assigned = std::move(mx_moved);
+    assert(mx_assigned == mx_copied);
+    assert(mx_moved.empty());
+
+    // A moved-from matrix can be reused.
+    mx_moved.resize(2, 2, true);
+    assert(mx_moved.get_boolean(1, 1));
+}
+
 void mtm_test_numeric()
 {
     // Numeric elements only matrix is numeric.
@@ -1099,6 +1126,7 @@ int main (int argc, char **argv)
             mtm_test_copy_empty_destination();
             mtm_test_copy_from_array();
             mtm_test_assignment();
+            mtm_test_move();
             mtm_test_numeric();
             mtm_test_custom_string();
             mtm_test_position();
@@ -33,9 +33,14 @@
 #include <mdds/multi_type_vector_custom_func1.hpp>
 #include <mdds/multi_type_vector_custom_func2.hpp>
 #include <mdds/multi_type_vector_custom_func3.hpp>
+#include <mdds/multi_type_vector/gap_buffer.hpp>
+#include <mdds/multi_type_vector/serialize.hpp>
 
 #include <cassert>
+#include <cstdint>
+#include <cstring>
 #include <sstream>
+#include <string>
 #include <vector>
 
 #include <boost/ptr_container/ptr_vector.hpp>
@@ -52,6 +57,8 @@ const mtv::element_t element_type_user_block  = mtv::element_type_user_start;
 const mtv::element_t element_type_muser_block = mtv::element_type_user_start+1;
 const mtv::element_t element_type_fruit_block = mtv::element_type_user_start+2;
 const mtv::element_t element_type_date_block  = mtv::element_type_user_start+3;
+const mtv::element_t element_type_movable_block = mtv::element_type_user_start+4;
+const mtv::element_t element_type_label_block = mtv::element_type_user_start+5;
 
 enum my_fruit_type { unknown_fruit = 0, apple, orange, mango, peach };
 
@@ -88,6 +95,47 @@ struct date
     date(int _year, int _month, int _day) : year(_year), month(_month), day(_day) {}
 };
 
+/** Cell type that counts how many times it gets copied. */
+struct movable_cell
+{
+    static size_t copy_count;
+
+    double value;
+
+    movable_cell() : value(0.0) {}
+    movable_cell(double _v) : value(_v) {}
+    movable_cell(const movable_cell& r) : value(r.value) { ++copy_count; }
+    movable_cell(movable_cell&& r) : value(r.value) { r.value = 0.0; }
+
+    movable_cell& operator= (const movable_cell& r)
+    {
+        value = r.value;
+        ++copy_count;
+        return *this;
+    }
+
+    movable_cell& operator= (movable_cell&& r)
+    {
+        value = r.value;
+        r.value = 0.0;
+        return *this;
+    }
+};
+
+size_t movable_cell::copy_count = 0;
+
+/** Cell type with a non-trivial copy and destruction. */
+struct label
+{
+    std::string text;
+
+    label() {}
+    label(const std::string& _text) : text(_text) {}
+
+    bool operator== (const label& r) const { return text == r.text; }
+    bool operator!= (const label& r) const { return text != r.text; }
+};
+
 template<typename T>
 class cell_pool
 {
@@ -122,11 +170,15 @@ typedef mdds::mtv::default_element_block<element_type_user_block, user_cell*> us
 typedef mdds::mtv::managed_element_block<element_type_muser_block, muser_cell> muser_cell_block;
 typedef mdds::mtv::default_element_block<element_type_fruit_block, my_fruit_type> fruit_block;
 typedef mdds::mtv::default_element_block<element_type_date_block, date> date_block;
+typedef mdds::mtv::default_element_block<element_type_movable_block, movable_cell> movable_cell_block;
+typedef mdds::mtv::default_element_block<element_type_label_block, label, mtv::gap_buffer<label>> label_block;
 
 MDDS_MTV_DEFINE_ELEMENT_CALLBACKS_PTR(user_cell, element_type_user_block, nullptr, user_cell_block)
 MDDS_MTV_DEFINE_ELEMENT_CALLBACKS_PTR(muser_cell, element_type_muser_block, nullptr, muser_cell_block)
 MDDS_MTV_DEFINE_ELEMENT_CALLBACKS(my_fruit_type, element_type_fruit_block, unknown_fruit, fruit_block)
 MDDS_MTV_DEFINE_ELEMENT_CALLBACKS(date, element_type_date_block, date(), date_block)
+MDDS_MTV_DEFINE_ELEMENT_CALLBACKS(movable_cell, element_type_movable_block, movable_cell(), movable_cell_block)
+MDDS_MTV_DEFINE_ELEMENT_CALLBACKS(label, element_type_label_block, label(), label_block)
 
 }
 
@@ -134,8 +186,14 @@ namespace {
 
 typedef multi_type_vector<mtv::custom_block_func2<user_cell_block, muser_cell_block> > mtv_type;
 typedef multi_type_vector<mtv::custom_block_func1<fruit_block> > mtv_fruit_type;
+typedef multi_type_vector<mtv::custom_block_func1<movable_cell_block> > mtv_movable_type;
+typedef multi_type_vector<mtv::custom_block_func1<label_block> > mtv_label_type;
 typedef multi_type_vector<
     mtv::custom_block_func3<muser_cell_block, fruit_block, date_block> > mtv3_type;
+typedef multi_type_vector<
+    mtv::element_block_funcs<
+        user_cell_block, muser_cell_block, fruit_block,
+        date_block, movable_cell_block, label_block> > mtv6_type;
 
 template<typename _ColT, typename _ValT>
 bool test_cell_insertion(_ColT& col_db, size_t row, _ValT val)
@@ -1663,6 +1721,424 @@ void mtv_test_construction_with_array()
     }
 }
 
+void mtv_test_move_values()
+{
+    stack_printer __stack_printer__("::mtv_test_move_values");
+    movable_cell::copy_count = 0;
+
+    mtv_movable_type db(6);
+    db.set(0, movable_cell(1.0)); // new block
+    db.set(1, movable_cell(2.0)); // append to the previous block
+    db.set(0, movable_cell(3.0)); // overwrite
+    db.set(5, movable_cell(4.0)); // new block at the end
+    db.set(4, movable_cell(5.0)); // prepend to the next block
+    mtv_movable_type::iterator it = db.set(3, 1.5);
+    db.set(it, 3, movable_cell(6.0)); // replace a block of size one
+    db.push_back(movable_cell(7.0));
+    assert(movable_cell::copy_count == 0);
+
+    assert(db.size() == 7);
+    assert(db.block_size() == 3);
+    assert(db.get<movable_cell>(0).value == 3.0);
+    assert(db.get<movable_cell>(1).value == 2.0);
+    assert(db.is_empty(2));
+    assert(db.get<movable_cell>(3).value == 6.0);
+    assert(db.get<movable_cell>(4).value == 5.0);
+    assert(db.get<movable_cell>(5).value == 4.0);
+    assert(db.get<movable_cell>(6).value == 7.0);
+
+    // Ranges of values get moved when passed via move iterators.
+    vector<movable_cell> vals = { 8.0, 9.0 };
+    movable_cell::copy_count = 0;
+    db.set(5, make_move_iterator(vals.begin()), make_move_iterator(vals.end()));
+    assert(movable_cell::copy_count == 0);
+    assert(db.get<movable_cell>(5).value == 8.0);
+    assert(db.get<movable_cell>(6).value == 9.0);
+
+    {
+        mtv_movable_type db2;
+        mtv_movable_type::builder builder(db2);
+        movable_cell::copy_count = 0;
+        builder.append(movable_cell(1.0));
+        builder.append(movable_cell(2.0));
+        assert(movable_cell::copy_count == 0);
+        assert(db2.block_size() == 1);
+        assert(db2.get<movable_cell>(1).value == 2.0);
+    }
+
+    // Lvalues still get copied.
+    movable_cell cell(10.0);
+    movable_cell::copy_count = 0;
+    db.set(0, cell);
+    db.push_back(cell);
+    assert(movable_cell::copy_count == 2);
+    assert(cell.value == 10.0);
+    assert(db.get<movable_cell>(7).value == 10.0);
+}
+
+void mtv_test_snapshot()
+{
+    stack_printer __stack_printer__("::mtv_test_snapshot");
+
+    // Managed blocks own their elements.  Each side must end up with its
+    // own copy of a block it modifies, and each element must get deleted
+    // exactly once.
+    mtv_type db(5);
+    db.set(0, new muser_cell(1.0));
+    db.set(1, new muser_cell(2.0));
+    db.set(3, new muser_cell(3.0));
+    db.set(4, 1.5);
+
+    mtv_type snap = db.snapshot();
+    assert(snap == db);
+    assert(snap.get<muser_cell*>(0) == db.get<muser_cell*>(0));
+
+    snap.set(1, new muser_cell(4.0));
+    assert(db.get<muser_cell*>(1)->value == 2.0);
+    assert(snap.get<muser_cell*>(1)->value == 4.0);
+    assert(snap.get<muser_cell*>(0) != db.get<muser_cell*>(0));
+    assert(snap.get<muser_cell*>(0)->value == 1.0);
+
+    db.set(3, new muser_cell(5.0));
+    assert(snap.get<muser_cell*>(3)->value == 3.0);
+    assert(db.get<muser_cell*>(3)->value == 5.0);
+
+    {
+        mtv_type snap2 = db.snapshot();
+        db.erase(0, 1);
+        assert(snap2.get<muser_cell*>(1)->value == 2.0);
+    }
+
+    db.clear();
+    assert(snap.get<muser_cell*>(3)->value == 3.0);
+}
+
+void mtv_test_set_sorted()
+{
+    stack_printer __stack_printer__("::mtv_test_set_sorted");
+
+    // Managed elements that get overwritten must be deleted exactly once,
+    // and the ones that get moved to new blocks must stay intact.
+    mtv_type db(8);
+    for (size_t i = 0; i < 6; ++i)
+        db.set(i, new muser_cell(i));
+    db.set(6, 1.5);
+
+    vector<pair<size_t, muser_cell*>> vals = {
+        { 1, new muser_cell(10.0) }, { 4, new muser_cell(11.0) }, { 7, new muser_cell(12.0) } };
+    db.set_sorted(vals.begin(), vals.end());
+    assert(db.block_size() == 3);
+    assert(db.get<muser_cell*>(1)->value == 10.0);
+    assert(db.get<muser_cell*>(4)->value == 11.0);
+    assert(db.get<muser_cell*>(5)->value == 5.0);
+    assert(db.get<muser_cell*>(7)->value == 12.0);
+
+    vector<pair<size_t, double>> nums = { { 0, 1.0 }, { 2, 2.0 }, { 3, 3.0 }, { 7, 4.0 } };
+    db.set_sorted(nums.begin(), nums.end());
+    assert(db.block_size() == 5);
+    assert(db.get<double>(0) == 1.0);
+    assert(db.get<muser_cell*>(1)->value == 10.0);
+    assert(db.get<double>(3) == 3.0);
+    assert(db.get<muser_cell*>(4)->value == 11.0);
+    assert(db.get<muser_cell*>(5)->value == 5.0);
+    assert(db.get<double>(6) == 1.5);
+    assert(db.get<double>(7) == 4.0);
+}
+
+void mtv_test_gap_buffer_block()
+{
+    stack_printer __stack_printer__("::mtv_test_gap_buffer_block");
+
+    // Insert and erase around a moving cursor directly in the buffer.
+    mtv::gap_buffer<label> buf;
+    vector<label> expected;
+    for (size_t i = 0; i < 50; ++i)
+    {
+        size_t pos = (i * 7) % (buf.size() + 1);
+        label v(std::to_string(i));
+        buf.insert(buf.begin() + pos, v);
+        expected.insert(expected.begin() + pos, v);
+        if (i % 5 == 4)
+        {
+            buf.erase(buf.begin() + pos / 2);
+            expected.erase(expected.begin() + pos / 2);
+        }
+    }
+    assert(buf.size() == expected.size());
+    assert(std::equal(buf.begin(), buf.end(), expected.begin()));
+    assert(std::equal(buf.rbegin(), buf.rend(), expected.rbegin()));
+
+    mtv::gap_buffer<label> buf2(buf);
+    assert(buf2 == buf);
+    buf2.shrink_to_fit();
+    assert(buf2.capacity() == buf2.size());
+    assert(buf2 == buf);
+    buf2.resize(10);
+    assert(buf2.size() == 10);
+    assert(std::equal(buf2.begin(), buf2.end(), expected.begin()));
+    buf2.resize(12);
+    assert(buf2[11].text.empty());
+
+    // Use it as the storage of an element block, and check the container
+    // against a plain array of values after a series of edits in the
+    // middle of the block.
+    mtv_label_type db(20, label("x"));
+    vector<string> model(20, "x");
+
+    auto check = [&]()
+    {
+        assert(db.size() == model.size());
+        for (size_t i = 0; i < model.size(); ++i)
+        {
+            if (model[i].empty())
+                assert(db.is_empty(i));
+            else
+                assert(db.get<label>(i).text == model[i]);
+        }
+
+        // Walk the elements via the element block iterators as well.
+        size_t pos = 0;
+        for (const mtv_label_type::value_type& blk : db)
+        {
+            if (blk.data)
+            {
+                label_block::const_iterator it = label_block::begin(*blk.data);
+                label_block::const_iterator it_end = label_block::end(*blk.data);
+                assert(size_t(it_end - it) == blk.size);
+                for (; it != it_end; ++it, ++pos)
+                    assert(it->text == model[pos]);
+            }
+            else
+                pos += blk.size;
+        }
+        assert(pos == model.size());
+    };
+
+    for (size_t i = 0; i < 200; ++i)
+    {
+        size_t pos = (i * 13) % db.size();
+        string v = std::to_string(i);
+        switch (i % 5)
+        {
+            case 0:
+            case 1:
+            {
+                vector<label> vals(i % 3 + 1, label(v));
+                db.insert(pos, vals.begin(), vals.end());
+                model.insert(model.begin() + pos, vals.size(), v);
+                break;
+            }
+            case 2:
+                db.set(pos, label(v));
+                model[pos] = v;
+                break;
+            case 3:
+            {
+                size_t end_pos = std::min(pos + 2, db.size() - 1);
+                db.erase(pos, end_pos);
+                model.erase(model.begin() + pos, model.begin() + end_pos + 1);
+                break;
+            }
+            case 4:
+                db.set_empty(pos, pos);
+                model[pos].clear();
+                break;
+        }
+        check();
+    }
+
+    mtv_label_type db2(db);
+    assert(db2 == db);
+    db2.set(0, label("changed"));
+    assert(db2 != db);
+}
+
+void mtv_test_element_block_funcs()
+{
+    stack_printer __stack_printer__("::mtv_test_element_block_funcs");
+
+    static_assert(
+        std::is_base_of<mtv::element_block_funcs<fruit_block>, mtv::custom_block_func1<fruit_block>>::value,
+        "custom_block_func1 should be an element_block_funcs with one block type.");
+
+    // Store one standard and six user-defined types in blocks of two.
+    user_cell_pool pool;
+    mtv6_type db(12);
+    db.set(0, 1.5);
+    db.set(1, 2.5);
+    db.set(2, pool.construct(1.0));
+    db.set(3, pool.construct(2.0));
+    db.set(4, new muser_cell(3.0));
+    db.set(5, new muser_cell(4.0));
+    db.set(6, apple);
+    db.set(7, orange);
+    db.set(8, date(2017, 1, 2));
+    db.set(9, date(2017, 3, 4));
+    db.set(10, movable_cell(5.0));
+    db.set(11, movable_cell(6.0));
+    db.push_back(label("a"));
+    db.push_back(label("b"));
+    assert(db.size() == 14);
+    assert(db.block_size() == 7);
+
+    const mtv::element_t types[] = {
+        mtv::element_type_numeric, element_type_user_block, element_type_muser_block,
+        element_type_fruit_block, element_type_date_block, element_type_movable_block,
+        element_type_label_block
+    };
+
+    auto check = [&types](const mtv6_type& col, size_t offset)
+    {
+        for (size_t i = 0; i < col.size(); ++i)
+            assert(col.get_type(i) == types[(i+offset)/2]);
+    };
+
+    check(db, 0);
+
+    // Copying clones each block, and inserting into the copy appends to
+    // and splits the blocks of each type.
+    mtv6_type db2(db);
+    check(db2, 0);
+    assert(db2.get<double>(1) == 2.5);
+    assert(db2.get<user_cell*>(3)->value == 2.0);
+    assert(db2.get<muser_cell*>(5)->value == 4.0);
+    assert(db2.get<my_fruit_type>(7) == orange);
+    assert(db2.get<date>(9).month == 3);
+    assert(db2.get<movable_cell>(11).value == 6.0);
+    assert(db2.get<label>(13).text == "b");
+
+    // Overwrite a managed cell and the cells around it.
+    db2.set(4, new muser_cell(7.0));
+    assert(db2.get<muser_cell*>(4)->value == 7.0);
+    db2.set(5, mango);
+    db2.set(6, peach);
+    assert(db2.get_type(5) == element_type_fruit_block);
+    assert(db2.block_size() == 7);
+
+    // Erase the second element of each block, which merges nothing.
+    for (size_t i = 0; i < 7; ++i)
+        db.erase(i+1, i+1);
+    assert(db.size() == 7);
+    assert(db.block_size() == 7);
+    for (size_t i = 0; i < db.size(); ++i)
+        assert(db.get_type(i) == types[i]);
+
+    assert(db.get<date>(4).year == 2017);
+    assert(db.get<label>(6).text == "a");
+
+    // Swap the user-defined blocks between the two containers.
+    db.swap(1, 6, db2, 2);
+    assert(db.get_type(1) == element_type_user_block);
+    assert(db.get_type(2) == element_type_user_block);
+    assert(db.get<muser_cell*>(3)->value == 7.0);
+    assert(db.get<my_fruit_type>(4) == mango);
+    assert(db.get<my_fruit_type>(6) == orange);
+    for (size_t i = 0; i < 6; ++i)
+        assert(db2.get_type(i+2) == types[i+1]);
+
+    // Transfer them back into an empty container.
+    mtv6_type db3(db.size());
+    db.transfer(0, db.size()-1, db3, 0);
+    assert(db.is_empty(0) && db.block_size() == 1);
+    assert(db3.get<double>(0) == 1.5);
+    assert(db3.get<muser_cell*>(3)->value == 7.0);
+
+    db3.shrink_to_fit();
+    db3.resize(4);
+    assert(db3.block_size() == 3);
+    assert(db3.get<muser_cell*>(3)->value == 7.0);
+}
+
+/** Serializer of fruit blocks, which stores each value as a 32-bit integer. */
+struct fruit_serializer
+{
+    bool write_block(const mtv::base_element_block& data, std::ostream& os) const
+    {
+        if (mtv::get_block_type(data) != element_type_fruit_block)
+            return false;
+
+        fruit_block::const_iterator it = fruit_block::begin(data), it_end = fruit_block::end(data);
+        for (; it != it_end; ++it)
+        {
+            int32_t v = *it;
+            os.write(reinterpret_cast<const char*>(&v), sizeof(v));
+        }
+        return true;
+    }
+
+    template<typename _Builder>
+    bool read_block(
+        mtv::element_t type, size_t size, const char* payload, size_t payload_size, _Builder& builder) const
+    {
+        if (type != element_type_fruit_block || payload_size != size * sizeof(int32_t))
+            return false;
+
+        vector<my_fruit_type> vals;
+        vals.reserve(size);
+        for (size_t i = 0; i < size; ++i)
+        {
+            int32_t v;
+            std::memcpy(&v, payload + i * sizeof(v), sizeof(v));
+            vals.push_back(static_cast<my_fruit_type>(v));
+        }
+
+        builder.append(vals.begin(), vals.end());
+        return true;
+    }
+};
+
+void mtv_test_serialize_custom_block()
+{
+    stack_printer __stack_printer__("::mtv_test_serialize_custom_block");
+
+    mtv_fruit_type db(10);
+    db.set(0, apple);
+    db.set(1, orange);
+    db.set(2, 1.5);
+    db.set(3, string("foo"));
+    db.set(7, mango);
+    db.set(8, peach);
+
+    std::ostringstream os;
+    mtv::serialize(db, os, fruit_serializer());
+
+    mtv_fruit_type loaded;
+    std::istringstream is(os.str());
+    mtv::deserialize(loaded, is, fruit_serializer());
+    assert(loaded.size() == db.size());
+    assert(loaded.block_size() == db.block_size());
+    assert(loaded.get<my_fruit_type>(1) == orange);
+    assert(loaded.get<double>(2) == 1.5);
+    assert(loaded.get<string>(3) == "foo");
+    assert(loaded.is_empty(4));
+    assert(loaded.get<my_fruit_type>(7) == mango);
+    assert(loaded.get<my_fruit_type>(8) == peach);
+
+    // Without a serializer for the fruit blocks, neither direction works.
+    try
+    {
+        std::ostringstream os2;
+        mtv::serialize(db, os2);
+        assert(!"exception should have been thrown");
+    }
+    catch (const general_error&)
+    {
+        // expected.
+    }
+
+    try
+    {
+        is.clear();
+        is.str(os.str());
+        mtv::deserialize(loaded, is);
+        assert(!"exception should have been thrown");
+    }
+    catch (const general_error&)
+    {
+        // expected.
+    }
+}
+
 }
 
 int main (int argc, char **argv)
@@ -1680,6 +2156,12 @@ int main (int argc, char **argv)
         mtv_test_custom_block_func3();
         mtv_test_release();
         mtv_test_construction_with_array();
+        mtv_test_move_values();
+        mtv_test_snapshot();
+        mtv_test_set_sorted();
+        mtv_test_gap_buffer_block();
+        mtv_test_element_block_funcs();
+        mtv_test_serialize_custom_block();
     }
     catch (const std::exception& e)
     {
@@ -30,11 +30,27 @@
 #define MDDS_MULTI_TYPE_VECTOR_DEBUG 1
 #include <mdds/multi_type_vector.hpp>
 #include <mdds/multi_type_vector_trait.hpp>
+#include <mdds/multi_type_vector/aggregate.hpp>
+#include <mdds/multi_type_vector/diff.hpp>
+#include <mdds/multi_type_vector/parallel.hpp>
+#include <mdds/multi_type_vector/serialize.hpp>
 
 #include <cassert>
+#include <cstring>
 #include <sstream>
 #include <vector>
 #include <deque>
+#include <memory>
+#include <functional>
+#include <type_traits>
+#include <utility>
+#include <mutex>
+#include <atomic>
+#include <numeric>
+#include <limits>
+#include <thread>
+#include <algorithm>
+#include <stdexcept>
 
 #include <boost/ptr_container/ptr_vector.hpp>
 
@@ -2249,6 +2265,23 @@ void mtv_test_set_cells()
         assert(db.get<string>(7) == "c");
         assert(db.get<string>(8) == "d");
     }
+
+    {
+        // The range starts in a block of the same type, and
+        // ends at the bottom of a block of a different type, which is
+        // followed by yet another block of the same type.
+        mtv_type db(6, 1.1);
+        db.set(2, string("foo"));
+        db.set_empty(3, 3);
+        assert(db.block_size() == 4);
+
+        vector<double> vals(3, 2.2);
+        db.set(1, vals.begin(), vals.end());
+        assert(db.block_size() == 1);
+        assert(db.get<double>(0) == 1.1);
+        assert(db.get<double>(3) == 2.2);
+        assert(db.get<double>(4) == 1.1);
+    }
 }
 
 void mtv_test_insert_cells()
@@ -5111,22 +5144,2108 @@ void mtv_test_push_back()
 void mtv_test_capacity()
 {
     stack_printer __stack_printer__("::mtv_test_capacity");
-    mtv_type db(10, 1.1);
+    mtv_type db(20, 1.1);
     assert(db.block_size() == 1);
     mtv_type::const_iterator it = db.begin();
     assert(it->type == mtv::element_type_numeric);
+
+    // The block stores its only value once until one of its elements gets
+    // modified.
+    assert(mtv::numeric_element_block::is_constant(*it->data));
+    db.set(0, 1.2);
+    it = db.begin();
+    assert(!mtv::numeric_element_block::is_constant(*it->data));
     size_t cap = mtv::numeric_element_block::capacity(*it->data);
-    assert(cap == 10);
+    assert(cap == 20);
 
-    db.set_empty(3, 3);
+    // Element blocks store a few elements inline, so make the remaining
+    // block large enough to still need heap storage.
+    db.set_empty(6, 6);
     assert(db.block_size() == 3);
     db.shrink_to_fit();
     it = db.begin();
     assert(it->type == mtv::element_type_numeric);
     cap = mtv::numeric_element_block::capacity(*it->data);
-    assert(cap == 3);
+    assert(cap == 6);
+}
+
+/**
+ * Check the block lookup for every logical position against the block
+ * positions obtained from walking the blocks from the top.
+ */
+bool check_block_lookup(const mtv_type& db)
+{
+    size_t pos = 0;
+    mtv_type::const_iterator it = db.begin(), it_end = db.end();
+    for (; it != it_end; ++it)
+    {
+        if (it->position != pos)
+            return false;
+
+        for (size_t i = 0; i < it->size; ++i, ++pos)
+        {
+            mtv_type::const_position_type found = db.position(pos);
+            if (found.first != it || found.second != i)
+                return false;
+
+            if (db.get_type(pos) != it->type)
+                return false;
+        }
+    }
+
+    return pos == db.size();
+}
+
+void mtv_test_block_position_lookup()
+{
+    stack_printer __stack_printer__("::mtv_test_block_position_lookup");
+
+    mtv_type db;
+    for (size_t i = 0; i < 20; ++i)
+    {
+        switch (i % 3)
+        {
+            case 0:
+                db.push_back(1.1);
+                break;
+            case 1:
+                db.push_back(string("foo"));
+                break;
+            default:
+                db.push_back_empty();
+        }
+    }
+
+    assert(db.block_size() == 20);
+    assert(check_block_lookup(db));
+
+    db.resize(25);
+    assert(db.block_size() == 21);
+    assert(check_block_lookup(db));
+
+    db.insert_empty(4, 3);
+    assert(db.size() == 28);
+    assert(check_block_lookup(db));
+
+    db.erase(2, 9);
+    assert(db.size() == 20);
+    assert(check_block_lookup(db));
+
+    string val = db.release<string>(5);
+    assert(val == "foo");
+    assert(check_block_lookup(db));
+
+    db.set(12, 2.2);
+    db.set(13, 2.3);
+    assert(check_block_lookup(db));
+
+    db.resize(11);
+    assert(check_block_lookup(db));
+
+    mtv_type db2(5, true);
+    db.transfer(3, 6, db2, 1);
+    assert(check_block_lookup(db));
+    assert(check_block_lookup(db2));
+
+    db.swap(0, 4, db2, 0);
+    assert(check_block_lookup(db));
+    assert(check_block_lookup(db2));
+
+    db.swap(db2);
+    assert(db.size() == 5);
+    assert(db2.size() == 11);
+    assert(check_block_lookup(db));
+    assert(check_block_lookup(db2));
+
+    mtv_type db3(db2);
+    assert(check_block_lookup(db3));
+    db3.push_back(string("bar"));
+    db3.push_back(string("baz"));
+    assert(check_block_lookup(db3));
+    assert(db3.get<string>(12) == "baz");
+
+    db3.clear();
+    assert(check_block_lookup(db3));
+    db3.push_back(1.0);
+    assert(check_block_lookup(db3));
+}
+
+void mtv_test_small_element_blocks()
+{
+    stack_printer __stack_printer__("::mtv_test_small_element_blocks");
+
+    // Grow string blocks one element at a time from both ends, past the
+    // number of elements that fit inline in an element block.
+    mtv_type db(1, string("c"));
+    db.push_back(string("d"));
+    db.push_back(string("e"));
+    db.insert_empty(0, 2);
+    db.set(1, string("b"));
+    db.set(0, string("a"));
+    assert(db.block_size() == 1);
+    assert(db.size() == 5);
+
+    const char* expected[] = { "a", "b", "c", "d", "e" };
+    for (size_t i = 0; i < ARRAY_SIZE(expected); ++i)
+        assert(db.get<string>(i) == expected[i]);
+
+    // Split the block in the middle, and shrink the pieces back.
+    db.set(2, 1.5);
+    assert(db.block_size() == 3);
+    assert(db.get<string>(0) == "a");
+    assert(db.get<string>(1) == "b");
+    assert(db.get<double>(2) == 1.5);
+    assert(db.get<string>(3) == "d");
+    assert(db.get<string>(4) == "e");
+    db.shrink_to_fit();
+
+    // Merge them again.
+    db.set(2, string("c"));
+    assert(db.block_size() == 1);
+    for (size_t i = 0; i < ARRAY_SIZE(expected); ++i)
+        assert(db.get<string>(i) == expected[i]);
+
+    // Copies and swaps of containers with small blocks.
+    mtv_type db2(db);
+    assert(db2 == db);
+    db2.erase(1, 3);
+    assert(db2.size() == 2);
+    assert(db2.get<string>(0) == "a");
+    assert(db2.get<string>(1) == "e");
+
+    db.swap(0, 1, db2, 0);
+    assert(db.get<string>(0) == "a");
+    assert(db.get<string>(1) == "e");
+    assert(db2.get<string>(0) == "a");
+    assert(db2.get<string>(1) == "b");
+
+    // Alternate the element type at every position.
+    mtv_type db3(12);
+    for (size_t i = 0; i < db3.size(); ++i)
+    {
+        if (i % 2)
+            db3.set(i, string("foo"));
+        else
+            db3.set(i, static_cast<double>(i));
+    }
+    assert(db3.block_size() == 12);
+
+    mtv_type db4 = db3;
+    assert(db4 == db3);
+    db3.set(1, 0.5);
+    db3.set(3, 0.5);
+    assert(db3.block_size() == 8);
+    assert(db4 != db3);
+    assert(db3.get<double>(4) == 4.0);
+    assert(db3.get<string>(5) == "foo");
+}
+
+/**
+ * Memory resource that allocates from the global heap, and keeps track of
+ * the number and the total size of allocations that have not been freed.
+ */
+class counting_memory_resource : public mtv::memory_resource
+{
+    size_t m_allocated;
+    size_t m_live;
+    size_t m_live_bytes;
+
+public:
+    counting_memory_resource() : m_allocated(0), m_live(0), m_live_bytes(0) {}
+
+    virtual void* allocate(size_t size, size_t) override
+    {
+        ++m_allocated;
+        ++m_live;
+        m_live_bytes += size;
+        return ::operator new(size);
+    }
+
+    virtual void deallocate(void* p, size_t size, size_t) override
+    {
+        assert(m_live > 0);
+        assert(m_live_bytes >= size);
+        --m_live;
+        m_live_bytes -= size;
+        ::operator delete(p);
+    }
+
+    size_t allocated() const { return m_allocated; }
+    size_t live() const { return m_live; }
+    size_t live_bytes() const { return m_live_bytes; }
+};
+
+/**
+ * Value type whose copy constructor throws on request, to test that
+ * element blocks do not leak when populating them throws.
+ */
+struct throwing_copy
+{
+    bool fail;
+
+    throwing_copy(bool _fail = false) : fail(_fail) {}
+
+    throwing_copy(const throwing_copy& r) : fail(r.fail)
+    {
+        if (fail)
+            throw std::runtime_error("copy failed");
+    }
+
+    throwing_copy& operator= (const throwing_copy& r)
+    {
+        fail = r.fail;
+        return *this;
+    }
+
+    bool operator== (const throwing_copy& r) const { return fail == r.fail; }
+};
+
+typedef mtv::default_element_block<mtv::element_type_user_start, throwing_copy> throwing_copy_block;
+
+void mtv_test_memory_resource()
+{
+    stack_printer __stack_printer__("::mtv_test_memory_resource");
+
+    counting_memory_resource res;
+    {
+        unique_ptr<mtv_type> db;
+        {
+            mtv::scoped_memory_resource scope(res);
+            db.reset(new mtv_type(10));
+            db->set(0, 1.1);
+            db->set(1, string("foo"));
+            db->set(2, true);
+            db->set(4, static_cast<int>(12));
+
+            // Large enough to store its elements outside the element block.
+            vector<double> vals(20, 2.2);
+            db->set(5, vals.begin(), vals.begin()+5);
+            db->resize(30);
+            db->set(10, vals.begin(), vals.end());
+        }
+
+        assert(res.allocated() > 0);
+        assert(res.live() > 0);
+        size_t allocated = res.allocated();
+
+        // Memory allocated outside the scope does not come from the
+        // resource, but the memory from it still gets returned to it.
+        db->set(1, 3.3);
+        db->push_back(string("bar"));
+        assert(res.allocated() == allocated);
+        assert(db->get<double>(0) == 1.1);
+        assert(db->get<double>(1) == 3.3);
+        assert(db->get<bool>(2) == true);
+        assert(db->get<int>(4) == 12);
+        assert(db->get<double>(29) == 2.2);
+        assert(db->get<string>(30) == "bar");
+
+        mtv_type db2(*db);
+        db.reset();
+        assert(res.live() == 0);
+        assert(db2.get<double>(29) == 2.2);
+    }
+
+    // Scopes can be nested.
+    counting_memory_resource res2;
+    {
+        mtv::scoped_memory_resource scope(res);
+        {
+            mtv::scoped_memory_resource scope2(res2);
+            mtv_type db(5, 1.1);
+            assert(res2.live() > 0);
+        }
+        assert(res2.live() == 0);
+
+        size_t allocated = res.allocated();
+        mtv_type db(5, string("foo"));
+        assert(res.allocated() > allocated);
+    }
+    assert(res.live() == 0);
+    assert(res.live_bytes() == 0);
+
+    // An element block and its storage take no more memory from the
+    // memory resource than their own size.
+    {
+        mtv::base_element_block* blk = nullptr;
+        {
+            mtv::scoped_memory_resource scope(res);
+            blk = mtv::numeric_element_block::create_block(0);
+            assert(res.live() == 1);
+            assert(res.live_bytes() == sizeof(mtv::numeric_element_block));
+            mtv::numeric_element_block::resize_block(*blk, 100);
+            assert(res.live() == 2);
+            assert(res.live_bytes() == sizeof(mtv::numeric_element_block) + 100*sizeof(double));
+        }
+
+        // Growing the storage outside the scope moves it to the global
+        // heap, and returns the old storage to the memory resource.
+        mtv::numeric_element_block::resize_block(*blk, 200);
+        assert(res.live() == 1);
+        mtv::numeric_element_block::delete_block(blk);
+        assert(res.live() == 0);
+
+        // The state of a constant run comes from the same memory resource
+        // as its block, and gets freed once the block gets modified.
+        {
+            mtv::scoped_memory_resource scope(res);
+            blk = mtv::string_element_block::create_block_with_value(1000, string("foo"));
+            assert(mtv::string_element_block::is_constant(*blk));
+            assert(res.live() == 2);
+        }
+
+        mtv::string_element_block::set_value(*blk, 10, string("bar"));
+        assert(!mtv::string_element_block::is_constant(*blk));
+        assert(res.live() == 1);
+        mtv::string_element_block::delete_block(blk);
+        assert(res.live() == 0);
+
+        // A block whose constant run fails to get populated gets freed.
+        {
+            mtv::scoped_memory_resource scope(res);
+            try
+            {
+                throwing_copy_block::create_block_with_value(10, throwing_copy(true));
+                assert(!"exception expected");
+            }
+            catch (const std::runtime_error&)
+            {
+            }
+            assert(res.live() == 0);
+        }
+    }
+
+    // Build and discard a container in an arena.
+    mtv::arena arena(256);
+    {
+        mtv::scoped_memory_resource scope(arena);
+        mtv_type db;
+        for (size_t i = 0; i < 100; ++i)
+        {
+            if (i % 3)
+                db.push_back(static_cast<double>(i));
+            else
+                db.push_back(string("foo"));
+        }
+
+        assert(db.block_size() == 67);
+        assert(db.get<double>(98) == 98.0);
+        assert(db.get<string>(99) == "foo");
+    }
+
+    // Memory freed to a recycling pool gets handed out again for the next
+    // allocation of the same size class, and larger allocations bypass it.
+    mtv::recycling_pool pool(256, 1024);
+    void* p1 = pool.allocate(40, 8);
+    void* p2 = pool.allocate(40, 8);
+    assert(p1 != p2);
+    pool.deallocate(p1, 40, 8);
+    assert(pool.allocate(33, 8) == p1);
+    void* p3 = pool.allocate(1000, 8);
+    pool.deallocate(p3, 1000, 8);
+    pool.deallocate(p2, 40, 8);
+    pool.deallocate(p1, 33, 8);
+
+    {
+        mtv::scoped_memory_resource scope(pool);
+        mtv_type db(100);
+        for (size_t i = 0; i < 1000; ++i)
+        {
+            // Split and merge blocks in the middle over and over.
+            size_t pos = 10 + i % 80;
+            if (i % 2)
+                db.set(pos, static_cast<double>(i));
+            else
+                db.set(pos, string("foo"));
+
+            db.set_empty(pos, pos);
+        }
+
+        assert(db.block_size() == 1);
+        db.set(50, 1.5);
+        db.set(51, string("bar"));
+        mtv_type db2(db);
+        assert(db2.get<double>(50) == 1.5);
+        assert(db2.get<string>(51) == "bar");
+    }
+
+    // Memory from a recycling pool may be freed on other threads while it
+    // is in use on this one.
+    {
+        vector<mtv_type> dbs(4);
+        {
+            mtv::scoped_memory_resource scope(pool);
+            for (mtv_type& db : dbs)
+            {
+                for (size_t i = 0; i < 200; ++i)
+                {
+                    if (i % 2)
+                        db.push_back(static_cast<double>(i));
+                    else
+                        db.push_back(string("foo"));
+                }
+            }
+        }
+
+        vector<std::thread> threads;
+        for (mtv_type& db : dbs)
+            threads.emplace_back([&db]() { db.clear(); });
+
+        {
+            mtv::scoped_memory_resource scope(pool);
+            mtv_type db;
+            for (size_t i = 0; i < 200; ++i)
+                db.push_back(i % 2 ? 1.0 : 2.0);
+            assert(db.block_size() == 1);
+        }
+
+        for (std::thread& t : threads)
+            t.join();
+
+        for (const mtv_type& db : dbs)
+            assert(db.empty());
+    }
+}
+
+
+void mtv_test_builder()
+{
+    stack_printer __stack_printer__("::mtv_test_builder");
+
+    mtv_type db;
+    {
+        mtv_type::builder builder(db, 10);
+        vector<double> vals = { 1.1, 1.2, 1.3 };
+        builder.append(vals.begin(), vals.end());
+        builder.append(1.4);
+        builder.append_empty(2);
+        builder.append_empty(1);
+        vector<string> strs = { "A", "B" };
+        builder.append(strs.begin(), strs.end());
+        builder.append(strs.begin(), strs.begin()); // empty run
+        builder.append(string("C"));
+        builder.append(true);
+        builder.append_empty(0);
+    }
+
+    // Runs of the same type should all be merged.
+    assert(db.size() == 11);
+    assert(db.block_size() == 4);
+    assert(check_block_lookup(db));
+
+    mtv_type::const_iterator it = db.begin();
+    assert(it->type == mtv::element_type_numeric);
+    assert(it->size == 4);
+    ++it;
+    assert(it->type == mtv::element_type_empty);
+    assert(it->size == 3);
+    ++it;
+    assert(it->type == mtv::element_type_string);
+    assert(it->size == 3);
+    ++it;
+    assert(it->type == mtv::element_type_boolean);
+    assert(it->size == 1);
+
+    assert(db.get<double>(0) == 1.1);
+    assert(db.get<double>(3) == 1.4);
+    assert(db.is_empty(4));
+    assert(db.is_empty(6));
+    assert(db.get<string>(7) == "A");
+    assert(db.get<string>(9) == "C");
+    assert(db.get<bool>(10) == true);
+
+    // It should produce the same container as the one built via push_back.
+    mtv_type db2;
+    db2.push_back(1.1);
+    db2.push_back(1.2);
+    db2.push_back(1.3);
+    db2.push_back(1.4);
+    for (int i = 0; i < 3; ++i)
+        db2.push_back_empty();
+    db2.push_back(string("A"));
+    db2.push_back(string("B"));
+    db2.push_back(string("C"));
+    db2.push_back(true);
+    assert(db == db2);
+
+    // Append to a non-empty container, and keep using it normally.
+    {
+        mtv_type::builder builder(db);
+        builder.append(true);
+        builder.append_empty(2);
+    }
+    assert(db.size() == 14);
+    assert(db.block_size() == 5);
+    assert(check_block_lookup(db));
+
+    db.set(12, 5.5);
+    assert(db.get<double>(12) == 5.5);
+    assert(check_block_lookup(db));
+}
+
+
+void mtv_test_move()
+{
+    stack_printer __stack_printer__("::mtv_test_move");
+    static_assert(std::is_nothrow_move_constructible<mtv_type>::value, "move constructor should be noexcept.");
+    static_assert(std::is_nothrow_move_assignable<mtv_type>::value, "move assignment should be noexcept.");
+
+    mtv_type db(10, 1.1);
+    db.set(2, string("foo"));
+    db.set(5, true);
+    mtv_type db_copied = db;
+
+    mtv_type db_moved(std::move(db));
+    assert(db_moved == db_copied);
+    assert(check_block_lookup(db_moved));
+    assert(db.empty());
+    assert(db.block_size() == 0);
+
+    mtv_type db_assigned(4, string("bar"));
+    db_assigned = std::move(db_moved);
+    assert(db_assigned == db_copied);
+    assert(db_moved.empty());
+    assert(db_moved.block_size() == 0);
+
+    // A moved-from container can be reused.
+    db_moved.push_back(1.5);
+    db_moved.resize(3);
+    assert(db_moved.size() == 3);
+    assert(db_moved.get<double>(0) == 1.5);
+
+    // Containers can be returned from functions and stored in vectors
+    // without copying their element blocks.
+    vector<mtv_type> columns;
+    for (int i = 0; i < 10; ++i)
+    {
+        mtv_type col(4, static_cast<double>(i));
+        col.set(1, string("col"));
+        columns.push_back(std::move(col));
+    }
+    assert(columns.size() == 10);
+    for (size_t i = 0; i < columns.size(); ++i)
+    {
+        assert(columns[i].block_size() == 3);
+        assert(columns[i].get<double>(3) == static_cast<double>(i));
+    }
+
+    // Moving a container whose memory comes from a different memory
+    // resource than that of the destination takes over its block array
+    // as is, rather than copying the blocks one by one into new storage.
+    counting_memory_resource res1, res2, res3;
+    {
+        unique_ptr<mtv_type> src, dst;
+        {
+            mtv::scoped_memory_resource scope(res1);
+            src.reset(new mtv_type(10, 1.1));
+            src->set(2, string("foo"));
+            src->set(5, true);
+        }
+        {
+            mtv::scoped_memory_resource scope(res2);
+            dst.reset(new mtv_type(4, string("bar")));
+            dst->set(1, 2.2);
+        }
+
+        const mtv::base_element_block* data = src->begin()->data;
+        size_t live1 = res1.live();
+        {
+            mtv::scoped_memory_resource scope(res3);
+            *dst = std::move(*src);
+            mtv_type moved(std::move(*dst));
+            assert(moved.begin()->data == data);
+            assert(moved.get<string>(2) == "foo");
+            *dst = std::move(moved);
+        }
+
+        assert(res3.allocated() == 0);
+        assert(res1.live() == live1);
+        assert(res2.live() == 0);
+        assert(dst->begin()->data == data);
+        assert(dst->get<bool>(5));
+
+        dst.reset();
+        assert(res1.live() == 0);
+    }
+}
+
+
+void mtv_test_snapshot()
+{
+    stack_printer __stack_printer__("::mtv_test_snapshot");
+
+    // numeric (0-3), string (4-5), empty (6-7), boolean (8-9)
+    mtv_type db(10);
+    for (int i = 0; i < 4; ++i)
+        db.set(i, 1.0 + i);
+    db.set(4, string("A"));
+    db.set(5, string("B"));
+    db.set(8, true);
+    db.set(9, false);
+
+    {
+        mtv_type snap = db.snapshot();
+        assert(snap == db);
+        assert(check_block_lookup(snap));
+
+        // All element blocks are shared.
+        mtv_type::const_iterator it = db.begin(), it_snap = snap.begin();
+        for (; it != db.end(); ++it, ++it_snap)
+            assert(it->data == it_snap->data);
+
+        // Modifying the source clones only the blocks being modified and
+        // their neighbors.
+        db.set(0, 9.9);
+        assert(db.get<double>(0) == 9.9);
+        assert(snap.get<double>(0) == 1.0);
+        assert(db.begin()->data != snap.begin()->data);
+        it = db.begin();
+        it_snap = snap.begin();
+        std::advance(it, 3);
+        std::advance(it_snap, 3);
+        assert(it->data == it_snap->data);
+
+        // Modifying the snapshot doesn't affect the source.
+        snap.set(9, 1.5);
+        assert(snap.get<double>(9) == 1.5);
+        assert(db.get<bool>(9) == false);
+        assert(check_block_lookup(db));
+        assert(check_block_lookup(snap));
+    }
+
+    // The snapshot is gone. The source should be intact.
+    assert(db.get<double>(0) == 9.9);
+    assert(db.get<string>(5) == "B");
+    assert(db.get<bool>(9) == false);
+
+    // A snapshot survives its source.
+    {
+        unique_ptr<mtv_type> src(new mtv_type(db));
+        mtv_type snap = src->snapshot();
+        src.reset();
+        assert(snap == db);
+    }
+
+    // Apply various modifications to the source of a snapshot, and check
+    // that they produce the same result as on a deep copy, while leaving
+    // the snapshot unchanged.
+    typedef std::function<void(mtv_type&)> func_type;
+    std::vector<func_type> funcs = {
+        [](mtv_type& r) { r.set(3, string("C")); },
+        [](mtv_type& r) { r.set(6, 2.5); },
+        [](mtv_type& r) { r.set(7, true); },
+        [](mtv_type& r) { r.set(r.begin(), 1, string("D")); },
+        [](mtv_type& r) { std::vector<double> v(4, 3.5); r.set(2, v.begin(), v.end()); },
+        [](mtv_type& r) { std::vector<string> v(2, "E"); r.insert(6, v.begin(), v.end()); },
+        [](mtv_type& r) { r.push_back(true); },
+        [](mtv_type& r) { r.push_back(4.5); },
+        [](mtv_type& r) { r.set_empty(3, 4); },
+        [](mtv_type& r) { r.set_empty(4, 5); },
+        [](mtv_type& r) { r.erase(4, 7); },
+        [](mtv_type& r) { r.erase(1, 2); },
+        [](mtv_type& r) { r.insert_empty(2, 3); },
+        [](mtv_type& r) { r.resize(3); },
+        [](mtv_type& r) { r.resize(15); },
+        [](mtv_type& r) { double v; r.release(1, v); },
+        [](mtv_type& r) { r.release<double>(0); },
+        [](mtv_type& r) { double v; r.release(r.begin(), 2, v); },
+        [](mtv_type& r) { r.release<bool>(9); },
+        [](mtv_type& r) { r.release_range(3, 8); },
+        [](mtv_type& r) { r.shrink_to_fit(); },
+        [](mtv_type& r) { mtv_type other(5, 1.2); r.swap(2, 5, other, 0); },
+        [](mtv_type& r) { mtv_type other(10, 1.2); r.transfer(3, 8, other, 0); },
+        [](mtv_type& r) { mtv_type other(10, string("F")); other.swap(0, 9, r, 0); },
+        [](mtv_type& r) { mtv_type other(10, 2.2); other.transfer(2, 4, r, 0); },
+        [](mtv_type& r) { mtv_type::builder builder(r); builder.append(true); },
+        [](mtv_type& r) { r.clear(); r.push_back(1.1); },
+    };
+
+    for (const func_type& f : funcs)
+    {
+        mtv_type expected(db);
+        f(expected);
+
+        mtv_type src(db);
+        mtv_type snap = src.snapshot();
+        f(src);
+        assert(src == expected);
+        assert(snap == db);
+        assert(check_block_lookup(src));
+        assert(check_block_lookup(snap));
+
+        // The same modification applied to the snapshot instead.
+        mtv_type src2(db);
+        mtv_type snap2 = src2.snapshot();
+        f(snap2);
+        assert(snap2 == expected);
+        assert(src2 == db);
+    }
+
+    // Copy and move of a container with shared blocks.
+    {
+        mtv_type snap = db.snapshot();
+        mtv_type copied(snap);
+        mtv_type moved(std::move(snap));
+        moved.set(0, 0.5);
+        assert(db.get<double>(0) == 9.9);
+        assert(copied == db);
+        mtv_type assigned;
+        assigned = db.snapshot();
+        assigned.set(9, true);
+        assert(db.get<bool>(9) == false);
+    }
+
+    // Snapshots taken from multiple threads at once.
+    {
+        const mtv_type& cdb = db;
+        std::vector<mtv_type> snaps(4);
+        std::vector<std::thread> threads;
+        for (mtv_type& snap : snaps)
+            threads.emplace_back([&cdb, &snap]() { snap = cdb.snapshot(); });
+
+        for (std::thread& t : threads)
+            t.join();
+
+        for (mtv_type& snap : snaps)
+        {
+            assert(snap == db);
+            snap.set(0, 0.5);
+        }
+
+        assert(db.get<double>(0) == 9.9);
+    }
+}
+
+
+template<typename _T>
+void check_set_sorted(const mtv_type& db, const vector<pair<size_t, _T>>& vals)
+{
+    // Setting the values in one batch must yield the same result as
+    // setting them one at a time.
+    mtv_type expected(db);
+    mtv_type::iterator pos_hint = expected.begin();
+    for (const pair<size_t, _T>& v : vals)
+        pos_hint = expected.set(pos_hint, v.first, v.second);
+
+    mtv_type db2(db);
+    mtv_type::iterator it = db2.set_sorted(vals.begin(), vals.end());
+    assert(db2 == expected);
+    assert(db2.block_size() == expected.block_size());
+
+    if (vals.empty())
+    {
+        assert(it == db2.end());
+        return;
+    }
+
+    size_t last_pos = vals.back().first;
+    assert(it->position <= last_pos && last_pos < it->position + it->size);
 }
 
+void mtv_test_set_sorted()
+{
+    stack_printer __stack_printer__("::mtv_test_set_sorted");
+
+    // Build a container with a mix of empty and non-empty blocks.
+    mtv_type db(20);
+    for (size_t i = 2; i < 6; ++i)
+        db.set(i, 1.1);
+    for (size_t i = 6; i < 9; ++i)
+        db.set(i, string("foo"));
+    db.set(9, true);
+    for (size_t i = 12; i < 18; ++i)
+        db.set(i, static_cast<int>(i));
+    assert(db.block_size() == 7);
+
+    check_set_sorted(db, vector<pair<size_t, double>>());
+    check_set_sorted(db, vector<pair<size_t, double>>{{0, 2.0}});
+    check_set_sorted(db, vector<pair<size_t, double>>{{19, 2.0}});
+    check_set_sorted(db, vector<pair<size_t, double>>{{3, 2.0}, {4, 2.1}});
+    check_set_sorted(db, vector<pair<size_t, double>>{{1, 2.0}, {6, 2.1}});
+    check_set_sorted(db, vector<pair<size_t, double>>{{1, 2.0}, {7, 2.1}, {8, 2.2}, {9, 2.3}, {10, 2.4}});
+    check_set_sorted(db, vector<pair<size_t, double>>{{0, 2.0}, {1, 2.1}, {18, 2.2}, {19, 2.3}});
+    check_set_sorted(db, vector<pair<size_t, double>>{{11, 2.0}, {13, 2.1}, {15, 2.2}, {17, 2.3}});
+    check_set_sorted(db, vector<pair<size_t, string>>{{5, "A"}, {9, "B"}});
+    check_set_sorted(db, vector<pair<size_t, string>>{{2, "A"}, {3, "B"}, {4, "C"}, {5, "D"}});
+    check_set_sorted(db, vector<pair<size_t, int>>{{11, 1}, {18, 2}});
+    check_set_sorted(db, vector<pair<size_t, int>>{{0, 1}, {5, 2}, {10, 3}, {15, 4}, {19, 5}});
+
+    {
+        // Every single position.
+        vector<pair<size_t, bool>> vals;
+        for (size_t i = 0; i < db.size(); ++i)
+            vals.emplace_back(i, i % 3 == 0);
+        check_set_sorted(db, vals);
+    }
+
+    {
+        // Every other position, which alternates the value types.
+        vector<pair<size_t, double>> vals;
+        for (size_t i = 0; i < db.size(); i += 2)
+            vals.emplace_back(i, 3.0);
+        check_set_sorted(db, vals);
+    }
+
+    // Invalid ranges of values leave the container untouched.
+    mtv_type db2(db);
+    vector<pair<size_t, double>> vals = {{5, 1.0}, {20, 2.0}};
+    try
+    {
+        db2.set_sorted(vals.begin(), vals.end());
+        assert(!"exception was expected");
+    }
+    catch (const std::out_of_range&) {}
+    assert(db2 == db);
+
+    vals = {{5, 1.0}, {3, 2.0}};
+    try
+    {
+        db2.set_sorted(vals.begin(), vals.end());
+        assert(!"exception was expected");
+    }
+    catch (const std::invalid_argument&) {}
+    assert(db2 == db);
+
+    vals = {{5, 1.0}, {5, 2.0}};
+    try
+    {
+        db2.set_sorted(vals.begin(), vals.end());
+        assert(!"exception was expected");
+    }
+    catch (const std::invalid_argument&) {}
+    assert(db2 == db);
+
+    {
+        // A snapshot must not see the new values.
+        mtv_type snap = db2.snapshot();
+        vals = {{0, 1.0}, {7, 2.0}, {13, 3.0}};
+        db2.set_sorted(vals.begin(), vals.end());
+        assert(snap == db);
+        assert(db2.get<double>(7) == 2.0);
+        assert(db2.get<double>(13) == 3.0);
+    }
+}
+
+
+/**
+ * Store the type and value of each element in a form that doesn't depend
+ * on how the elements are split into blocks.
+ */
+vector<pair<mtv::element_t, double>> flatten_values(const mtv_type& db)
+{
+    vector<pair<mtv::element_t, double>> ret;
+    for (size_t i = 0; i < db.size(); ++i)
+    {
+        mtv::element_t type = db.get_type(i);
+        double val = 0.0;
+        switch (type)
+        {
+            case mtv::element_type_numeric:
+                val = db.get<double>(i);
+                break;
+            case mtv::element_type_int:
+                val = db.get<int>(i);
+                break;
+            case mtv::element_type_string:
+                val = db.get<string>(i).size();
+                break;
+            default:
+                ;
+        }
+        ret.emplace_back(type, val);
+    }
+    return ret;
+}
+
+void mtv_test_edit_session()
+{
+    stack_printer __stack_printer__("::mtv_test_edit_session");
+
+    {
+        // Adjacent blocks of the same type stay separate until the session
+        // ends.
+        mtv_type db(6, 1.1);
+        db.set(2, string("foo"));
+        db.set(4, string("bar"));
+        assert(db.block_size() == 5);
+
+        mtv_type::edit_session session(db);
+        db.set(2, 2.2);
+        db.set(4, 3.3);
+        assert(db.block_size() == 5);
+        assert(db.get<double>(2) == 2.2);
+        assert(db.get<double>(4) == 3.3);
+
+        // A copy, a copy assignment and a snapshot taken during the
+        // session are not part of it, and get their blocks merged.
+        mtv_type reference(6, 1.1);
+        reference.set(2, 2.2);
+        reference.set(4, 3.3);
+
+        mtv_type copied(db);
+        mtv_type assigned;
+        assigned = db;
+        mtv_type snap = db.snapshot();
+        for (mtv_type* p : { &copied, &assigned, &snap })
+        {
+            assert(p->block_size() == 1);
+            assert(*p == reference);
+            p->set(3, 4.4);
+            assert(p->block_size() == 1);
+            assert(p->get<double>(3) == 4.4);
+        }
+
+        assert(db.block_size() == 5);
+        assert(db.get<double>(3) == 1.1);
+
+        session.commit();
+        assert(db.block_size() == 1);
+        assert(db == reference);
+        assert(db.get<double>(0) == 1.1);
+        assert(db.get<double>(2) == 2.2);
+        assert(db.get<double>(4) == 3.3);
+        assert(db.get<double>(5) == 1.1);
+
+        session.commit(); // no-op
+        assert(db.block_size() == 1);
+    }
+
+    {
+        // Nested sessions.  The blocks get merged when the outermost
+        // session ends, which the destructor does.
+        mtv_type db(4);
+        {
+            mtv_type::edit_session outer(db);
+            {
+                mtv_type::edit_session inner(db);
+                db.set(0, 1.0);
+                db.set(1, string("foo"));
+                db.set(1, 2.0);
+            }
+            assert(db.block_size() == 3);
+        }
+        assert(db.block_size() == 2);
+        assert(db.get<double>(1) == 2.0);
+        assert(db.is_empty(2));
+    }
+
+    // Apply the same series of edits to two containers, one of which is
+    // edited in a session.  Their values must match after every edit, and
+    // their blocks must match once the session ends.  Each container also
+    // transfers and swaps values with a container of its own, which is not
+    // in a session.
+    mtv_type db1(50), db2(50);
+    mtv_type other1(60, 1.0), other2(60, 1.0);
+    mtv_type snap = db2.snapshot();
+    {
+        mtv_type::edit_session session(db2);
+        unsigned int seed = 1;
+        auto next_rand = [&seed](size_t n) -> size_t
+        {
+            seed = seed * 1103515245 + 12345;
+            return (seed / 65536) % n;
+        };
+
+        for (size_t i = 0; i < 2000; ++i)
+        {
+            size_t n = db1.size();
+            size_t pos = next_rand(n);
+            size_t len = std::min<size_t>(next_rand(5) + 1, n - pos);
+            vector<double> nums(len, static_cast<double>(i));
+            vector<string> strs(len, "foo");
+
+            for (mtv_type* db : { &db1, &db2 })
+            {
+                mtv_type* other = db == &db1 ? &other1 : &other2;
+                switch (i % 13)
+                {
+                    case 0:
+                        db->set(pos, static_cast<double>(i));
+                        break;
+                    case 1:
+                        db->set(pos, string("bar"));
+                        break;
+                    case 2:
+                        db->set(pos, static_cast<int>(i));
+                        break;
+                    case 3:
+                        db->set_empty(pos, pos+len-1);
+                        break;
+                    case 4:
+                        db->set(pos, nums.begin(), nums.end());
+                        break;
+                    case 5:
+                        db->set(pos, strs.begin(), strs.end());
+                        break;
+                    case 6:
+                        db->insert(pos, nums.begin(), nums.end());
+                        break;
+                    case 7:
+                        db->insert_empty(pos, len);
+                        break;
+                    case 8:
+                        if (n > 40)
+                            db->erase(pos, pos+len-1);
+                        break;
+                    case 9:
+                        db->push_back(static_cast<double>(i));
+                        break;
+                    case 10:
+                        if (n > 60)
+                            db->resize(n - len);
+                        break;
+                    case 11:
+                        db->transfer(pos, pos+len-1, *other, i % 50);
+                        break;
+                    case 12:
+                        db->swap(pos, pos+len-1, *other, i % 50);
+                        break;
+                }
+            }
+
+            assert(flatten_values(db1) == flatten_values(db2));
+            assert(other1 == other2);
+        }
+
+        assert(db2.block_size() >= db1.block_size());
+    }
+
+    assert(db1 == db2);
+    assert(db1.block_size() == db2.block_size());
+    assert(snap.size() == 50);
+    assert(snap.is_empty(0) && snap.block_size() == 1);
+}
+
+
+void mtv_test_aggregate()
+{
+    stack_printer __stack_printer__("::mtv_test_aggregate");
+
+    mtv_type db(20);
+    mtv::numeric_aggregate res = mtv::aggregate(db);
+    assert(res.count == 0);
+    assert(res.sum == 0.0);
+    assert(res.mean() == 0.0);
+
+    for (size_t i = 2; i < 11; ++i)
+        db.set(i, static_cast<double>(i));
+    db.set(11, string("foo"));
+    db.set(12, true);
+    db.set(13, static_cast<int>(-4));
+    db.set(14, static_cast<int>(20));
+    db.set(15, static_cast<unsigned long>(7));
+    db.set(16, static_cast<short>(1));
+
+    res = mtv::aggregate(db);
+    assert(res.count == 13);
+    assert(res.sum == 54.0 - 4.0 + 20.0 + 7.0 + 1.0);
+    assert(res.min == -4.0);
+    assert(res.max == 20.0);
+    assert(res.mean() == res.sum / 13);
+
+    // Partial blocks at both ends of the range.
+    res = mtv::aggregate(db, 4, 13);
+    assert(res.count == 8);
+    assert(res.sum == 49.0 - 4.0);
+    assert(res.min == -4.0);
+    assert(res.max == 10.0);
+
+    // Within a single block.
+    res = mtv::aggregate(db, 3, 8);
+    assert(res.count == 6);
+    assert(res.sum == 33.0);
+    assert(res.min == 3.0);
+    assert(res.max == 8.0);
+
+    // Only non-numeric elements.
+    res = mtv::aggregate(db, 11, 12);
+    assert(res.count == 0);
+    assert(res.min == 0.0 && res.max == 0.0);
+
+    res = mtv::aggregate(db, 0, 0);
+    assert(res.count == 0);
+
+    try
+    {
+        mtv::aggregate(db, 5, 20);
+        assert(!"exception was expected");
+    }
+    catch (const std::out_of_range&) {}
+
+    try
+    {
+        mtv::aggregate(db, 5, 4);
+        assert(!"exception was expected");
+    }
+    catch (const std::out_of_range&) {}
+
+    // A block long enough to go through all the lanes, with the smallest
+    // and largest values in different lanes.
+    vector<double> vals;
+    for (size_t i = 0; i < 103; ++i)
+        vals.push_back(static_cast<double>(i % 7));
+    vals[41] = -100.0;
+    vals[98] = 100.0;
+    mtv_type db2(vals.size(), vals.begin(), vals.end());
+    db2.push_back(string("foo"));
+    res = mtv::aggregate(db2);
+    assert(res.count == 103);
+    double sum = 0.0;
+    for (double v : vals)
+        sum += v;
+    assert(res.sum == sum);
+    assert(res.min == -100.0);
+    assert(res.max == 100.0);
+}
+
+void mtv_test_parallel_for_each_block()
+{
+    stack_printer __stack_printer__("::mtv_test_parallel_for_each_block");
+
+    mtv_type db(100);
+    for (size_t i = 10; i < 60; ++i)
+        db.set(i, static_cast<double>(i));
+    db.set(60, string("foo"));
+    db.set(61, string("bar"));
+    for (size_t i = 70; i < 95; ++i)
+        db.set(i, static_cast<int>(i));
+
+    std::mutex mtx;
+    vector<mtv::block_span> spans;
+    auto collect = [&](const mtv::block_span& span)
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        spans.push_back(span);
+    };
+
+    auto by_position = [](const mtv::block_span& left, const mtv::block_span& right)
+    {
+        return left.position < right.position;
+    };
+
+    // Make sure that the runs cover the whole container without overlaps,
+    // and that each run refers to the right elements.
+    auto check_spans = [&](size_t chunk_size)
+    {
+        std::sort(spans.begin(), spans.end(), by_position);
+        size_t pos = 0;
+        for (const mtv::block_span& span : spans)
+        {
+            assert(span.position == pos);
+            assert(span.size > 0);
+            assert(span.type == db.get_type(pos));
+            mtv_type::const_position_type blk_pos = db.position(pos);
+            assert(span.data == blk_pos.first->data);
+            assert(span.offset == blk_pos.second);
+
+            if (span.data)
+                assert(span.size <= chunk_size);
+
+            switch (span.type)
+            {
+                case mtv::element_type_numeric:
+                {
+                    const double* p = &mtv::numeric_element_block::at(*span.data, span.offset);
+                    for (size_t i = 0; i < span.size; ++i)
+                        assert(p[i] == db.get<double>(pos+i));
+                    break;
+                }
+                case mtv::element_type_int:
+                {
+                    const int* p = &mtv::int_element_block::at(*span.data, span.offset);
+                    for (size_t i = 0; i < span.size; ++i)
+                        assert(p[i] == db.get<int>(pos+i));
+                    break;
+                }
+                default:
+                    ;
+            }
+
+            pos += span.size;
+        }
+
+        assert(pos == db.size());
+        spans.clear();
+    };
+
+    mtv::parallel_for_each_block(db, collect, 4, 7);
+    check_spans(7);
+
+    // Blocks that are exactly as large as the chunk size.
+    mtv::parallel_for_each_block(db, collect, 3, 25);
+    check_spans(25);
+
+    // Single thread.
+    mtv::parallel_for_each_block(db, collect, 1, 16);
+    check_spans(16);
+
+    // Default thread count and chunk size.
+    mtv::parallel_for_each_block(db, collect);
+    check_spans(db.size());
+
+    // More threads than there are runs.
+    mtv::parallel_for_each_block(db, collect, 32, 1000);
+    assert(spans.size() == db.block_size());
+    check_spans(1000);
+
+    // Empty container.
+    mtv_type db_empty;
+    mtv::parallel_for_each_block(db_empty, collect, 4, 0);
+    assert(spans.empty());
+
+    // Sum the numeric elements concurrently.
+    std::atomic<long> total(0);
+    mtv::parallel_for_each_block(db,
+        [&total](const mtv::block_span& span)
+        {
+            if (span.type != mtv::element_type_int)
+                return;
+
+            const int* p = &mtv::int_element_block::at(*span.data, span.offset);
+            total += std::accumulate(p, p+span.size, 0L);
+        },
+        4, 3);
+    assert(total == (70+94)*25/2);
+
+    // An exception thrown from the function object gets propagated to the
+    // calling thread.
+    try
+    {
+        mtv::parallel_for_each_block(db,
+            [](const mtv::block_span& span)
+            {
+                if (span.type == mtv::element_type_string)
+                    throw std::runtime_error("string block");
+            },
+            4, 2);
+        assert(!"exception was expected");
+    }
+    catch (const std::runtime_error& e)
+    {
+        assert(string(e.what()) == "string block");
+    }
+}
+
+void mtv_test_constant_block()
+{
+    stack_printer __stack_printer__("::mtv_test_constant_block");
+
+    // A block filled with a single value stores the value only once.
+    size_t n = 1000000;
+    mtv_type db(n, 0.5);
+    assert(db.block_size() == 1);
+    mtv_type::const_iterator it = db.begin();
+    assert(mtv::numeric_element_block::is_constant(*it->data));
+    assert(mtv::numeric_element_block::capacity(*it->data) < n);
+    assert(db.get<double>(0) == 0.5);
+    assert(db.get<double>(n-1) == 0.5);
+
+    // Reading an element via a const block does not expand it.
+    const mtv::base_element_block& blk = *it->data;
+    assert(mtv::numeric_element_block::at(blk, 123) == 0.5);
+    assert(mtv::numeric_element_block::is_constant(blk));
+
+    mtv::numeric_aggregate res = mtv::aggregate(db);
+    assert(res.count == n);
+    assert(res.sum == 0.5 * n);
+    assert(res.min == 0.5 && res.max == 0.5);
+    assert(mtv::numeric_element_block::is_constant(*db.begin()->data));
+
+    // Splitting the block keeps both parts constant.
+    db.set(500000, string("split"));
+    assert(db.block_size() == 3);
+    it = db.begin();
+    assert(it->size == 500000);
+    assert(mtv::numeric_element_block::is_constant(*it->data));
+    ++it;
+    ++it;
+    assert(it->size == n - 500001);
+    assert(mtv::numeric_element_block::is_constant(*it->data));
+
+    db.set_empty(10, 19);
+    assert(db.block_size() == 5);
+    it = db.begin();
+    assert(it->size == 10);
+    assert(mtv::numeric_element_block::is_constant(*it->data));
+    ++it;
+    assert(it->type == mtv::element_type_empty);
+    ++it;
+    assert(it->size == 500000 - 20);
+    assert(mtv::numeric_element_block::is_constant(*it->data));
+    assert(db.get<double>(20) == 0.5);
+
+    // Appending the same value extends the run.
+    db.push_back(0.5);
+    assert(db.size() == n+1);
+    mtv_type::const_reverse_iterator rit = db.rbegin();
+    assert(rit->size == n - 500000);
+    assert(mtv::numeric_element_block::is_constant(*rit->data));
+
+    // Changing the value of an element expands the block.
+    db.set(1, 1.5);
+    it = db.begin();
+    assert(!mtv::numeric_element_block::is_constant(*it->data));
+    assert(db.get<double>(0) == 0.5);
+    assert(db.get<double>(1) == 1.5);
+    assert(db.get<double>(9) == 0.5);
+
+    // So does accessing the elements via iterators.
+    const mtv_type& cdb = db;
+    rit = cdb.rbegin();
+    mtv::numeric_element_block::const_iterator it_elem = mtv::numeric_element_block::begin(*rit->data);
+    mtv::numeric_element_block::const_iterator it_elem_end = mtv::numeric_element_block::end(*rit->data);
+    assert(!mtv::numeric_element_block::is_constant(*rit->data));
+    assert(size_t(std::distance(it_elem, it_elem_end)) == rit->size);
+    assert(std::count(it_elem, it_elem_end, 0.5) == std::ptrdiff_t(rit->size));
+
+    // A constant block compares equal to an expanded block with the same
+    // values.
+    vector<double> vals(10, 2.0);
+    mtv_type db1(10, 2.0), db2(10, vals.begin(), vals.end());
+    assert(mtv::numeric_element_block::is_constant(*db1.begin()->data));
+    assert(!mtv::numeric_element_block::is_constant(*db2.begin()->data));
+    assert(db1 == db2);
+    db2.set(9, 3.0);
+    assert(db1 != db2);
+
+    // A snapshot shares the constant block, and stays intact when the
+    // original gets modified.
+    mtv_type db3(100, string("foo"));
+    mtv_type snap = db3.snapshot();
+    db3.set(50, string("bar"));
+    assert(mtv::string_element_block::is_constant(*snap.begin()->data));
+    assert(snap.get<string>(50) == "foo");
+    assert(db3.get<string>(50) == "bar");
+    assert(db3.get<string>(51) == "foo");
+
+    // Boolean blocks too.
+    mtv_type db4(100, true);
+    assert(mtv::boolean_element_block::is_constant(*db4.begin()->data));
+    assert(db4.get<bool>(99));
+    db4.set(99, false);
+    assert(!mtv::boolean_element_block::is_constant(*db4.begin()->data));
+    assert(db4.get<bool>(98));
+    assert(!db4.get<bool>(99));
+
+    // Multiple threads reading the same constant block expand it only once.
+    mtv_type db5(10000, 3.0);
+    std::atomic<size_t> count(0);
+    mtv::parallel_for_each_block(db5,
+        [&count](const mtv::block_span& span)
+        {
+            mtv::numeric_element_block::const_iterator it = mtv::numeric_element_block::begin(*span.data);
+            it += span.offset;
+            count += std::count(it, it + span.size, 3.0);
+        },
+        4, 100);
+    assert(count == db5.size());
+    assert(!mtv::numeric_element_block::is_constant(*db5.begin()->data));
+}
+
+void mtv_test_fragmented_row_insert_erase()
+{
+    stack_printer __stack_printer__("::mtv_test_fragmented_row_insert_erase");
+
+    // Alternate between numeric and string values so that each row is a
+    // block of its own.
+    size_t n = 2000;
+    mtv_type db(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        if (i % 2)
+            db.set(i, double(i));
+        else
+            db.set(i, std::to_string(i));
+    }
+    assert(db.block_size() == n);
+
+    // Insert and erase rows around one position, then at positions far
+    // apart in both directions, and check the block positions after each
+    // edit.
+    size_t positions[] = { 1000, 1001, 999, 1003, 10, 1990, 0, 1500, 3, 1997 };
+    for (size_t pos : positions)
+    {
+        db.insert_empty(pos, 2);
+        assert(db.size() == n + 2);
+        assert(db.is_empty(pos) && db.is_empty(pos+1));
+        assert(db.check_block_integrity());
+
+        double v = 0.5;
+        db.insert(pos, &v, &v+1);
+        assert(db.get<double>(pos) == 0.5);
+        assert(db.check_block_integrity());
+
+        db.erase(pos, pos+2);
+        assert(db.size() == n);
+        assert(db.check_block_integrity());
+    }
+
+    assert(db.block_size() == n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        mtv_type::const_position_type pos = db.position(i);
+        assert(mtv_type::logical_position(pos) == i);
+        if (i % 2)
+            assert(db.get<double>(i) == double(i));
+        else
+            assert(db.get<string>(i) == std::to_string(i));
+    }
+
+    // Copies and snapshots taken with a pending position shift report the
+    // same positions.
+    db.insert_empty(5, 3);
+    mtv_type copied(db), snapped = db.snapshot();
+    db.erase(5, 7);
+    assert(copied.size() == n + 3 && snapped.size() == n + 3);
+    assert(copied == snapped);
+    assert(copied.get<double>(n+2) == double(n-1));
+    assert(snapped.get<string>(n+1) == std::to_string(n-2));
+    copied.erase(5, 7);
+    assert(copied == db);
+
+    // Iterating over the blocks yields the same positions.
+    size_t expected = 0;
+    for (const auto& blk : db)
+    {
+        assert(blk.position == expected);
+        expected += blk.size;
+    }
+    assert(expected == n);
+}
+
+void mtv_test_element_span()
+{
+    stack_printer __stack_printer__("::mtv_test_element_span");
+
+    static_assert(mtv::numeric_element_block::contiguous, "numeric blocks should be contiguous.");
+    static_assert(mtv::string_element_block::contiguous, "string blocks should be contiguous.");
+#ifndef MDDS_MULTI_TYPE_VECTOR_USE_DEQUE
+    static_assert(!mtv::boolean_element_block::contiguous, "boolean blocks should not be contiguous.");
+#endif
+
+    mtv_type db(20);
+    for (size_t i = 0; i < 10; ++i)
+        db.set(i, double(i));
+    db.set(10, string("foo"));
+    db.set(11, string("bar"));
+
+    // Span of a whole block via the iterator.
+    mtv_type::const_iterator it = db.begin();
+    mtv::element_span<const double> span = it->get_span<mtv::numeric_element_block>();
+    assert(span.size() == 10);
+    assert(span.data() == &*mtv::numeric_element_block::begin(*it->data));
+    for (size_t i = 0; i < span.size(); ++i)
+        assert(span[i] == double(i));
+
+    assert(std::accumulate(span.begin(), span.end(), 0.0) == 45.0);
+    mtv::element_span<const double> sub = span.subspan(2, 3);
+    assert(sub.size() == 3 && sub[0] == 2.0 && sub[2] == 4.0);
+
+    ++it;
+    mtv::element_span<const string> sspan = it->get_span<mtv::string_element_block>();
+    assert(sspan.size() == 2 && sspan[0] == "foo" && sspan[1] == "bar");
+
+    // Requesting the wrong block type, or an empty block, throws.
+    try
+    {
+        it->get_span<mtv::numeric_element_block>();
+        assert(!"exception should have been thrown");
+    }
+    catch (const mtv::element_block_error&)
+    {
+        // expected.
+    }
+
+    ++it;
+    try
+    {
+        it->get_span<mtv::numeric_element_block>();
+        assert(!"exception should have been thrown");
+    }
+    catch (const mtv::element_block_error&)
+    {
+        // expected.
+    }
+
+    // Span of a sub-range via the container, clipped to the end of the
+    // block that contains the start position.
+    span = db.get_span<mtv::numeric_element_block>(3, 5);
+    assert(span.size() == 3 && span[0] == 3.0 && span[2] == 5.0);
+    span = db.get_span<mtv::numeric_element_block>(7, 19);
+    assert(span.size() == 3 && span[0] == 7.0 && span[2] == 9.0);
+    sspan = db.get_span<mtv::string_element_block>(11, 11);
+    assert(sspan.size() == 1 && sspan[0] == "bar");
+
+    // A constant run gets expanded on access.
+    mtv_type db2(1000, 2.5);
+    span = db2.get_span<mtv::numeric_element_block>(10, 999);
+    assert(span.size() == 990);
+    assert(std::all_of(span.begin(), span.end(), [](double v) { return v == 2.5; }));
+    assert(!mtv::numeric_element_block::is_constant(*db2.begin()->data));
+
+    // Walk a range spanning multiple blocks.
+    db2.set(500, string("gap"));
+    double total = 0.0;
+    for (size_t pos = 0; pos < db2.size(); )
+    {
+        if (db2.get_type(pos) != mtv::element_type_numeric)
+        {
+            ++pos;
+            continue;
+        }
+
+        span = db2.get_span<mtv::numeric_element_block>(pos, db2.size()-1);
+        total = std::accumulate(span.begin(), span.end(), total);
+        pos += span.size();
+    }
+    assert(total == 2.5 * 999);
+
+    try
+    {
+        db.get_span<mtv::numeric_element_block>(5, 20);
+        assert(!"exception should have been thrown");
+    }
+    catch (const std::out_of_range&)
+    {
+        // expected.
+    }
+
+    try
+    {
+        db.get_span<mtv::numeric_element_block>(5, 4);
+        assert(!"exception should have been thrown");
+    }
+    catch (const std::out_of_range&)
+    {
+        // expected.
+    }
+}
+
+void mtv_test_block_cache()
+{
+    stack_printer __stack_printer__("::mtv_test_block_cache");
+
+    mtv_type db(100);
+    assert(!db.block_cache_enabled());
+    db.enable_block_cache();
+    assert(db.block_cache_enabled());
+
+    for (size_t i = 0; i < 100; ++i)
+    {
+        if (i % 3 == 1)
+            db.set(i, double(i));
+        else if (i % 3 == 2)
+            db.set(i, string("A"));
+    }
+
+    auto check = [](const mtv_type& col, size_t i)
+    {
+        switch (i % 3)
+        {
+            case 0:
+                assert(col.is_empty(i));
+                break;
+            case 1:
+                assert(col.get_type(i) == mtv::element_type_numeric);
+                assert(col.get<double>(i) == double(i));
+                break;
+            case 2:
+                assert(col.get<string>(i) == "A");
+                break;
+        }
+    };
+
+    // Forward, backward, and strided access.
+    for (size_t i = 0; i < db.size(); ++i)
+        check(db, i);
+    for (size_t i = db.size(); i > 0; --i)
+        check(db, i-1);
+    for (size_t i = 0, pos = 0; i < db.size(); ++i, pos = (pos + 37) % db.size())
+        check(db, pos);
+
+    // The cached block remains usable, or gets discarded, as the blocks
+    // get modified.
+    db.get<double>(97);
+    db.resize(50);
+    check(db, 49);
+    db.insert_empty(10, 3);
+    assert(db.is_empty(10) && db.is_empty(12));
+    assert(db.get<double>(16) == 13.0);
+    db.erase(10, 12);
+    for (size_t i = 0; i < db.size(); ++i)
+        check(db, i);
+
+    mtv_type db2(db);
+    assert(db2.block_cache_enabled());
+    db2.get<double>(49);
+    db2.clear();
+    db2.push_back(1.5);
+    assert(db2.get<double>(0) == 1.5);
+
+    db.enable_block_cache(false);
+    assert(!db.block_cache_enabled());
+    for (size_t i = 0; i < db.size(); ++i)
+        check(db, i);
+}
+
+/**
+ * Check that both the stream and the view reject malformed serialized
+ * content with general_error, rather than any other exception.
+ */
+void check_serialized_rejected(const std::string& bytes)
+{
+    // A failed load leaves the existing content of the container intact,
+    // even if some of the blocks have been loaded before the failure.
+    mtv_type db(2, string("keep"));
+    db.push_back(true);
+    const mtv_type expected(db);
+
+    std::istringstream is(bytes);
+    try
+    {
+        mtv::deserialize(db, is);
+        assert(!"exception should have been thrown");
+    }
+    catch (const general_error&)
+    {
+        // expected.
+    }
+    assert(db == expected);
+
+    vector<uint64_t> buf((bytes.size() + 7) / 8);
+    std::memcpy(buf.data(), bytes.data(), bytes.size());
+    try
+    {
+        mtv::serialized_view view(buf.data(), bytes.size());
+        mtv::deserialize(db, view);
+        assert(!"exception should have been thrown");
+    }
+    catch (const general_error&)
+    {
+        // expected.
+    }
+    assert(db == expected);
+}
+
+void mtv_test_serialize()
+{
+    stack_printer __stack_printer__("::mtv_test_serialize");
+
+    // One block of each standard type, with empty blocks in between, and
+    // a constant run.
+    mtv_type db(3);
+    db.push_back(1.5);
+    db.push_back(2.5);
+    db.push_back(string("foo"));
+    db.push_back(string(""));
+    db.push_back(string("a\0b", 3));
+    db.push_back(static_cast<short>(-3));
+    db.push_back(static_cast<unsigned short>(4));
+    db.push_back(static_cast<int>(-5));
+    db.push_back(static_cast<unsigned int>(6));
+    db.push_back(static_cast<long>(-7));
+    db.push_back(static_cast<unsigned long>(8));
+    db.push_back(true);
+    db.push_back(false);
+    db.push_back('c');
+    db.push_back(static_cast<unsigned char>(200));
+    db.resize(db.size()+2);
+    {
+        mtv_type db_run(1000, 0.25);
+        db.insert_empty(db.size()-1, db_run.size());
+        db_run.transfer(0, db_run.size()-1, db, db.size()-1001);
+    }
+    assert(db.block_size() == 15);
+    assert(mtv::numeric_element_block::is_constant(*db.position(db.size()-2).first->data));
+
+    std::ostringstream os;
+    mtv::serialize(db, os);
+    std::string bytes = os.str();
+    assert(bytes.size() % 8 == 0);
+
+    // Load from a stream.
+    mtv_type loaded(5, string("to be replaced"));
+    std::istringstream is(bytes);
+    mtv::deserialize(loaded, is);
+    assert(loaded == db);
+    assert(check_block_lookup(loaded));
+
+    // Load from memory.  Copy the bytes to 8-byte aligned storage first,
+    // as a memory-mapped file would be.
+    vector<uint64_t> buf(bytes.size() / 8);
+    std::memcpy(buf.data(), bytes.data(), bytes.size());
+    mtv::serialized_view view(buf.data(), bytes.size());
+    assert(view.size() == db.size());
+    assert(view.block_size() == db.block_size());
+
+    mtv_type loaded2;
+    mtv::deserialize(loaded2, view);
+    assert(loaded2 == db);
+
+    // Access the raw values without loading them.
+    const mtv::serialized_view::block& blk = view.get_block(1);
+    assert(blk.type == mtv::element_type_numeric);
+    assert(blk.position == 3);
+    mtv::element_span<const double> span = view.get_span<mtv::numeric_element_block>(1);
+    assert(span.size() == 2 && span[0] == 1.5 && span[1] == 2.5);
+    assert(reinterpret_cast<const char*>(span.data()) > reinterpret_cast<const char*>(buf.data()));
+    assert(reinterpret_cast<const char*>(span.data()) < reinterpret_cast<const char*>(buf.data()) + bytes.size());
+
+    mtv::element_span<const long> lspan = view.get_span<mtv::long_element_block>(7);
+    assert(lspan.size() == 1 && lspan[0] == -7);
+
+    span = view.get_span<mtv::numeric_element_block>(view.block_size()-2);
+    assert(span.size() == 1000 && span[999] == 0.25);
+
+    try
+    {
+        view.get_span<mtv::int_element_block>(1);
+        assert(!"exception should have been thrown");
+    }
+    catch (const mtv::element_block_error&)
+    {
+        // expected.
+    }
+
+    // An empty container.
+    mtv_type empty_db;
+    os.str(std::string());
+    mtv::serialize(empty_db, os);
+    is.clear();
+    is.str(os.str());
+    mtv::deserialize(loaded, is);
+    assert(loaded.empty());
+
+    // A constant run of booleans.
+    mtv_type bool_db(10, true);
+    os.str(std::string());
+    mtv::serialize(bool_db, os);
+    is.clear();
+    is.str(os.str());
+    mtv::deserialize(loaded, is);
+    assert(loaded == bool_db);
+
+    // Malformed data gets rejected.
+    std::string bad = bytes;
+    bad[0] = 'X';
+    is.clear();
+    is.str(bad);
+    try
+    {
+        mtv::deserialize(loaded, is);
+        assert(!"exception should have been thrown");
+    }
+    catch (const general_error&)
+    {
+        // expected.
+    }
+
+    try
+    {
+        mtv::serialized_view truncated(buf.data(), bytes.size() - 16);
+        assert(!"exception should have been thrown");
+    }
+    catch (const general_error&)
+    {
+        // expected.
+    }
+
+    is.clear();
+    is.str(bytes.substr(0, bytes.size() - 16));
+    try
+    {
+        mtv::deserialize(loaded, is);
+        assert(!"exception should have been thrown");
+    }
+    catch (const general_error&)
+    {
+        // expected.
+    }
+
+    // Corrupt sizes in block headers.  The layout is: header (0-31),
+    // numeric block header (32-55) and payload (56-63), string block
+    // header (64-87) and payload (88-103), empty block header (104-127).
+    mtv_type small_db;
+    small_db.push_back(1.5);
+    small_db.push_back(string("ab"));
+    small_db.push_back_empty();
+    os.str(std::string());
+    mtv::serialize(small_db, os);
+    const std::string small_bytes = os.str();
+    assert(small_bytes.size() == 128);
+
+    auto corrupt = [&small_bytes](size_t offset, uint64_t val)
+    {
+        std::string ret = small_bytes;
+        std::memcpy(&ret[offset], &val, sizeof(val));
+        return ret;
+    };
+
+    const uint64_t huge = std::numeric_limits<uint64_t>::max() / 2;
+
+    // Number of elements whose size in bytes overflows to the payload size.
+    check_serialized_rejected(corrupt(40, (uint64_t(1) << 61) + 1));
+
+    // Huge payload sizes, which must not be allocated before being read.
+    check_serialized_rejected(corrupt(40, huge / 8));
+    check_serialized_rejected(corrupt(48, huge));
+    check_serialized_rejected(corrupt(80, huge));
+    check_serialized_rejected(corrupt(80, uint64_t(1) << 40));
+
+    // String blocks with more strings than their payload can hold, and a
+    // string longer than its block.
+    check_serialized_rejected(corrupt(72, huge));
+    check_serialized_rejected(corrupt(72, 3));
+    check_serialized_rejected(corrupt(88, huge));
+
+    // More elements than the header says.
+    check_serialized_rejected(corrupt(112, huge));
+    check_serialized_rejected(corrupt(16, 2));
+
+    // Truncated at every block boundary and in the middle of each.
+    for (size_t n = 0; n < small_bytes.size(); n += 4)
+        check_serialized_rejected(small_bytes.substr(0, n));
+}
+
+}
+
+void mtv_test_fingerprint()
+{
+    stack_printer __stack_printer__("::mtv_test_fingerprint");
+
+    mtv_type db1(2), db2(2);
+    assert(db1.fingerprint() == db2.fingerprint());
+
+    // Element blocks that store the same values hash the same regardless
+    // of whether they store them as a constant run.
+    mtv_type run(5, 1.5);
+    assert(mtv::numeric_element_block::is_constant(*run.begin()->data));
+    db1.push_back(string("foo"));
+    db2.push_back(string("foo"));
+    for (int i = 0; i < 5; ++i)
+    {
+        db1.push_back(1.5);
+        db2.push_back(1.5);
+    }
+    run.transfer(0, 4, db2, 3);
+    assert(mtv::numeric_element_block::is_constant(*db2.position(3).first->data));
+    assert(!mtv::numeric_element_block::is_constant(*db1.position(3).first->data));
+    assert(db1 == db2);
+    size_t h = db1.fingerprint();
+    assert(h == db2.fingerprint());
+    assert(mtv::element_block_func::hash_block(*db1.position(3).first->data) ==
+           mtv::element_block_func::hash_block(*db2.position(3).first->data));
+
+    // The hash of a constant run is computed without visiting each of its
+    // elements, and equals that of the same values stored individually.
+    typedef unique_ptr<mtv::base_element_block, void(*)(const mtv::base_element_block*)> block_ptr;
+    for (size_t n : { 2, 3, 7, 8, 64, 65, 1000, 4097 })
+    {
+        vector<double> nums(n, 2.5);
+        vector<string> strs(n, "foo");
+        block_ptr run1(
+            mtv::numeric_element_block::create_block_with_value(n, 2.5),
+            &mtv::numeric_element_block::delete_block);
+        block_ptr blk1(
+            mtv::numeric_element_block::create_block_with_values(nums.begin(), nums.end()),
+            &mtv::numeric_element_block::delete_block);
+        block_ptr run2(
+            mtv::string_element_block::create_block_with_value(n, string("foo")),
+            &mtv::string_element_block::delete_block);
+        block_ptr blk2(
+            mtv::string_element_block::create_block_with_values(strs.begin(), strs.end()),
+            &mtv::string_element_block::delete_block);
+        assert(mtv::numeric_element_block::is_constant(*run1));
+        assert(!mtv::numeric_element_block::is_constant(*blk1));
+        assert(mtv::numeric_element_block::hash(*run1) == mtv::numeric_element_block::hash(*blk1));
+        assert(mtv::string_element_block::is_constant(*run2));
+        assert(!mtv::string_element_block::is_constant(*blk2));
+        assert(mtv::string_element_block::hash(*run2) == mtv::string_element_block::hash(*blk2));
+    }
+
+    mtv_type huge1(1000000000, 1.5), huge2(1000000000, 1.5);
+    assert(huge1.fingerprint() == huge2.fingerprint());
+    huge2.resize(999999999);
+    assert(huge1.fingerprint() != huge2.fingerprint());
+
+    // Modifying a block drops its cached hash.
+    db2.set(5, 2.5);
+    assert(db2.fingerprint() != h);
+    assert(db1 != db2);
+    assert(db2 != db1);
+    db1.set(5, 2.5);
+    assert(db1 == db2);
+    assert(db1.fingerprint() == db2.fingerprint());
+    db2.set(5, 1.5);
+    assert(db2.fingerprint() == h);
+
+    // The sizes and types of the blocks count too.
+    mtv_type db3(db1);
+    assert(db3.fingerprint() == db1.fingerprint());
+    db3.set_empty(0, 0);
+    db3.set(0, 1.0);
+    assert(db3.fingerprint() != db1.fingerprint());
+    db3.set(0, string("foo"));
+    assert(db3.fingerprint() != db1.fingerprint());
+    db3.set_empty(0, 0);
+    assert(db3 == db1);
+    assert(db3.fingerprint() == db1.fingerprint());
+
+    mtv_type db4(8, static_cast<int>(1));
+    mtv_type db5(8, static_cast<long>(1));
+    assert(db4.fingerprint() != db5.fingerprint());
+
+    // A snapshot shares the hashes of its blocks until either side gets
+    // modified.
+    mtv_type snap = db1.snapshot();
+    assert(snap.fingerprint() == db1.fingerprint());
+    db1.set(4, 3.5);
+    assert(snap.fingerprint() != db1.fingerprint());
+    assert(snap != db1);
+    db1.set(4, 1.5);
+    assert(snap.fingerprint() == db1.fingerprint());
+    assert(snap == db1);
+
+    // Values modified via an element block iterator.
+    mtv_type::iterator it = db1.begin();
+    std::advance(it, 2);
+    assert(it->type == mtv::element_type_numeric);
+    h = db1.fingerprint();
+    *mtv::numeric_element_block::begin(*it->data) = 9.0;
+    assert(db1.fingerprint() != h);
+    assert(db1.get<double>(3) == 9.0);
+}
+
+void mtv_test_diff()
+{
+    stack_printer __stack_printer__("::mtv_test_diff");
+
+    typedef mtv::diff_range<mtv_type> range_type;
+    typedef vector<range_type> ranges_type;
+
+    mtv_type db1(20);
+    db1.set(2, 1.0);
+    db1.set(3, 2.0);
+    db1.set(4, 3.0);
+    db1.set(5, string("A"));
+    db1.set(6, string("B"));
+    db1.set(10, true);
+    db1.set(11, false);
+
+    // Identical containers.
+    mtv_type db2(db1);
+    assert(mtv::diff(db1, db2).empty());
+    assert(mtv::diff(db1, db1.snapshot()).empty());
+
+    // One changed value in the middle of a numeric block.
+    db2.set(3, 2.5);
+    ranges_type ranges = mtv::diff(db1, db2);
+    assert(ranges.size() == 1);
+    const range_type* r = &ranges[0];
+    assert(r->start == 3 && r->end == 4);
+    assert(r->old_type == mtv::element_type_numeric);
+    assert(r->new_type == mtv::element_type_numeric);
+    assert(mtv_type::logical_position(r->old_position) == 3);
+    assert(mtv_type::logical_position(r->new_position) == 3);
+    assert(mtv_type::get<mtv::numeric_element_block>(r->old_position) == 2.0);
+    assert(mtv_type::get<mtv::numeric_element_block>(r->new_position) == 2.5);
+
+    // Adjacent changes across blocks of different types get coalesced.
+    db2.set(4, string("C"));
+    db2.set(5, string("D"));
+    db2.set(7, 4.0);
+    ranges = mtv::diff(db1, db2);
+    assert(ranges.size() == 2);
+    r = &ranges[0];
+    assert(r->start == 3 && r->end == 6);
+    assert(r->old_type == mtv::element_type_mixed);
+    assert(r->new_type == mtv::element_type_mixed);
+    r = &ranges[1];
+    assert(r->start == 7 && r->end == 8);
+    assert(r->old_type == mtv::element_type_empty);
+    assert(r->new_type == mtv::element_type_numeric);
+
+    // Ranges in the other direction.
+    ranges = mtv::diff(db2, db1);
+    assert(ranges.size() == 2);
+    assert(ranges[0].start == 3 && ranges[0].end == 6);
+    assert(ranges[1].old_type == mtv::element_type_numeric);
+    assert(ranges[1].new_type == mtv::element_type_empty);
+
+    // Containers of different sizes, where the positions past the end of
+    // the shorter one count as empty.
+    mtv_type db3(db1);
+    db3.resize(25);
+    db3.set(23, 9.0);
+    ranges = mtv::diff(db1, db3);
+    assert(ranges.size() == 1);
+    r = &ranges[0];
+    assert(r->start == 23 && r->end == 24);
+    assert(r->old_type == mtv::element_type_empty);
+    assert(r->old_position.first == db1.end());
+    assert(mtv_type::logical_position(r->new_position) == 23);
+
+    db3.resize(12);
+    ranges = mtv::diff(db1, db3);
+    assert(ranges.empty());
+    db3.set(11, 5.0);
+    ranges = mtv::diff(db3, db1);
+    assert(ranges.size() == 1);
+    assert(ranges[0].start == 11 && ranges[0].end == 12);
+    assert(ranges[0].old_type == mtv::element_type_numeric);
+    assert(ranges[0].new_type == mtv::element_type_boolean);
+
+    // Constant runs get compared without being expanded.
+    mtv_type db4(1000, 1.5), db5(1000, 1.5);
+    assert(mtv::diff(db4, db5).empty());
+    assert(mtv::numeric_element_block::is_constant(*db4.begin()->data));
+    db5.set(500, 2.0);
+    ranges = mtv::diff(db4, db5);
+    assert(ranges.size() == 1);
+    assert(ranges[0].start == 500 && ranges[0].end == 501);
+    assert(mtv::numeric_element_block::is_constant(*db4.begin()->data));
+
+    // A snapshot shares its blocks with the original, which may have been
+    // shifted by rows inserted before them.
+    mtv_type snap = db1.snapshot();
+    db1.insert_empty(0, 2);
+    ranges = mtv::diff(snap, db1);
+    assert(!ranges.empty());
+    assert(ranges[0].start == 2);
+    assert(ranges.back().end == 14);
+
+    // Replicate the changes to a copy of the old container.
+    mtv_type follower(snap);
+    follower.resize(db1.size());
+    for (const range_type& rng : ranges)
+    {
+        for (size_t i = rng.start; i < rng.end && i < db1.size(); ++i)
+        {
+            switch (db1.get_type(i))
+            {
+                case mtv::element_type_empty:
+                    follower.set_empty(i, i);
+                    break;
+                case mtv::element_type_numeric:
+                    follower.set(i, db1.get<double>(i));
+                    break;
+                case mtv::element_type_string:
+                    follower.set(i, db1.get<string>(i));
+                    break;
+                case mtv::element_type_boolean:
+                    follower.set(i, db1.get<bool>(i));
+                    break;
+                default:
+                    assert(!"unexpected element type");
+            }
+        }
+    }
+    assert(follower == db1);
+
+    // Diff via a function object.
+    size_t count = 0;
+    mtv::diff(snap, db1, [&count](const range_type&) { ++count; });
+    assert(count == ranges.size());
 }
 
 int main (int argc, char **argv)
@@ -5168,6 +7287,23 @@ int main (int argc, char **argv)
         mtv_test_transfer();
         mtv_test_push_back();
         mtv_test_capacity();
+        mtv_test_block_position_lookup();
+        mtv_test_small_element_blocks();
+        mtv_test_memory_resource();
+        mtv_test_builder();
+        mtv_test_move();
+        mtv_test_snapshot();
+        mtv_test_set_sorted();
+        mtv_test_edit_session();
+        mtv_test_aggregate();
+        mtv_test_parallel_for_each_block();
+        mtv_test_constant_block();
+        mtv_test_fragmented_row_insert_erase();
+        mtv_test_element_span();
+        mtv_test_block_cache();
+        mtv_test_serialize();
+        mtv_test_fingerprint();
+        mtv_test_diff();
     }
     catch (const std::exception& e)
     {
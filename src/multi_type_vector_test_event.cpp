@@ -30,6 +30,7 @@
 #define MDDS_MULTI_TYPE_VECTOR_DEBUG 1
 #include <mdds/multi_type_vector.hpp>
 #include <mdds/multi_type_vector_trait.hpp>
+#include <mdds/multi_type_vector/dirty_range_tracker.hpp>
 
 #include <iostream>
 #include <vector>
@@ -169,6 +170,49 @@ struct event_block_init
     void element_block_released(const mtv::base_element_block* /*block*/) {}
 };
 
+struct event_range_recorder
+{
+    std::vector<mtv::range_change_event> events;
+
+    void element_block_acquired(const mtv::base_element_block* /*block*/) {}
+
+    void element_block_released(const mtv::base_element_block* /*block*/) {}
+
+    void range_changed(const mtv::range_change_event& event)
+    {
+        events.push_back(event);
+    }
+};
+
+/**
+ * Check that exactly one range change event has been reported since the
+ * last check, and that it matches the expected one.
+ */
+template<typename _MtvT>
+bool check_range_event(
+    _MtvT& db, mtv::range_change_t kind, size_t start, size_t end,
+    mtv::element_t old_type, mtv::element_t new_type)
+{
+    std::vector<mtv::range_change_event>& events = db.event_handler().events;
+    if (events.size() != 1)
+    {
+        cerr << "unexpected number of events: " << events.size() << endl;
+        events.clear();
+        return false;
+    }
+
+    const mtv::range_change_event& e = events[0];
+    bool res = e.kind == kind && e.start == start && e.end == end &&
+        e.old_type == old_type && e.new_type == new_type;
+
+    if (!res)
+        cerr << "unexpected event: kind=" << e.kind << " range=[" << e.start << "," << e.end
+            << ") old type=" << e.old_type << " new type=" << e.new_type << endl;
+
+    events.clear();
+    return res;
+}
+
 void mtv_test_block_counter()
 {
     stack_printer __stack_printer__("::mtv_test_block_counter");
@@ -1096,6 +1140,115 @@ void mtv_test_block_counter()
         assert(src.event_handler().block_count == 0);
         assert(dst.event_handler().block_count == 1);
     }
+
+    {
+        // The builder should notify each new element block exactly once.
+        mtv_type db;
+        mtv_type::builder builder(db, 4);
+        vector<double> vals(3, 1.1);
+        builder.append(vals.begin(), vals.end());
+        assert(db.event_handler().block_count == 1);
+        builder.append(2.2); // appended to the existing block.
+        assert(db.event_handler().block_count == 1);
+        builder.append_empty(2);
+        assert(db.event_handler().block_count == 1);
+        builder.append(string("foo"));
+        builder.append(static_cast<int>(2));
+        assert(db.event_handler().block_count == 3);
+        assert(db.event_handler().block_count_numeric == 1);
+        assert(db.event_handler().block_count_string == 1);
+        assert(db.event_handler().block_count_int == 1);
+        db.clear();
+        assert(db.event_handler().block_count == 0);
+    }
+
+    {
+        // Moving a container should not create or delete any element
+        // blocks, and the event handler moves along with the blocks.
+        mtv_type db(4, 1.1);
+        db.set(1, string("foo"));
+        assert(db.event_handler().block_count == 3);
+
+        mtv_type db2(std::move(db));
+        assert(db2.event_handler().block_count == 3);
+
+        mtv_type db3(2, true);
+        assert(db3.event_handler().block_count == 1);
+        db3 = std::move(db2);
+        assert(db3.event_handler().block_count == 3);
+        db3.clear();
+        assert(db3.event_handler().block_count == 0);
+    }
+
+    {
+        // A snapshot acquires the shared blocks through its own event
+        // handler, and a modification acquires clones of only the blocks
+        // it touches.
+        mtv_type db(6, 1.1);
+        db.set(2, string("foo"));
+        db.set(4, static_cast<int>(3));
+        assert(db.event_handler().block_count == 5);
+
+        mtv_type snap = db.snapshot();
+        assert(db.event_handler().block_count == 5);
+        assert(snap.event_handler().block_count == 5);
+
+        snap.set(0, 2.2);
+        assert(db.event_handler().block_count == 5);
+        assert(snap.event_handler().block_count == 5);
+        assert(snap.event_handler().block_count_string == 1);
+        assert(snap.event_handler().block_count_int == 1);
+
+        db.clear();
+        assert(db.event_handler().block_count == 0);
+        assert(snap.event_handler().block_count == 5);
+        snap.clear();
+        assert(snap.event_handler().block_count == 0);
+    }
+
+    {
+        // Setting values in one batch must notify every element block it
+        // creates or deletes, including the ones that get merged away.
+        mtv_type db(10, 1.1);
+        db.set(3, string("foo"));
+        db.set(7, static_cast<int>(3));
+        assert(db.event_handler().block_count == 5);
+
+        vector<pair<size_t, double>> vals = { { 3, 2.2 }, { 5, 3.3 }, { 7, 4.4 } };
+        db.set_sorted(vals.begin(), vals.end());
+        assert(db.block_size() == 1);
+        assert(db.event_handler().block_count == 1);
+        assert(db.event_handler().block_count_numeric == 1);
+
+        vector<pair<size_t, string>> strs = { { 0, "A" }, { 4, "B" }, { 5, "C" }, { 9, "D" } };
+        db.set_sorted(strs.begin(), strs.end());
+        assert(db.block_size() == 5);
+        assert(db.event_handler().block_count == 5);
+        assert(db.event_handler().block_count_string == 3);
+
+        db.clear();
+        assert(db.event_handler().block_count == 0);
+    }
+
+    {
+        // Blocks merged at the end of an edit session get notified as
+        // they are deleted.
+        mtv_type db(10, 1.1);
+        mtv_type::edit_session session(db);
+        db.set(3, string("foo"));
+        db.set(6, string("bar"));
+        assert(db.event_handler().block_count == 5);
+        db.set(3, 2.2);
+        db.set(6, 3.3);
+        assert(db.block_size() == 5);
+        assert(db.event_handler().block_count == 5);
+        assert(db.event_handler().block_count_string == 0);
+
+        session.commit();
+        assert(db.block_size() == 1);
+        assert(db.event_handler().block_count == 1);
+        assert(db.event_handler().block_count_numeric == 1);
+    }
 }
 
 void mtv_test_block_init()
@@ -1119,12 +1272,233 @@ void mtv_test_block_init()
     }
 }
 
+void mtv_test_range_changed()
+{
+    stack_printer __stack_printer__("::mtv_test_range_changed");
+
+    typedef multi_type_vector<mtv::element_block_func, event_range_recorder> mtv_type;
+
+    {
+        mtv_type db(10);
+        assert(db.event_handler().events.empty());
+
+        db.set(2, 1.5);
+        assert(check_range_event(db, mtv::range_change_modified, 2, 3, mtv::element_type_empty, mtv::element_type_numeric));
+
+        std::vector<double> vals = { 1.0, 2.0, 3.0 };
+        mtv_type::iterator it = db.set(3, vals.begin(), vals.end());
+        assert(check_range_event(db, mtv::range_change_modified, 3, 6, mtv::element_type_empty, mtv::element_type_numeric));
+
+        // Range spanning blocks of different types.
+        std::vector<std::string> strs = { "a", "b", "c", "d" };
+        it = db.set(it, 5, strs.begin(), strs.end());
+        assert(check_range_event(db, mtv::range_change_modified, 5, 9, mtv::element_type_mixed, mtv::element_type_string));
+
+        db.set(it, 9, string("e"));
+        assert(check_range_event(db, mtv::range_change_modified, 9, 10, mtv::element_type_empty, mtv::element_type_string));
+
+        db.set_empty(6, 7);
+        assert(check_range_event(db, mtv::range_change_modified, 6, 8, mtv::element_type_string, mtv::element_type_empty));
+
+        db.set_empty(0, 9);
+        assert(check_range_event(db, mtv::range_change_modified, 0, 10, mtv::element_type_mixed, mtv::element_type_empty));
+        assert(db.block_size() == 1);
+    }
+
+    {
+        // Insertion and erasure.
+        mtv_type db(5, 1.0);
+        std::vector<int> vals = { 1, 2 };
+        db.insert(2, vals.begin(), vals.end());
+        assert(check_range_event(db, mtv::range_change_inserted, 2, 4, mtv::element_type_empty, mtv::element_type_int));
+        assert(db.size() == 7);
+
+        db.insert_empty(0, 3);
+        assert(check_range_event(db, mtv::range_change_inserted, 0, 3, mtv::element_type_empty, mtv::element_type_empty));
+
+        db.erase(5, 6);
+        assert(check_range_event(db, mtv::range_change_erased, 5, 7, mtv::element_type_int, mtv::element_type_empty));
+
+        db.erase(2, 4);
+        assert(check_range_event(db, mtv::range_change_erased, 2, 5, mtv::element_type_mixed, mtv::element_type_empty));
+        assert(db.size() == 5);
+
+        db.push_back(true);
+        assert(check_range_event(db, mtv::range_change_inserted, 5, 6, mtv::element_type_empty, mtv::element_type_boolean));
+        db.push_back(false);
+        assert(check_range_event(db, mtv::range_change_inserted, 6, 7, mtv::element_type_empty, mtv::element_type_boolean));
+        db.push_back_empty();
+        assert(check_range_event(db, mtv::range_change_inserted, 7, 8, mtv::element_type_empty, mtv::element_type_empty));
+
+        db.resize(10);
+        assert(check_range_event(db, mtv::range_change_inserted, 8, 10, mtv::element_type_empty, mtv::element_type_empty));
+
+        db.resize(6);
+        assert(check_range_event(db, mtv::range_change_erased, 6, 10, mtv::element_type_mixed, mtv::element_type_empty));
+
+        db.clear();
+        assert(check_range_event(db, mtv::range_change_erased, 0, 6, mtv::element_type_mixed, mtv::element_type_empty));
+
+        // Clearing an empty container changes nothing.
+        db.clear();
+        assert(db.event_handler().events.empty());
+    }
+
+    {
+        // Transfer and swap report changes to both containers.
+        mtv_type db1(6), db2(6);
+        db1.set(1, 1.0);
+        db1.set(2, 2.0);
+        db2.set(4, string("foo"));
+        db1.event_handler().events.clear();
+        db2.event_handler().events.clear();
+
+        db1.transfer(1, 2, db2, 3);
+        assert(check_range_event(db1, mtv::range_change_modified, 1, 3, mtv::element_type_numeric, mtv::element_type_empty));
+        assert(check_range_event(db2, mtv::range_change_modified, 3, 5, mtv::element_type_mixed, mtv::element_type_numeric));
+
+        db1.set(0, string("bar"));
+        db1.event_handler().events.clear();
+        db1.swap(0, 1, db2, 3);
+        assert(check_range_event(db1, mtv::range_change_modified, 0, 2, mtv::element_type_mixed, mtv::element_type_numeric));
+        assert(check_range_event(db2, mtv::range_change_modified, 3, 5, mtv::element_type_numeric, mtv::element_type_mixed));
+
+        // Swapping whole containers does not report any change.
+        db1.swap(db2);
+        assert(db1.event_handler().events.empty());
+        assert(db2.event_handler().events.empty());
+    }
+
+    {
+        // Releasing elements.
+        mtv_type db(4, 1.0);
+        double v = db.release<double>(1);
+        assert(v == 1.0);
+        assert(check_range_event(db, mtv::range_change_modified, 1, 2, mtv::element_type_numeric, mtv::element_type_empty));
+
+        db.release_range(2, 3);
+        assert(check_range_event(db, mtv::range_change_modified, 2, 4, mtv::element_type_numeric, mtv::element_type_empty));
+
+        db.release();
+        assert(check_range_event(db, mtv::range_change_erased, 0, 4, mtv::element_type_mixed, mtv::element_type_empty));
+    }
+
+    {
+        // set_sorted() reports a single range that covers all the values.
+        mtv_type db(10);
+        std::vector<std::pair<size_t, double>> vals = { { 2, 1.0 }, { 5, 2.0 }, { 6, 3.0 } };
+        db.set_sorted(vals.begin(), vals.end());
+        assert(check_range_event(db, mtv::range_change_modified, 2, 7, mtv::element_type_empty, mtv::element_type_mixed));
+
+        vals = { { 3, 1.0 }, { 4, 2.0 } };
+        db.set_sorted(vals.begin(), vals.end());
+        assert(check_range_event(db, mtv::range_change_modified, 3, 5, mtv::element_type_empty, mtv::element_type_numeric));
+    }
+
+    {
+        // The builder reports each appended run.
+        mtv_type db;
+        {
+            mtv_type::builder bld(db);
+            std::vector<double> vals = { 1.0, 2.0 };
+            bld.append(vals.begin(), vals.end());
+            assert(check_range_event(db, mtv::range_change_inserted, 0, 2, mtv::element_type_empty, mtv::element_type_numeric));
+            bld.append(3.0);
+            assert(check_range_event(db, mtv::range_change_inserted, 2, 3, mtv::element_type_empty, mtv::element_type_numeric));
+            bld.append_empty(2);
+            assert(check_range_event(db, mtv::range_change_inserted, 3, 5, mtv::element_type_empty, mtv::element_type_empty));
+            bld.append(string("foo"));
+            assert(check_range_event(db, mtv::range_change_inserted, 5, 6, mtv::element_type_empty, mtv::element_type_string));
+        }
+    }
+
+    {
+        // Blocks of the same type stay unmerged within an edit session,
+        // which must not make their ranges look mixed.
+        mtv_type db(7, 1.0);
+        mtv_type::edit_session session(db);
+        db.set(3, string("foo"));
+        db.set(3, 2.0);
+        assert(db.block_size() == 3);
+        db.event_handler().events.clear();
+
+        db.set_empty(2, 4);
+        assert(check_range_event(db, mtv::range_change_modified, 2, 5, mtv::element_type_numeric, mtv::element_type_empty));
+    }
+}
+
+void mtv_test_dirty_range_tracker()
+{
+    stack_printer __stack_printer__("::mtv_test_dirty_range_tracker");
+
+    typedef multi_type_vector<mtv::element_block_func, mtv::dirty_range_tracker> mtv_type;
+    typedef std::vector<mtv::dirty_range_tracker::range_type> ranges_type;
+
+    mtv_type db(20);
+    const mtv::dirty_range_tracker& tracker = db.event_handler();
+    assert(tracker.empty());
+    assert(tracker.get_ranges().empty());
+
+    db.set(2, 1.0);
+    db.set(3, string("foo"));
+    std::vector<double> vals = { 1.0, 2.0, 3.0 };
+    db.set(10, vals.begin(), vals.end());
+    assert(!tracker.empty());
+    assert(!tracker.structure_changed());
+
+    // Adjacent ranges get coalesced.
+    ranges_type expected = { { 2, 4 }, { 10, 13 } };
+    assert(tracker.get_ranges() == expected);
+    assert(tracker.is_dirty(3));
+    assert(!tracker.is_dirty(4));
+    assert(tracker.is_dirty(12));
+
+    // Dirty ranges move along with the elements.
+    db.insert_empty(5, 2);
+    expected = { { 2, 4 }, { 5, 7 }, { 12, 15 } };
+    assert(tracker.get_ranges() == expected);
+    assert(tracker.structure_changed());
+
+    db.erase(0, 2);
+    expected = { { 0, 1 }, { 2, 4 }, { 9, 12 } };
+    assert(tracker.get_ranges() == expected);
+
+    db.set_empty(1, 1);
+    expected = { { 0, 4 }, { 9, 12 } };
+    assert(tracker.get_ranges() == expected);
+
+    db.event_handler().reset();
+    assert(tracker.empty());
+    assert(tracker.get_ranges().empty());
+
+    db.push_back(true);
+    expected = { { 19, 20 } };
+    assert(tracker.get_ranges() == expected);
+
+    db.event_handler().reset();
+
+    // Erasing a dirty range leaves no dirty range, but the structure has
+    // still changed.
+    db.set(5, 1.0);
+    db.erase(5, 6);
+    assert(tracker.get_ranges().empty());
+    assert(tracker.structure_changed());
+    assert(!tracker.empty());
+
+    db.event_handler().reset();
+    db.clear();
+    assert(tracker.get_ranges().empty());
+    assert(tracker.structure_changed());
+}
+
 int main (int argc, char **argv)
 {
     try
     {
         mtv_test_block_counter();
         mtv_test_block_init();
+        mtv_test_range_changed();
+        mtv_test_dirty_range_tracker();
     }
     catch (const std::exception& e)
     {
@@ -29,11 +29,25 @@
 
 #include <mdds/multi_type_vector.hpp>
 #include <mdds/multi_type_vector_trait.hpp>
+#include <mdds/multi_type_vector_custom_func1.hpp>
+#include <mdds/multi_type_vector/aggregate.hpp>
+#include <mdds/multi_type_vector/diff.hpp>
+#include <mdds/multi_type_vector/gap_buffer.hpp>
+#include <mdds/multi_type_vector/parallel.hpp>
+#include <mdds/multi_type_vector/serialize.hpp>
 
 #include <cassert>
 #include <sstream>
+#include <fstream>
+#include <iostream>
 #include <vector>
 #include <deque>
+#include <memory>
+#include <algorithm>
+#include <string>
+#include <mutex>
+#include <numeric>
+#include <thread>
 
 #include <boost/ptr_container/ptr_vector.hpp>
 
@@ -44,7 +58,26 @@ using namespace mdds;
 
 namespace {
 
+/** Numeric row value stored in a block backed by a gap buffer. */
+struct row_value
+{
+    double value;
+
+    row_value() : value(0.0) {}
+    row_value(double _value) : value(_value) {}
+};
+
+typedef mdds::mtv::default_element_block<
+    mdds::mtv::element_type_user_start, row_value, mdds::mtv::gap_buffer<row_value>> row_block;
+
+MDDS_MTV_DEFINE_ELEMENT_CALLBACKS(row_value, mdds::mtv::element_type_user_start, row_value(), row_block)
+
+}
+
+namespace {
+
 typedef mdds::multi_type_vector<mdds::mtv::element_block_func> mtv_type;
+typedef mdds::multi_type_vector<mdds::mtv::custom_block_func1<row_block>> mtv_row_type;
 
 void mtv_perf_test_block_position_lookup()
 {
@@ -121,11 +154,952 @@ void mtv_perf_test_insert_via_position_object()
     }
 }
 
+void mtv_perf_test_random_access()
+{
+    // Build a heavily fragmented container, where each block stores only
+    // one element.
+    size_t n = 200000;
+    mtv_type db(n);
+    {
+        stack_printer __stack_printer__("::mtv_perf_test_random_access initialize mtv.");
+        mtv_type::iterator it = db.begin();
+        for (size_t i = 0; i < n; ++i)
+        {
+            if (i % 2)
+                it = db.set(it, i, static_cast<int>(i));
+            else
+                it = db.set(it, i, static_cast<double>(i));
+        }
+    }
+
+    assert(db.block_size() == n);
+
+    // Access the elements in a pseudo-random order without any position
+    // hint, which requires a full block lookup for each access.
+    size_t step = 7919; // prime number
+    double sum = 0.0;
+    {
+        stack_printer __stack_printer__("::mtv_perf_test_random_access get without position hint.");
+        for (size_t i = 0, pos = 0; i < n; ++i, pos = (pos + step) % n)
+        {
+            if (pos % 2)
+                sum += db.get<int>(pos);
+            else
+                sum += db.get<double>(pos);
+        }
+    }
+
+    // Each value equals its position.
+    assert(sum == static_cast<double>(n) * (n-1) / 2);
+
+    {
+        stack_printer __stack_printer__("::mtv_perf_test_random_access set without position hint.");
+        for (size_t i = 0, pos = 0; i < n; ++i, pos = (pos + step) % n)
+        {
+            if (pos % 2)
+                db.set(pos, static_cast<int>(pos));
+            else
+                db.set(pos, static_cast<double>(pos));
+        }
+    }
+
+    assert(db.block_size() == n);
+}
+
+/**
+ * Return the resident set size of the current process in kilobytes, or 0
+ * if it cannot be determined on this platform.
+ */
+size_t get_resident_size_kb()
+{
+    ifstream file("/proc/self/status");
+    string line;
+    while (getline(file, line))
+    {
+        if (line.compare(0, 6, "VmRSS:"))
+            continue;
+
+        istringstream is(line.substr(6));
+        size_t kb = 0;
+        is >> kb;
+        return kb;
+    }
+    return 0;
+}
+
+void mtv_perf_test_block_scan()
+{
+    // Build a container with one million blocks, each storing only one
+    // element, by alternating the element type on every append.
+    size_t n = 1000000;
+    size_t rss_before = get_resident_size_kb();
+    mtv_type db;
+    {
+        stack_printer __stack_printer__("::mtv_perf_test_block_scan initialize mtv.");
+        for (size_t i = 0; i < n; ++i)
+        {
+            if (i % 2)
+                db.push_back(static_cast<int>(i));
+            else
+                db.push_back(static_cast<double>(i));
+        }
+    }
+
+    assert(db.block_size() == n);
+
+    size_t rss_after = get_resident_size_kb();
+    if (rss_before && rss_after)
+        cout << "memory used by " << n << " blocks: " << (rss_after - rss_before) << " KB" << endl;
+
+    // Walk all blocks and visit every element via the block iterator.
+    double sum = 0.0;
+    size_t total = 0;
+    {
+        stack_printer __stack_printer__("::mtv_perf_test_block_scan scan blocks via iterator.");
+        for (int repeat = 0; repeat < 10; ++repeat)
+        {
+            mtv_type::const_iterator it = db.begin(), it_end = db.end();
+            for (; it != it_end; ++it)
+            {
+                total += it->size;
+                if (it->type == mtv::element_type_int)
+                    sum += *mtv::int_element_block::begin(*it->data);
+                else
+                    sum += *mtv::numeric_element_block::begin(*it->data);
+            }
+        }
+    }
+
+    assert(total == n * 10);
+    assert(sum == static_cast<double>(n) * (n-1) / 2 * 10);
+
+    // Look up the block of every logical position without a position hint.
+    total = 0;
+    {
+        stack_printer __stack_printer__("::mtv_perf_test_block_scan look up block position.");
+        for (size_t i = 0; i < n; ++i)
+        {
+            mtv_type::const_position_type pos = db.position(i);
+            total += pos.second;
+        }
+    }
+
+    assert(total == 0);
+}
+
+void mtv_perf_test_checkerboard_fill()
+{
+    // Fill ten million cells with a repeating pattern of string, numeric,
+    // empty and numeric cells, so that every non-empty block stores only
+    // one element.
+    size_t n = 10000000;
+    size_t rss_before = get_resident_size_kb();
+    mtv_type db;
+    {
+        stack_printer __stack_printer__("::mtv_perf_test_checkerboard_fill fill cells.");
+        for (size_t i = 0; i < n; ++i)
+        {
+            switch (i % 4)
+            {
+                case 0:
+                    db.push_back(string("foo"));
+                break;
+                case 2:
+                    db.push_back_empty();
+                break;
+                default:
+                    db.push_back(static_cast<double>(i));
+            }
+        }
+    }
+
+    assert(db.size() == n);
+    assert(db.block_size() == n);
+
+    size_t rss_after = get_resident_size_kb();
+    if (rss_before && rss_after)
+        cout << "memory used by " << n << " cells: " << (rss_after - rss_before) << " KB" << endl;
+
+    double sum = 0.0;
+    {
+        stack_printer __stack_printer__("::mtv_perf_test_checkerboard_fill scan numeric cells.");
+        mtv_type::const_iterator it = db.begin(), it_end = db.end();
+        for (; it != it_end; ++it)
+        {
+            if (it->type == mtv::element_type_numeric)
+                sum += *mtv::numeric_element_block::begin(*it->data);
+        }
+    }
+
+    assert(sum > 0.0);
+
+    {
+        stack_printer __stack_printer__("::mtv_perf_test_checkerboard_fill destroy mtv.");
+        db.clear();
+    }
+}
+
+void build_fragmented_mtv(mtv_type& db, size_t n)
+{
+    for (size_t i = 0; i < n; ++i)
+    {
+        if (i % 2)
+            db.push_back(static_cast<double>(i));
+        else
+            db.push_back(string("foo"));
+    }
+}
+
+void mtv_perf_test_arena()
+{
+    // Build and discard a container with one million single-element
+    // blocks, first from the global heap, then from an arena.
+    size_t n = 1000000;
+    {
+        unique_ptr<mtv_type> db(new mtv_type);
+        {
+            stack_printer __stack_printer__("::mtv_perf_test_arena build with global heap.");
+            build_fragmented_mtv(*db, n);
+        }
+        {
+            stack_printer __stack_printer__("::mtv_perf_test_arena discard with global heap.");
+            db.reset();
+        }
+    }
+
+    {
+        unique_ptr<mtv::arena> arena(new mtv::arena);
+        unique_ptr<mtv_type> db(new mtv_type);
+        {
+            stack_printer __stack_printer__("::mtv_perf_test_arena build with arena.");
+            mtv::scoped_memory_resource scope(*arena);
+            build_fragmented_mtv(*db, n);
+        }
+        {
+            stack_printer __stack_printer__("::mtv_perf_test_arena discard with arena.");
+            db.reset();
+            arena.reset();
+        }
+    }
+}
+
+void split_and_merge_blocks(mtv_type& db, size_t edit_count)
+{
+    // Repeatedly set values of alternating types in the middle of blocks,
+    // then erase them again, which keeps splitting and merging blocks.
+    size_t n = db.size();
+    for (size_t i = 0; i < edit_count; ++i)
+    {
+        size_t pos = (i * 7919) % n;
+        if (i % 2)
+            db.set(pos, static_cast<int>(i));
+        else
+            db.set(pos, string("foo"));
+
+        db.set(pos, 1.0);
+    }
+}
+
+void mtv_perf_test_recycling_pool()
+{
+    size_t n = 100000;
+    size_t edit_count = 2000000;
+    {
+        mtv_type db(n, 1.0);
+        db.set(n/2, string("A"));
+        stack_printer __stack_printer__("::mtv_perf_test_recycling_pool split and merge with global heap.");
+        split_and_merge_blocks(db, edit_count);
+    }
+
+    {
+        mtv::recycling_pool pool;
+        mtv::scoped_memory_resource scope(pool);
+        mtv_type db(n, 1.0);
+        db.set(n/2, string("A"));
+        stack_printer __stack_printer__("::mtv_perf_test_recycling_pool split and merge with recycling pool.");
+        split_and_merge_blocks(db, edit_count);
+    }
+}
+
+
+void mtv_perf_test_builder()
+{
+    // Load ten million cells consisting of runs of alternating types and
+    // varying lengths, first via push_back one value at a time, then via
+    // builder one run at a time.
+    size_t n = 10000000;
+    vector<double> nums(64, 1.0);
+    vector<string> strs(64, "foo");
+
+    {
+        stack_printer __stack_printer__("::mtv_perf_test_builder push_back per value.");
+        mtv_type db;
+        for (size_t i = 0, run = 0; i < n; ++run)
+        {
+            size_t len = std::min<size_t>(run % 64 + 1, n - i);
+            for (size_t j = 0; j < len; ++j)
+            {
+                if (run % 2)
+                    db.push_back(strs[j]);
+                else
+                    db.push_back(nums[j]);
+            }
+            i += len;
+        }
+    }
+
+    {
+        stack_printer __stack_printer__("::mtv_perf_test_builder builder per run.");
+        mtv_type db;
+        mtv_type::builder builder(db, n / 32);
+        for (size_t i = 0, run = 0; i < n; ++run)
+        {
+            size_t len = std::min<size_t>(run % 64 + 1, n - i);
+            if (run % 2)
+                builder.append(strs.begin(), strs.begin()+len);
+            else
+                builder.append(nums.begin(), nums.begin()+len);
+            i += len;
+        }
+    }
+}
+
+void mtv_perf_test_snapshot()
+{
+    // Take copies of a container with a million blocks, and modify one
+    // cell in each copy, first via the copy constructor, then via
+    // snapshot().
+    size_t n = 2000000;
+    size_t copies = 20;
+    mtv_type db(n);
+    for (size_t i = 0; i < n; i += 2)
+        db.set(i, static_cast<double>(i));
+
+    {
+        stack_printer __stack_printer__("::mtv_perf_test_snapshot copy.");
+        for (size_t i = 0; i < copies; ++i)
+        {
+            mtv_type copied(db);
+            copied.set(i*2, 1.0);
+        }
+    }
+
+    {
+        stack_printer __stack_printer__("::mtv_perf_test_snapshot snapshot.");
+        for (size_t i = 0; i < copies; ++i)
+        {
+            mtv_type snap = db.snapshot();
+            snap.set(i*2, 1.0);
+        }
+    }
+}
+
+void mtv_perf_test_set_sorted()
+{
+    // Set 50 thousand string values scattered over half a million numeric
+    // cells, first one value at a time with a position hint, then in one
+    // batch.
+    size_t n = 500000;
+    size_t step = 10;
+    vector<pair<size_t, string>> vals;
+    for (size_t i = step / 2; i < n; i += step)
+        vals.emplace_back(i, "foo");
+
+    {
+        stack_printer __stack_printer__("::mtv_perf_test_set_sorted set per value with position hint.");
+        mtv_type db(n, 1.0);
+        mtv_type::iterator pos_hint = db.begin();
+        for (const pair<size_t, string>& v : vals)
+            pos_hint = db.set(pos_hint, v.first, v.second);
+    }
+
+    {
+        stack_printer __stack_printer__("::mtv_perf_test_set_sorted set_sorted.");
+        mtv_type db(n, 1.0);
+        db.set_sorted(vals.begin(), vals.end());
+    }
+}
+
+void mtv_perf_test_edit_session()
+{
+    // Overwrite every tenth cell in a column of 200 thousand numeric
+    // cells alternately with a string and a number, in four passes.  Run it
+    // first with blocks merged after each edit, then in an edit session.
+    size_t n = 200000;
+    size_t step = 10;
+
+    {
+        stack_printer __stack_printer__("::mtv_perf_test_edit_session merge per edit.");
+        mtv_type db(n, 1.0);
+        for (int pass = 0; pass < 4; ++pass)
+        {
+            mtv_type::iterator pos_hint = db.begin();
+            for (size_t i = step / 2; i < n; i += step)
+            {
+                if (pass % 2 == 0)
+                    pos_hint = db.set(pos_hint, i, string("foo"));
+                else
+                    pos_hint = db.set(pos_hint, i, 2.0);
+            }
+        }
+        assert(db.block_size() == 1);
+    }
+
+    {
+        stack_printer __stack_printer__("::mtv_perf_test_edit_session merge on commit.");
+        mtv_type db(n, 1.0);
+        mtv_type::edit_session session(db);
+        for (int pass = 0; pass < 4; ++pass)
+        {
+            mtv_type::iterator pos_hint = db.begin();
+            for (size_t i = step / 2; i < n; i += step)
+            {
+                if (pass % 2 == 0)
+                    pos_hint = db.set(pos_hint, i, string("foo"));
+                else
+                    pos_hint = db.set(pos_hint, i, 2.0);
+            }
+        }
+        session.commit();
+        assert(db.block_size() == 1);
+    }
+}
+
+void mtv_perf_test_aggregate()
+{
+    // Aggregate the values of ten million cells, consisting of blocks of
+    // 1000 numeric cells separated by integer and empty cells, 20 times,
+    // first with a loop over the element block iterators, then via
+    // aggregate().
+    size_t n = 10000000;
+    size_t repeat = 20;
+    mtv_type db(n, 1.5);
+    mtv_type::iterator pos_hint = db.begin();
+    for (size_t i = 1000; i < n; i += 1002)
+    {
+        pos_hint = db.set(pos_hint, i, static_cast<int>(i % 100));
+        pos_hint = db.set_empty(pos_hint, i+1, i+1);
+    }
+
+    double total1 = 0.0, total2 = 0.0;
+
+    {
+        stack_printer __stack_printer__("::mtv_perf_test_aggregate block iterator loop.");
+        for (size_t r = 0; r < repeat; ++r)
+        {
+            size_t count = 0;
+            double sum = 0.0, lo = 0.0, hi = 0.0;
+            for (const mtv_type::value_type& blk : db)
+            {
+                switch (blk.type)
+                {
+                    case mtv::element_type_numeric:
+                    {
+                        mtv::numeric_element_block::const_iterator it = mtv::numeric_element_block::begin(*blk.data);
+                        mtv::numeric_element_block::const_iterator it_end = mtv::numeric_element_block::end(*blk.data);
+                        for (; it != it_end; ++it, ++count)
+                        {
+                            sum += *it;
+                            lo = count ? std::min(lo, *it) : *it;
+                            hi = count ? std::max(hi, *it) : *it;
+                        }
+                        break;
+                    }
+                    case mtv::element_type_int:
+                    {
+                        mtv::int_element_block::const_iterator it = mtv::int_element_block::begin(*blk.data);
+                        mtv::int_element_block::const_iterator it_end = mtv::int_element_block::end(*blk.data);
+                        for (; it != it_end; ++it, ++count)
+                        {
+                            double v = *it;
+                            sum += v;
+                            lo = count ? std::min(lo, v) : v;
+                            hi = count ? std::max(hi, v) : v;
+                        }
+                        break;
+                    }
+                    default:
+                        ;
+                }
+            }
+            total1 += sum / count + lo + hi;
+        }
+    }
+
+    {
+        stack_printer __stack_printer__("::mtv_perf_test_aggregate aggregate.");
+        for (size_t r = 0; r < repeat; ++r)
+        {
+            mtv::numeric_aggregate res = mtv::aggregate(db);
+            total2 += res.mean() + res.min + res.max;
+        }
+    }
+
+    cout << "  totals: " << total1 << " " << total2 << endl;
+}
+
+void mtv_perf_test_parallel_for_each_block()
+{
+    // Sum the numeric values of ten million cells, consisting of blocks of
+    // 100000 numeric cells separated by string cells, 20 times, first by
+    // iterating over the blocks on the calling thread only, then via
+    // parallel_for_each_block() on all available hardware threads.
+    size_t n = 10000000;
+    size_t repeat = 20;
+    mtv_type db(n, 1.5);
+    mtv_type::iterator pos_hint = db.begin();
+    for (size_t i = 100000; i < n; i += 100001)
+        pos_hint = db.set(pos_hint, i, string("foo"));
+
+    double total1 = 0.0, total2 = 0.0;
+
+    {
+        stack_printer __stack_printer__("::mtv_perf_test_parallel_for_each_block single thread.");
+        for (size_t r = 0; r < repeat; ++r)
+        {
+            for (const mtv_type::value_type& blk : db)
+            {
+                if (blk.type != mtv::element_type_numeric)
+                    continue;
+
+                total1 += std::accumulate(
+                    mtv::numeric_element_block::begin(*blk.data),
+                    mtv::numeric_element_block::end(*blk.data), 0.0);
+            }
+        }
+    }
+
+    {
+        stack_printer __stack_printer__("::mtv_perf_test_parallel_for_each_block parallel.");
+        std::mutex mtx;
+        for (size_t r = 0; r < repeat; ++r)
+        {
+            mtv::parallel_for_each_block(db,
+                [&](const mtv::block_span& span)
+                {
+                    if (span.type != mtv::element_type_numeric)
+                        return;
+
+                    mtv::numeric_element_block::const_iterator it =
+                        mtv::numeric_element_block::begin(*span.data) + span.offset;
+                    double sum = std::accumulate(it, it + span.size, 0.0);
+
+                    std::lock_guard<std::mutex> lock(mtx);
+                    total2 += sum;
+                }
+            );
+        }
+    }
+
+    cout << "  threads: " << std::thread::hardware_concurrency() << endl;
+    cout << "  totals: " << total1 << " " << total2 << endl;
+}
+
+void mtv_perf_test_constant_block()
+{
+    // Create a container of ten million cells filled with one value, then
+    // aggregate and split it, 20 times, first with a block built from an
+    // array of values, then with a block filled via the constructor which
+    // stores the value only once.
+    size_t n = 10000000;
+    size_t repeat = 20;
+    vector<double> vals(n, 0.5);
+    double total1 = 0.0, total2 = 0.0;
+
+    {
+        stack_printer __stack_printer__("::mtv_perf_test_constant_block array of values.");
+        for (size_t r = 0; r < repeat; ++r)
+        {
+            mtv_type db(n, vals.begin(), vals.end());
+            total1 += mtv::aggregate(db).sum;
+            db.set(n/2, string("split"));
+            total1 += db.block_size();
+        }
+    }
+
+    {
+        stack_printer __stack_printer__("::mtv_perf_test_constant_block constant value.");
+        for (size_t r = 0; r < repeat; ++r)
+        {
+            mtv_type db(n, 0.5);
+            total2 += mtv::aggregate(db).sum;
+            db.set(n/2, string("split"));
+            total2 += db.block_size();
+        }
+    }
+
+    cout << "  totals: " << total1 << " " << total2 << endl;
+}
+
+void mtv_perf_test_gap_buffer()
+{
+    // Insert 500 rows one at a time at consecutive positions in the middle
+    // of a block of ten million numeric rows, then erase them again, first
+    // with the default element storage, then with a gap buffer.
+    size_t n = 10000000;
+    size_t insert_count = 500;
+    size_t cursor = n / 2;
+    double total1 = 0.0, total2 = 0.0;
+
+    {
+        vector<double> vals(n);
+        std::iota(vals.begin(), vals.end(), 0.0);
+        mtv_type db(n, vals.begin(), vals.end());
+
+        stack_printer __stack_printer__("::mtv_perf_test_gap_buffer default storage.");
+        mtv_type::iterator pos_hint = db.begin();
+        for (size_t i = 0; i < insert_count; ++i)
+        {
+            double v = i;
+            pos_hint = db.insert(pos_hint, cursor+i, &v, &v+1);
+        }
+
+        for (size_t i = 0; i < insert_count; ++i)
+            total1 += db.get<double>(cursor+i);
+
+        for (size_t i = insert_count; i > 0; --i)
+            db.erase(cursor+i-1, cursor+i-1);
+
+        total1 += db.get<double>(cursor) + db.size();
+    }
+
+    {
+        vector<row_value> vals(n);
+        for (size_t i = 0; i < n; ++i)
+            vals[i].value = i;
+        mtv_row_type db(n, vals.begin(), vals.end());
+
+        stack_printer __stack_printer__("::mtv_perf_test_gap_buffer gap buffer.");
+        mtv_row_type::iterator pos_hint = db.begin();
+        for (size_t i = 0; i < insert_count; ++i)
+        {
+            row_value v(i);
+            pos_hint = db.insert(pos_hint, cursor+i, &v, &v+1);
+        }
+
+        for (size_t i = 0; i < insert_count; ++i)
+            total2 += db.get<row_value>(cursor+i).value;
+
+        for (size_t i = insert_count; i > 0; --i)
+            db.erase(cursor+i-1, cursor+i-1);
+
+        total2 += db.get<row_value>(cursor).value + db.size();
+    }
+
+    cout << "  totals: " << total1 << " " << total2 << endl;
+}
+
+void mtv_perf_test_row_insert_erase()
+{
+    // Build a column of one million rows alternating between numeric and
+    // string values, so that each row is a block of its own.  Then insert
+    // and erase empty rows, first around the same position as a user
+    // editing a sheet would, then alternating between the top and the
+    // bottom of the column.
+    size_t n = 1000000;
+    size_t edit_count = 1000;
+    mtv_type db(n);
+    {
+        mtv_type::iterator pos_hint = db.begin();
+        for (size_t i = 0; i < n; ++i)
+        {
+            if (i % 2)
+                pos_hint = db.set(pos_hint, i, 1.0);
+            else
+                pos_hint = db.set(pos_hint, i, string("A"));
+        }
+    }
+
+    {
+        stack_printer __stack_printer__("::mtv_perf_test_row_insert_erase local edits.");
+        size_t cursor = n / 2;
+        for (size_t i = 0; i < edit_count; ++i)
+        {
+            size_t pos = cursor + i % 16;
+            db.insert_empty(pos, 1);
+            db.erase(pos+1, pos+1);
+            db.insert_empty(pos, 1);
+            db.erase(pos, pos);
+        }
+    }
+
+    {
+        stack_printer __stack_printer__("::mtv_perf_test_row_insert_erase edits alternating between top and bottom.");
+        for (size_t i = 0; i < edit_count / 10; ++i)
+        {
+            size_t pos = i % 2 ? n - 10 : 10;
+            db.insert_empty(pos, 1);
+            db.erase(pos, pos);
+        }
+    }
+
+    cout << "  size: " << db.size() << "  blocks: " << db.block_size() << endl;
+}
+
+void mtv_perf_test_block_cache()
+{
+    // Build a heavily fragmented container of blocks of one to three
+    // elements, then read all of its elements in order without position
+    // hints, with and without the block cache.
+    size_t n = 1000000;
+    mtv_type db(n);
+    {
+        mtv_type::iterator it = db.begin();
+        for (size_t i = 0; i < n; ++i)
+        {
+            if ((i / (i % 3 + 1)) % 2)
+                it = db.set(it, i, static_cast<double>(i));
+            else
+                it = db.set(it, i, string("A"));
+        }
+    }
+
+    size_t numeric_count[2] = { 0, 0 };
+    double sum[2] = { 0.0, 0.0 };
+    for (int enabled = 0; enabled < 2; ++enabled)
+    {
+        db.enable_block_cache(enabled != 0);
+        stack_printer __stack_printer__(
+            enabled ? "::mtv_perf_test_block_cache get with block cache." : "::mtv_perf_test_block_cache get without block cache.");
+
+        for (size_t i = 0; i < n; ++i)
+        {
+            if (db.get_type(i) != mtv::element_type_numeric)
+                continue;
+
+            ++numeric_count[enabled];
+            sum[enabled] += db.get<double>(i);
+        }
+    }
+
+    assert(numeric_count[0] == numeric_count[1]);
+    assert(sum[0] == sum[1]);
+    cout << "  size: " << db.size() << "  blocks: " << db.block_size() << endl;
+}
+
+void mtv_perf_test_serialize()
+{
+    // Build a container of alternating runs of numeric and string values,
+    // then rebuild it from a serialized copy, element by element versus via
+    // deserialize().
+    size_t n = 2000000;
+    mtv_type db(n);
+    {
+        vector<double> vals(1000);
+        for (size_t i = 0; i < vals.size(); ++i)
+            vals[i] = static_cast<double>(i);
+
+        mtv_type::iterator it = db.begin();
+        for (size_t i = 0; i < n; i += 2000)
+        {
+            it = db.set(it, i, vals.begin(), vals.end());
+            it = db.set(it, i+1000, string("A"));
+        }
+    }
+
+    std::ostringstream os;
+    {
+        stack_printer __stack_printer__("::mtv_perf_test_serialize serialize.");
+        mtv::serialize(db, os);
+    }
+    string buf = os.str();
+
+    {
+        stack_printer __stack_printer__("::mtv_perf_test_serialize rebuild element by element.");
+        mtv_type db2(db.size());
+        mtv_type::iterator pos = db2.begin();
+        mtv_type::const_iterator it = db.begin(), it_end = db.end();
+        for (; it != it_end; ++it)
+        {
+            if (it->type == mtv::element_type_numeric)
+            {
+                mtv::numeric_element_block::const_iterator it2 = mtv::numeric_element_block::begin(*it->data);
+                mtv::numeric_element_block::const_iterator it2_end = mtv::numeric_element_block::end(*it->data);
+                for (size_t i = it->position; it2 != it2_end; ++it2, ++i)
+                    pos = db2.set(pos, i, *it2);
+            }
+            else if (it->type == mtv::element_type_string)
+            {
+                mtv::string_element_block::const_iterator it2 = mtv::string_element_block::begin(*it->data);
+                mtv::string_element_block::const_iterator it2_end = mtv::string_element_block::end(*it->data);
+                for (size_t i = it->position; it2 != it2_end; ++it2, ++i)
+                    pos = db2.set(pos, i, *it2);
+            }
+        }
+        assert(db2 == db);
+    }
+
+    {
+        stack_printer __stack_printer__("::mtv_perf_test_serialize deserialize from stream.");
+        std::istringstream is(buf);
+        mtv_type db2;
+        mtv::deserialize(db2, is);
+        assert(db2.size() == db.size());
+    }
+
+    // Use 8-byte aligned storage as a stand-in for a memory-mapped file.
+    vector<uint64_t> mapped((buf.size() + 7) / 8);
+    std::copy(buf.begin(), buf.end(), reinterpret_cast<char*>(mapped.data()));
+
+    {
+        stack_printer __stack_printer__("::mtv_perf_test_serialize deserialize from view.");
+        mtv::serialized_view view(mapped.data(), buf.size());
+        mtv_type db2;
+        mtv::deserialize(db2, view);
+        assert(db2.size() == db.size());
+    }
+
+    double sum = 0.0;
+    {
+        stack_printer __stack_printer__("::mtv_perf_test_serialize sum numeric values in view.");
+        mtv::serialized_view view(mapped.data(), buf.size());
+        for (size_t i = 0; i < view.block_size(); ++i)
+        {
+            if (view.get_block(i).type != mtv::element_type_numeric)
+                continue;
+
+            mtv::element_span<const double> span = view.get_span<mtv::numeric_element_block>(i);
+            sum = std::accumulate(span.begin(), span.end(), sum);
+        }
+    }
+
+    cout << "  size: " << db.size() << "  blocks: " << db.block_size()
+        << "  bytes: " << buf.size() << "  sum: " << sum << endl;
+}
+
+void mtv_perf_test_fingerprint()
+{
+    // Check many columns for changes against a baseline copy after a few
+    // cells in some of them get modified, by comparing each column to its
+    // baseline versus comparing their fingerprints.
+    size_t col_count = 100, row_count = 100000, rounds = 10;
+    vector<mtv_type> cols(col_count, mtv_type(row_count));
+    {
+        vector<double> vals(1000);
+        for (size_t i = 0; i < vals.size(); ++i)
+            vals[i] = static_cast<double>(i);
+
+        for (mtv_type& col : cols)
+        {
+            mtv_type::iterator it = col.begin();
+            for (size_t i = 0; i < row_count; i += 2000)
+            {
+                it = col.set(it, i, vals.begin(), vals.end());
+                it = col.set(it, i+1000, string("A"));
+            }
+        }
+    }
+
+    // Copies share no blocks with the columns.
+    vector<mtv_type> baseline(cols);
+
+    vector<size_t> baseline_fps;
+    for (const mtv_type& col : baseline)
+        baseline_fps.push_back(col.fingerprint());
+
+    size_t changed1 = 0, changed2 = 0;
+    for (size_t round = 0; round < rounds; ++round)
+    {
+        for (size_t i = round; i < col_count; i += 20)
+            cols[i].set(round*10, round % 2 ? -1.0 : static_cast<double>(round*10));
+
+        {
+            stack_printer __stack_printer__("::mtv_perf_test_fingerprint compare to baseline.");
+            for (size_t i = 0; i < col_count; ++i)
+                changed1 += cols[i] != baseline[i];
+        }
+
+        {
+            stack_printer __stack_printer__("::mtv_perf_test_fingerprint compare fingerprints.");
+            for (size_t i = 0; i < col_count; ++i)
+                changed2 += cols[i].fingerprint() != baseline_fps[i];
+        }
+    }
+
+    assert(changed1 == changed2);
+    cout << "  columns: " << col_count << "  rows: " << row_count
+        << "  changed: " << changed1 << endl;
+}
+
+void mtv_perf_test_diff()
+{
+    // Find the ranges of elements that differ between two versions of a
+    // column with a few scattered changes, cell by cell via get_type() and
+    // get() versus via diff().
+    size_t n = 2000000;
+    mtv_type db1(n);
+    {
+        vector<double> vals(1000);
+        for (size_t i = 0; i < vals.size(); ++i)
+            vals[i] = static_cast<double>(i);
+
+        mtv_type::iterator it = db1.begin();
+        for (size_t i = 0; i < n; i += 2000)
+        {
+            it = db1.set(it, i, vals.begin(), vals.end());
+            it = db1.set(it, i+1000, string("A"));
+        }
+    }
+
+    mtv_type db2(db1);
+    for (size_t i = 0; i < n; i += 10007)
+        db2.set(i, -1.0);
+
+    size_t changed1 = 0;
+    {
+        stack_printer __stack_printer__("::mtv_perf_test_diff cell by cell.");
+        mtv_type::const_position_type pos1 = db1.position(0), pos2 = db2.position(0);
+        bool in_range = false;
+        for (size_t i = 0; i < n; ++i)
+        {
+            pos1 = db1.position(pos1.first, i);
+            pos2 = db2.position(pos2.first, i);
+            mtv::element_t type = pos1.first->type;
+            bool differs = type != pos2.first->type;
+            if (!differs && type == mtv::element_type_numeric)
+                differs = db1.get<double>(i) != db2.get<double>(i);
+            else if (!differs && type == mtv::element_type_string)
+                differs = db1.get<string>(i) != db2.get<string>(i);
+
+            if (differs && !in_range)
+                ++changed1;
+            in_range = differs;
+        }
+    }
+
+    size_t changed2 = 0;
+    {
+        stack_printer __stack_printer__("::mtv_perf_test_diff diff.");
+        mtv::diff(db1, db2, [&changed2](const mtv::diff_range<mtv_type>&) { ++changed2; });
+    }
+
+    assert(changed1 == changed2);
+    cout << "  size: " << n << "  blocks: " << db1.block_size() << "  ranges: " << changed2 << endl;
+}
+
 }
 
 int main (int argc, char **argv)
 {
     mtv_perf_test_block_position_lookup();
     mtv_perf_test_insert_via_position_object();
+    mtv_perf_test_random_access();
+    mtv_perf_test_block_scan();
+    mtv_perf_test_checkerboard_fill();
+    mtv_perf_test_arena();
+    mtv_perf_test_recycling_pool();
+    mtv_perf_test_builder();
+    mtv_perf_test_snapshot();
+    mtv_perf_test_set_sorted();
+    mtv_perf_test_edit_session();
+    mtv_perf_test_aggregate();
+    mtv_perf_test_parallel_for_each_block();
+    mtv_perf_test_constant_block();
+    mtv_perf_test_gap_buffer();
+    mtv_perf_test_row_insert_erase();
+    mtv_perf_test_block_cache();
+    mtv_perf_test_serialize();
+    mtv_perf_test_fingerprint();
+    mtv_perf_test_diff();
     return EXIT_SUCCESS;
 }